@@ -0,0 +1,566 @@
+// https://en.wikipedia.org/wiki/Recursive_descent_parser
+// https://en.wikipedia.org/wiki/Register_machine
+// https://en.wikipedia.org/wiki/Constant_folding
+
+#include "expression.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ajcf {
+
+    namespace {
+
+        using OpCode = CompiledExpression::OpCode;
+
+        constexpr int max_nesting_depth = 200;
+
+        // The registers of the variables and constants are known only once the whole text is parsed,
+        // so the compiler works on operands which are numbered in their own kind
+        struct Operand
+        {
+            enum class Kind
+            {
+                variable,
+                constant,
+                temporary,
+            };
+
+            Kind kind;
+            int index; // of the variable or temporary
+            int value; // of the constant
+        };
+
+        struct SymbolicInstruction
+        {
+            OpCode op_code;
+            int destination; // temporary
+            Operand left;
+            Operand right;
+        };
+
+        int wrapping_add(int left, int right) noexcept
+        {
+            return static_cast<int>(static_cast<unsigned>(left) + static_cast<unsigned>(right));
+        }
+
+        int wrapping_subtract(int left, int right) noexcept
+        {
+            return static_cast<int>(static_cast<unsigned>(left) - static_cast<unsigned>(right));
+        }
+
+        int wrapping_multiply(int left, int right) noexcept
+        {
+            return static_cast<int>(static_cast<unsigned>(left) * static_cast<unsigned>(right));
+        }
+
+        int checked_divide(int left, int right)
+        {
+            if (right == 0)
+                throw std::domain_error("division by zero");
+            // INT_MIN / -1 overflows
+            return right == -1 ? wrapping_subtract(0, left) : left / right;
+        }
+
+        int checked_modulo(int left, int right)
+        {
+            if (right == 0)
+                throw std::domain_error("division by zero");
+            return right == -1 ? 0 : left % right;
+        }
+
+        int compute(OpCode op_code, int left, int right)
+        {
+            switch (op_code)
+            {
+            case OpCode::add:
+                return wrapping_add(left, right);
+            case OpCode::subtract:
+                return wrapping_subtract(left, right);
+            case OpCode::multiply:
+                return wrapping_multiply(left, right);
+            case OpCode::divide:
+                return checked_divide(left, right);
+            case OpCode::modulo:
+                return checked_modulo(left, right);
+            case OpCode::negate:
+                return wrapping_subtract(0, left);
+            }
+            return 0;
+        }
+
+        // Apply an operation to a block of rows: the loop on a local array of constant size, which cannot
+        // alias the operands, is vectorized by the compiler
+        template <typename Operation>
+        void apply_to_block(const int* left, const int* right, int* destination, Operation operation) noexcept
+        {
+            constexpr auto block_size = CompiledExpression::batch_block_size;
+            alignas(32) int block[block_size];
+            for (std::size_t row = 0; row != block_size; ++row)
+                block[row] = operation(left[row], right[row]);
+            std::memcpy(destination, block, sizeof(block));
+        }
+
+        // Only the rows_count first rows: the divisors computed from the padding of a partial block can be zero
+        void check_divisors(const int* right, std::size_t rows_count)
+        {
+            bool has_zero = false;
+            for (std::size_t row = 0; row != rows_count; ++row)
+                has_zero |= right[row] == 0;
+            if (has_zero)
+                throw std::domain_error("division by zero");
+        }
+
+        void compute_block(OpCode op_code, const int* left, const int* right, int* destination, std::size_t rows_count)
+        {
+            switch (op_code)
+            {
+            case OpCode::add:
+                apply_to_block(left, right, destination, &wrapping_add);
+                break;
+            case OpCode::subtract:
+                apply_to_block(left, right, destination, &wrapping_subtract);
+                break;
+            case OpCode::multiply:
+                apply_to_block(left, right, destination, &wrapping_multiply);
+                break;
+            // the rows of the padding with a zero divisor give 0
+            case OpCode::divide:
+                check_divisors(right, rows_count);
+                apply_to_block(left, right, destination, [](int x, int y) {
+                    return y == -1 ? wrapping_subtract(0, x) : y == 0 ? 0 : x / y;
+                });
+                break;
+            case OpCode::modulo:
+                check_divisors(right, rows_count);
+                apply_to_block(left, right, destination, [](int x, int y) { return y == -1 || y == 0 ? 0 : x % y; });
+                break;
+            case OpCode::negate:
+                apply_to_block(left, right, destination, [](int x, int) { return wrapping_subtract(0, x); });
+                break;
+            }
+        }
+
+        bool is_identifier_start(char c) noexcept
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        }
+
+        bool is_identifier_char(char c) noexcept
+        {
+            return is_identifier_start(c) || (c >= '0' && c <= '9');
+        }
+
+        // Recursive descent parser generating the instructions while parsing:
+        //   expression := term (('+' | '-') term)*
+        //   term       := unary (('*' | '/' | '%') unary)*
+        //   unary      := ('+' | '-') unary | primary
+        //   primary    := integer | variable | '(' expression ')'
+        class Compiler
+        {
+        public:
+            explicit Compiler(std::string_view text) : m_text(text)
+            {
+            }
+
+            void compile()
+            {
+                m_result = parse_expression();
+                skip_spaces();
+                if (m_position != m_text.size())
+                    fail("unexpected character");
+                // an expression which is a constant is the result of its register
+                use(m_result);
+            }
+
+            std::vector<std::string> variables;
+            std::vector<int> constants;
+            std::vector<SymbolicInstruction> instructions;
+            int temporaries_count{0};
+
+            const Operand& result() const noexcept
+            {
+                return m_result;
+            }
+
+            // Register of an operand once all the variables and constants are known
+            int register_of(const Operand& operand) const
+            {
+                switch (operand.kind)
+                {
+                case Operand::Kind::variable:
+                    return operand.index;
+                case Operand::Kind::constant:
+                    return static_cast<int>(variables.size()) + constant_index(operand.value);
+                case Operand::Kind::temporary:
+                    return static_cast<int>(variables.size() + constants.size()) + operand.index;
+                }
+                return 0;
+            }
+
+        private:
+            [[noreturn]] void fail(const char* message) const
+            {
+                throw std::invalid_argument(
+                    fmt::format("invalid expression \"{}\": {} at position {}", m_text, message, m_position));
+            }
+
+            void skip_spaces() noexcept
+            {
+                while (m_position != m_text.size() && (m_text[m_position] == ' ' || m_text[m_position] == '\t'))
+                    ++m_position;
+            }
+
+            // Skip the spaces, then consume the character if it is one of characters
+            char accept(std::string_view characters) noexcept
+            {
+                skip_spaces();
+                if (m_position == m_text.size() || characters.find(m_text[m_position]) == std::string_view::npos)
+                    return '\0';
+                return m_text[m_position++];
+            }
+
+            Operand parse_expression()
+            {
+                auto left = parse_term();
+                while (const auto operator_char = accept("+-"))
+                {
+                    const auto right = parse_term();
+                    left = emit(operator_char == '+' ? OpCode::add : OpCode::subtract, left, right);
+                }
+                return left;
+            }
+
+            Operand parse_term()
+            {
+                auto left = parse_unary();
+                while (const auto operator_char = accept("*/%"))
+                {
+                    const auto right = parse_unary();
+                    const auto op_code = operator_char == '*'   ? OpCode::multiply
+                                         : operator_char == '/' ? OpCode::divide
+                                                                : OpCode::modulo;
+                    left = emit(op_code, left, right);
+                }
+                return left;
+            }
+
+            Operand parse_unary()
+            {
+                const auto operator_char = accept("+-");
+                if (operator_char == '\0')
+                    return parse_primary();
+
+                enter();
+                const auto operand = parse_unary();
+                leave();
+                if (operator_char == '+')
+                    return operand;
+                return emit(OpCode::negate, operand, operand);
+            }
+
+            Operand parse_primary()
+            {
+                skip_spaces();
+                if (m_position == m_text.size())
+                    fail("missing operand");
+
+                const auto c = m_text[m_position];
+                if (c == '(')
+                {
+                    ++m_position;
+                    enter();
+                    const auto operand = parse_expression();
+                    leave();
+                    if (!accept(")"))
+                        fail("missing closing parenthesis");
+                    return operand;
+                }
+                if (c >= '0' && c <= '9')
+                {
+                    int value = 0;
+                    const auto [end, error] =
+                        std::from_chars(m_text.data() + m_position, m_text.data() + m_text.size(), value);
+                    if (error != std::errc())
+                        fail("integer out of range");
+                    m_position = static_cast<std::size_t>(end - m_text.data());
+                    return Operand{Operand::Kind::constant, 0, value};
+                }
+                if (is_identifier_start(c))
+                {
+                    const auto first = m_position;
+                    while (m_position != m_text.size() && is_identifier_char(m_text[m_position]))
+                        ++m_position;
+                    return variable(m_text.substr(first, m_position - first));
+                }
+                fail("unexpected character");
+            }
+
+            void enter()
+            {
+                if (++m_depth > max_nesting_depth)
+                    throw std::length_error(fmt::format("expression \"{}\" is too deeply nested", m_text));
+            }
+
+            void leave() noexcept
+            {
+                --m_depth;
+            }
+
+            Operand variable(std::string_view name)
+            {
+                const auto iter = std::find(variables.begin(), variables.end(), name);
+                if (iter != variables.end())
+                    return Operand{Operand::Kind::variable, static_cast<int>(iter - variables.begin()), 0};
+                variables.emplace_back(name);
+                return Operand{Operand::Kind::variable, static_cast<int>(variables.size() - 1), 0};
+            }
+
+            int constant_index(int value) const
+            {
+                return static_cast<int>(std::find(constants.begin(), constants.end(), value) - constants.begin());
+            }
+
+            void use(const Operand& operand)
+            {
+                if (operand.kind == Operand::Kind::constant &&
+                    constant_index(operand.value) == static_cast<int>(constants.size()))
+                    constants.push_back(operand.value);
+            }
+
+            Operand emit(OpCode op_code, const Operand& left, const Operand& right)
+            {
+                // constant folding, except for the divisions by zero which must fail at evaluation
+                if (left.kind == Operand::Kind::constant && right.kind == Operand::Kind::constant &&
+                    !((op_code == OpCode::divide || op_code == OpCode::modulo) && right.value == 0))
+                    return Operand{Operand::Kind::constant, 0, compute(op_code, left.value, right.value)};
+
+                // the temporaries are used like a stack: the right operand was computed after the left one
+                int destination = 0;
+                if (left.kind == Operand::Kind::temporary)
+                {
+                    destination = left.index;
+                    if (right.kind == Operand::Kind::temporary && op_code != OpCode::negate)
+                        --m_next_temporary;
+                }
+                else if (right.kind == Operand::Kind::temporary && op_code != OpCode::negate)
+                {
+                    destination = right.index;
+                }
+                else
+                {
+                    destination = m_next_temporary++;
+                    temporaries_count = std::max(temporaries_count, m_next_temporary);
+                }
+
+                use(left);
+                use(right);
+                instructions.push_back(SymbolicInstruction{op_code, destination, left, right});
+                return Operand{Operand::Kind::temporary, destination, 0};
+            }
+
+            std::string_view m_text;
+            std::size_t m_position{0};
+            int m_depth{0};
+            int m_next_temporary{0};
+            Operand m_result{};
+        };
+
+    } // namespace
+
+    CompiledExpression CompiledExpression::compile(std::string_view text)
+    {
+        Compiler compiler{text};
+        compiler.compile();
+
+        CompiledExpression result;
+        result.m_registers_count = compiler.variables.size() + compiler.constants.size() +
+                                   static_cast<std::size_t>(compiler.temporaries_count);
+        if (result.m_registers_count > max_registers_count)
+            throw std::length_error(fmt::format("expression \"{}\" needs too many registers", text));
+
+        const auto to_register = [&compiler](const Operand& operand) {
+            return static_cast<std::uint8_t>(compiler.register_of(operand));
+        };
+        result.m_instructions.reserve(compiler.instructions.size());
+        for (const auto& instruction : compiler.instructions)
+        {
+            const Operand destination{Operand::Kind::temporary, instruction.destination, 0};
+            result.m_instructions.push_back(Instruction{instruction.op_code, to_register(destination),
+                                                        to_register(instruction.left), to_register(instruction.right)});
+        }
+        result.m_result = to_register(compiler.result());
+        result.m_text = std::string(text);
+        result.m_variables = std::move(compiler.variables);
+        result.m_constants = std::move(compiler.constants);
+        return result;
+    }
+
+    std::size_t CompiledExpression::variable_index(std::string_view name) const noexcept
+    {
+        const auto iter = std::find(m_variables.begin(), m_variables.end(), name);
+        if (iter == m_variables.end())
+            return std::string_view::npos;
+        return static_cast<std::size_t>(iter - m_variables.begin());
+    }
+
+    int CompiledExpression::evaluate(gsl::span<const int> values) const
+    {
+        if (static_cast<std::size_t>(values.size()) != m_variables.size())
+            throw std::invalid_argument(
+                fmt::format("expression \"{}\" needs {} values, not {}", m_text, m_variables.size(), values.size()));
+
+        std::array<int, max_registers_count> registers;
+        std::copy(values.begin(), values.end(), registers.begin());
+        std::copy(m_constants.begin(), m_constants.end(), registers.begin() + values.size());
+
+        for (const auto& instruction : m_instructions)
+        {
+            const auto left = registers[instruction.left];
+            const auto right = registers[instruction.right];
+            int result = 0;
+            switch (instruction.op_code)
+            {
+            case OpCode::add:
+                result = wrapping_add(left, right);
+                break;
+            case OpCode::subtract:
+                result = wrapping_subtract(left, right);
+                break;
+            case OpCode::multiply:
+                result = wrapping_multiply(left, right);
+                break;
+            case OpCode::divide:
+                result = checked_divide(left, right);
+                break;
+            case OpCode::modulo:
+                result = checked_modulo(left, right);
+                break;
+            case OpCode::negate:
+                result = wrapping_subtract(0, left);
+                break;
+            }
+            registers[instruction.destination] = result;
+        }
+        return registers[m_result];
+    }
+
+    void CompiledExpression::evaluate_batch(gsl::span<const gsl::span<const int>> columns,
+                                            gsl::span<int> results) const
+    {
+        if (columns.size() != m_variables.size())
+            throw std::invalid_argument(
+                fmt::format("expression \"{}\" needs {} columns, not {}", m_text, m_variables.size(), columns.size()));
+        for (const auto& column : columns)
+        {
+            if (column.size() != results.size())
+                throw std::invalid_argument("all the columns must have the size of the results");
+        }
+
+        // a block of rows for each register, the variables use theirs only for the last rows
+        const auto variables_count = m_variables.size();
+        std::vector<int> blocks(m_registers_count * batch_block_size);
+        std::array<int*, max_registers_count> register_blocks{};
+        std::array<const int*, max_registers_count> operands{};
+        for (std::size_t index = 0; index != m_registers_count; ++index)
+        {
+            register_blocks[index] = blocks.data() + index * batch_block_size;
+            operands[index] = register_blocks[index];
+        }
+        for (std::size_t index = 0; index != m_constants.size(); ++index)
+            std::fill_n(register_blocks[variables_count + index], batch_block_size, m_constants[index]);
+
+        const auto rows_count = results.size();
+        for (std::size_t first_row = 0; first_row < rows_count; first_row += batch_block_size)
+        {
+            const auto block_rows_count = std::min(batch_block_size, rows_count - first_row);
+            for (std::size_t index = 0; index != variables_count; ++index)
+            {
+                const auto* const values = columns[index].data() + first_row;
+                if (block_rows_count == batch_block_size)
+                {
+                    operands[index] = values;
+                }
+                else
+                {
+                    // the last rows are completed with ones, ignored by the checks of the divisors
+                    auto* const block = register_blocks[index];
+                    std::copy(values, values + block_rows_count, block);
+                    std::fill(block + block_rows_count, block + batch_block_size, 1);
+                    operands[index] = block;
+                }
+            }
+
+            for (const auto& instruction : m_instructions)
+                compute_block(instruction.op_code, operands[instruction.left], operands[instruction.right],
+                              register_blocks[instruction.destination], block_rows_count);
+
+            std::copy(operands[m_result], operands[m_result] + block_rows_count, results.data() + first_row);
+        }
+    }
+
+    std::string CompiledExpression::disassemble() const
+    {
+        const auto register_name = [this](std::uint8_t index) {
+            if (index < m_variables.size())
+                return m_variables[index];
+            if (index < m_variables.size() + m_constants.size())
+                return std::to_string(m_constants[index - m_variables.size()]);
+            return fmt::format("r{}", index);
+        };
+
+        std::string result;
+        for (const auto& instruction : m_instructions)
+        {
+            if (instruction.op_code == OpCode::negate)
+            {
+                result += fmt::format("{} = -{}\n", register_name(instruction.destination),
+                                      register_name(instruction.left));
+                continue;
+            }
+            constexpr char operators[] = {'+', '-', '*', '/', '%'};
+            result += fmt::format("{} = {} {} {}\n", register_name(instruction.destination),
+                                  register_name(instruction.left), operators[static_cast<int>(instruction.op_code)],
+                                  register_name(instruction.right));
+        }
+        result += fmt::format("return {}\n", register_name(m_result));
+        return result;
+    }
+
+    std::shared_ptr<const CompiledExpression> ExpressionCache::get(std::string_view text)
+    {
+        {
+            std::shared_lock lock{m_mutex};
+            const auto iter = m_expressions.find(text);
+            if (iter != m_expressions.end())
+                return iter->second;
+        }
+
+        // compiled without lock, another thread can compile the same expression at the same time
+        auto expression = std::make_shared<const CompiledExpression>(CompiledExpression::compile(text));
+
+        std::unique_lock lock{m_mutex};
+        const auto [iter, inserted] = m_expressions.try_emplace(std::string_view(expression->text()), expression);
+        return iter->second;
+    }
+
+    std::size_t ExpressionCache::size() const
+    {
+        std::shared_lock lock{m_mutex};
+        return m_expressions.size();
+    }
+
+    void ExpressionCache::clear()
+    {
+        std::unique_lock lock{m_mutex};
+        m_expressions.clear();
+    }
+
+} // namespace ajcf
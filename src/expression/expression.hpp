@@ -0,0 +1,138 @@
+// https://en.wikipedia.org/wiki/Recursive_descent_parser
+// https://en.wikipedia.org/wiki/Register_machine
+// https://www.lua.org/doc/jucs05.pdf (The implementation of Lua 5.0: register-based virtual machine)
+
+#pragma once
+
+#include <gsl/span>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ajcf {
+
+    // Arithmetic expression on ints, compiled once to a bytecode and evaluated many times by a register machine
+    // - syntax: integer literals, variables ([a-zA-Z_][a-zA-Z0-9_]*), parentheses,
+    //   unary + and -, binary * / % (evaluated before) + and -, all left-associative
+    // - the arithmetic wraps around on overflow, the division by zero throws std::domain_error
+    // - the sub-expressions on constants are computed by the compiler
+    // - the registers hold the variables, then the constants, then the intermediate results,
+    //   so that each instruction reads and writes registers only (no load instruction)
+    //   const auto expression = ajcf::CompiledExpression::compile("(price - discount) * quantity");
+    //   expression.variables();            // {"price", "discount", "quantity"}
+    //   expression.evaluate({100, 20, 3}); // 240
+    //   expression.evaluate_batch(columns, results); // columns of prices, discounts and quantities
+    class CompiledExpression
+    {
+    public:
+        enum class OpCode : std::uint8_t
+        {
+            add,
+            subtract,
+            multiply,
+            divide,
+            modulo,
+            negate, // of the left register only
+        };
+
+        // destination = left op right, the operands are indexes of registers
+        struct Instruction
+        {
+            OpCode op_code;
+            std::uint8_t destination;
+            std::uint8_t left;
+            std::uint8_t right;
+        };
+
+        static constexpr std::size_t max_registers_count = 256;
+
+        // Throw std::invalid_argument if the text is not a valid expression,
+        // std::length_error if it is too deeply nested or needs more than max_registers_count registers
+        static CompiledExpression compile(std::string_view text);
+
+        // The text of the expression
+        const std::string& text() const noexcept
+        {
+            return m_text;
+        }
+
+        // Names of the variables, in the order of their first appearance in the text
+        const std::vector<std::string>& variables() const noexcept
+        {
+            return m_variables;
+        }
+
+        // Index of a variable, or npos if the expression does not use it
+        std::size_t variable_index(std::string_view name) const noexcept;
+
+        const std::vector<Instruction>& instructions() const noexcept
+        {
+            return m_instructions;
+        }
+
+        std::size_t registers_count() const noexcept
+        {
+            return m_registers_count;
+        }
+
+        // Evaluate the expression with the values of the variables, in the order of variables()
+        // Throw std::invalid_argument if the number of values is not the number of variables
+        int evaluate(gsl::span<const int> values) const;
+
+        int evaluate(std::initializer_list<int> values) const
+        {
+            return evaluate(gsl::span<const int>(values.begin(), values.size()));
+        }
+
+        // Number of rows evaluated together by evaluate_batch: each instruction is applied to a whole block
+        static constexpr std::size_t batch_block_size = 256;
+
+        // Evaluate the expression for many rows at once, a column of values for each variable (in the order of
+        // variables()): results[row] is the value of the expression for columns[0][row], columns[1][row]...
+        // The instructions are applied column-at-a-time, in loops that the compiler can vectorize
+        // Throw std::invalid_argument if the number of columns is not the number of variables
+        // or if a column does not have the size of results
+        void evaluate_batch(gsl::span<const gsl::span<const int>> columns, gsl::span<int> results) const;
+
+        // Human readable listing of the bytecode, one instruction per line
+        std::string disassemble() const;
+
+    private:
+        CompiledExpression() = default;
+
+        std::string m_text;
+        std::vector<std::string> m_variables;
+        std::vector<int> m_constants; // in the registers following the variables
+        std::vector<Instruction> m_instructions;
+        std::size_t m_registers_count{0};
+        std::uint8_t m_result{0}; // register of the result
+    };
+
+    // Thread-safe cache of compiled expressions, indexed by their text
+    //   ajcf::ExpressionCache cache;
+    //   for (const auto& row : rows)
+    //       total += cache.get(row.formula)->evaluate({row.x, row.y}); // each formula is compiled only once
+    class ExpressionCache
+    {
+    public:
+        // The compiled expression, compiled at the first call for this text
+        // Throw like CompiledExpression::compile (the invalid expressions are not cached)
+        std::shared_ptr<const CompiledExpression> get(std::string_view text);
+
+        std::size_t size() const;
+
+        void clear();
+
+    private:
+        mutable std::shared_mutex m_mutex;
+        // the keys view the texts of the compiled expressions
+        std::unordered_map<std::string_view, std::shared_ptr<const CompiledExpression>> m_expressions;
+    };
+
+} // namespace ajcf
@@ -0,0 +1,252 @@
+// https://en.cppreference.com/w/cpp/thread/packaged_task
+// https://en.cppreference.com/w/cpp/io/basic_istream/read
+// https://en.cppreference.com/w/cpp/thread/condition_variable
+
+#include "expression_file.hpp"
+#include "expression.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace ajcf {
+
+    namespace {
+
+        struct ChunkResult
+        {
+            std::string output;
+            std::size_t expressions_count = 0;
+            std::size_t errors_count = 0;
+        };
+
+        bool is_blank(std::string_view line) noexcept
+        {
+            return std::all_of(line.begin(), line.end(), [](char c) { return c == ' ' || c == '\t'; });
+        }
+
+        ChunkResult evaluate_lines(std::string_view lines)
+        {
+            ChunkResult result;
+            result.output.reserve(lines.size() / 2);
+            while (!lines.empty())
+            {
+                const auto end_of_line = std::min(lines.find('\n'), lines.size());
+                auto line = lines.substr(0, end_of_line);
+                lines.remove_prefix(std::min(end_of_line + 1, lines.size()));
+
+                if (!line.empty() && line.back() == '\r')
+                    line.remove_suffix(1);
+                if (!is_blank(line))
+                {
+                    ++result.expressions_count;
+                    try
+                    {
+                        // no values: an expression with variables is an error
+                        const auto value = CompiledExpression::compile(line).evaluate({});
+                        const fmt::format_int text{value};
+                        result.output.append(text.data(), text.size());
+                    }
+                    catch (const std::exception& e)
+                    {
+                        ++result.errors_count;
+                        result.output += "error: ";
+                        result.output += e.what();
+                    }
+                }
+                result.output += '\n';
+            }
+            return result;
+        }
+
+        // Next chunk of whole lines, of at least chunk_size bytes except at the end of the input
+        // The incomplete last line is moved to rest, for the next chunk
+        bool read_lines_chunk(std::istream& input, std::size_t chunk_size, std::string& rest, std::string& chunk)
+        {
+            chunk = std::move(rest);
+            rest.clear();
+            for (;;)
+            {
+                const auto old_size = chunk.size();
+                chunk.resize(old_size + chunk_size);
+                input.read(chunk.data() + old_size, static_cast<std::streamsize>(chunk_size));
+                chunk.resize(old_size + static_cast<std::size_t>(input.gcount()));
+                if (chunk.size() == old_size)
+                    return !chunk.empty(); // the last line has no newline
+
+                const auto last_newline = chunk.rfind('\n');
+                if (last_newline != std::string::npos)
+                {
+                    rest.assign(chunk, last_newline + 1);
+                    chunk.resize(last_newline + 1);
+                    return true;
+                }
+                if (!input)
+                    return true;
+            }
+        }
+
+        // Tasks of the worker threads, the workers stop when the queue is closed and empty
+        class TaskQueue
+        {
+        public:
+            void push(std::packaged_task<ChunkResult()> task)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_tasks.push_back(std::move(task));
+                }
+                m_condition.notify_one();
+            }
+
+            bool pop(std::packaged_task<ChunkResult()>& task)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this] { return m_closed || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                    return false;
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                return true;
+            }
+
+            void close()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_closed = true;
+                }
+                m_condition.notify_all();
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            std::deque<std::packaged_task<ChunkResult()>> m_tasks;
+            bool m_closed = false;
+        };
+
+        // The threads are joined by the destructor, also when the reading or the writing throws
+        class WorkerThreads
+        {
+        public:
+            WorkerThreads(TaskQueue& tasks, unsigned threads_count) : m_tasks(tasks)
+            {
+                for (unsigned index = 0; index != threads_count; ++index)
+                {
+                    m_threads.emplace_back([&tasks] {
+                        std::packaged_task<ChunkResult()> task;
+                        while (tasks.pop(task))
+                            task();
+                    });
+                }
+            }
+
+            WorkerThreads(const WorkerThreads&) = delete;
+            WorkerThreads& operator=(const WorkerThreads&) = delete;
+
+            ~WorkerThreads()
+            {
+                m_tasks.close();
+                for (auto& thread : m_threads)
+                    thread.join();
+            }
+
+        private:
+            TaskQueue& m_tasks;
+            std::vector<std::thread> m_threads;
+        };
+
+    } // namespace
+
+    ExpressionFileStatistics evaluate_expression_file(std::istream& input, std::ostream& output,
+                                                      const ExpressionFileOptions& options)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const auto threads_count = options.threads_count != 0 ? options.threads_count
+                                                               : std::max(1U, std::thread::hardware_concurrency());
+        const auto chunk_size = std::max<std::size_t>(options.chunk_size, 1);
+
+        ExpressionFileStatistics statistics;
+        // the futures of the chunks being evaluated, in the input order
+        std::deque<std::future<ChunkResult>> pending;
+        const auto write_oldest = [&] {
+            const auto result = pending.front().get();
+            pending.pop_front();
+            output.write(result.output.data(), static_cast<std::streamsize>(result.output.size()));
+            if (!output)
+                throw std::runtime_error("cannot write the results of the expressions");
+            statistics.expressions_count += result.expressions_count;
+            statistics.errors_count += result.errors_count;
+        };
+
+        TaskQueue tasks;
+        WorkerThreads workers{tasks, threads_count};
+        std::string chunk;
+        std::string rest;
+        while (read_lines_chunk(input, chunk_size, rest, chunk))
+        {
+            statistics.bytes_count += chunk.size();
+            std::packaged_task<ChunkResult()> task{[lines = std::move(chunk)] { return evaluate_lines(lines); }};
+            pending.push_back(task.get_future());
+            tasks.push(std::move(task));
+            if (pending.size() >= 2 * std::size_t{threads_count})
+                write_oldest();
+        }
+        while (!pending.empty())
+            write_oldest();
+        output.flush();
+
+        statistics.elapsed = std::chrono::steady_clock::now() - start;
+        return statistics;
+    }
+
+    void generate_expression_file(std::ostream& output, std::size_t bytes_count, unsigned seed)
+    {
+        constexpr std::string_view operators = "+-*/%";
+        std::mt19937 random{seed};
+        std::uniform_int_distribution<int> operands_count_distribution(1, 6);
+        std::uniform_int_distribution<int> operand_distribution(0, 999);
+        std::uniform_int_distribution<std::size_t> operator_distribution(0, operators.size() - 1);
+        std::bernoulli_distribution parenthesis_distribution(0.2);
+
+        std::string buffer;
+        std::size_t written_count = 0;
+        while (written_count < bytes_count)
+        {
+            const auto operands_count = operands_count_distribution(random);
+            for (int index = 0; index != operands_count; ++index)
+            {
+                if (index != 0)
+                    fmt::format_to(std::back_inserter(buffer), " {} ", operators[operator_distribution(random)]);
+                if (index + 1 != operands_count && parenthesis_distribution(random))
+                {
+                    fmt::format_to(std::back_inserter(buffer), "({} {} {})", operand_distribution(random),
+                                   operators[operator_distribution(random)], operand_distribution(random));
+                    ++index;
+                }
+                else
+                    fmt::format_to(std::back_inserter(buffer), "{}", operand_distribution(random));
+            }
+            buffer += '\n';
+
+            if (buffer.size() >= (1 << 16) || written_count + buffer.size() >= bytes_count)
+            {
+                output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                written_count += buffer.size();
+                buffer.clear();
+            }
+        }
+    }
+
+} // namespace ajcf
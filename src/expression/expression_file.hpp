@@ -0,0 +1,53 @@
+// https://en.cppreference.com/w/cpp/thread/packaged_task
+// https://en.cppreference.com/w/cpp/io/basic_istream/read
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+
+namespace ajcf {
+
+    struct ExpressionFileOptions
+    {
+        // The input is split in chunks of at least chunk_size bytes, cut after a newline
+        std::size_t chunk_size = 1 << 20;
+        // 0: one thread for each core
+        unsigned threads_count = 0;
+    };
+
+    struct ExpressionFileStatistics
+    {
+        std::size_t bytes_count = 0;       // of the input
+        std::size_t expressions_count = 0; // the empty lines are not counted
+        std::size_t errors_count = 0;
+        std::chrono::duration<double> elapsed{};
+
+        double megabytes_per_second() const noexcept
+        {
+            return static_cast<double>(bytes_count) / elapsed.count() / 1e6;
+        }
+
+        double expressions_per_second() const noexcept
+        {
+            return static_cast<double>(expressions_count) / elapsed.count();
+        }
+    };
+
+    // Evaluate the expressions of the input, one ajcf::CompiledExpression per line, and write one line per input line:
+    // the result, "error: <message>" if the expression is invalid, or an empty line for an empty line
+    // The chunks are evaluated in parallel by threads_count threads, the results are written in the input order
+    // while the next chunks are evaluated (at most two chunks per thread are in memory)
+    //   std::ifstream input{"expressions.txt", std::ios::binary};
+    //   std::ofstream output{"results.txt", std::ios::binary};
+    //   const auto statistics = ajcf::evaluate_expression_file(input, output);
+    // Throw std::runtime_error if the output cannot be written
+    ExpressionFileStatistics evaluate_expression_file(std::istream& input, std::ostream& output,
+                                                      const ExpressionFileOptions& options = {});
+
+    // Write random expressions without variables, one per line, until at least bytes_count bytes are written
+    // (some divide by zero, to have some errors)
+    void generate_expression_file(std::ostream& output, std::size_t bytes_count, unsigned seed = 42);
+
+} // namespace ajcf
@@ -0,0 +1,122 @@
+// https://en.cppreference.com/w/cpp/utility/from_chars
+// https://en.cppreference.com/w/cpp/io/ios_base/sync_with_stdio
+
+#include "expression_file.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    constexpr const char* usage = R"(Evaluate a file of arithmetic expressions, one per line, on all the cores
+
+usage:
+  expression_evaluator [--threads <count>] [--chunk-size <bytes>] <input> [<output>]
+  expression_evaluator --generate <output> <megabytes>
+
+The results are written to the output (default: standard output), one line per input line,
+the throughput is written to the standard error.
+)";
+
+    template <typename Number>
+    Number parse_number(std::string_view text)
+    {
+        Number number{};
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+        if (error != std::errc{} || end != text.data() + text.size() || number == 0)
+            throw std::invalid_argument(fmt::format("\"{}\" is not a positive number", text));
+        return number;
+    }
+
+    int generate(const std::string& output_path, std::size_t megabytes_count)
+    {
+        std::ofstream output{output_path, std::ios::binary};
+        if (!output)
+            throw std::runtime_error(fmt::format("cannot open {}", output_path));
+        ajcf::generate_expression_file(output, megabytes_count << 20);
+        return 0;
+    }
+
+    int evaluate(const std::string& input_path, const std::optional<std::string>& output_path,
+                 const ajcf::ExpressionFileOptions& options)
+    {
+        std::ifstream input{input_path, std::ios::binary};
+        if (!input)
+            throw std::runtime_error(fmt::format("cannot open {}", input_path));
+
+        std::ofstream output_file;
+        if (output_path)
+        {
+            output_file.open(*output_path, std::ios::binary);
+            if (!output_file)
+                throw std::runtime_error(fmt::format("cannot open {}", *output_path));
+        }
+
+        const auto statistics =
+            ajcf::evaluate_expression_file(input, output_path ? output_file : std::cout, options);
+
+        const auto threads_count =
+            options.threads_count != 0 ? options.threads_count : std::max(1U, std::thread::hardware_concurrency());
+        fmt::print(stderr, "{} expressions ({} errors), {:.1f} MB in {:.3f} s on {} threads\n",
+                   statistics.expressions_count, statistics.errors_count,
+                   static_cast<double>(statistics.bytes_count) / 1e6, statistics.elapsed.count(), threads_count);
+        fmt::print(stderr, "{:.1f} MB/s, {:.2f} M expressions/s\n", statistics.megabytes_per_second(),
+                   statistics.expressions_per_second() / 1e6);
+        return 0;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::ios::sync_with_stdio(false);
+
+    try
+    {
+        const std::vector<std::string> arguments(argv + 1, argv + argc);
+        if (arguments.size() == 3 && arguments[0] == "--generate")
+            return generate(arguments[1], parse_number<std::size_t>(arguments[2]));
+
+        ajcf::ExpressionFileOptions options;
+        std::vector<std::string> paths;
+        bool valid_options = true;
+        for (std::size_t index = 0; index != arguments.size(); ++index)
+        {
+            const auto& argument = arguments[index];
+            if ((argument == "--threads" || argument == "--chunk-size") && index + 1 != arguments.size())
+            {
+                const auto& value = arguments[++index];
+                if (argument == "--threads")
+                    options.threads_count = parse_number<unsigned>(value);
+                else
+                    options.chunk_size = parse_number<std::size_t>(value);
+            }
+            else if (argument.empty() || argument[0] == '-')
+                valid_options = false;
+            else
+                paths.push_back(argument);
+        }
+
+        if (!valid_options || paths.empty() || paths.size() > 2)
+        {
+            fmt::print(stderr, "{}", usage);
+            return 1;
+        }
+        return evaluate(paths[0], paths.size() == 2 ? std::optional<std::string>{paths[1]} : std::nullopt, options);
+    }
+    catch (const std::exception& e)
+    {
+        fmt::print(stderr, "error: {}\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,82 @@
+// https://en.cppreference.com/w/cpp/memory/new/operator_new (global replacements)
+// https://en.cppreference.com/w/cpp/memory/new/operator_delete (global replacements)
+
+#include "allocation_counter.hpp"
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // trivially constructible and destructible: usable even while a thread starts or exits
+    thread_local std::size_t allocations_count = 0;
+
+    void* allocate_and_count(std::size_t size) noexcept
+    {
+        ++allocations_count;
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+} // namespace
+
+// note: the array versions and the versions with std::nothrow_t call these ones by default
+void* operator new(std::size_t size)
+{
+    void* const pointer = allocate_and_count(size);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate_and_count(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace ajcf {
+
+    std::size_t thread_allocations_count() noexcept
+    {
+        return allocations_count;
+    }
+
+} // namespace ajcf
+
+namespace {
+
+    TEST_CASE("counting dynamic allocations", "[allocation]")
+    {
+        ajcf::AllocationCounter counter;
+
+        auto p = std::make_unique<int>(42);
+
+        REQUIRE(counter.allocations() == 1);
+
+        std::vector<int> v(100);
+
+        REQUIRE(counter.allocations() == 2);
+
+        // short strings are stored inside the string object (small string optimization)
+        std::string short_string = "Hello++";
+
+        REQUIRE(counter.allocations() == 2);
+
+        std::string long_string = "Hello++ Hello++ Hello++ Hello++ Hello++";
+
+        REQUIRE(counter.allocations() == 3);
+    }
+
+} // namespace
@@ -0,0 +1,33 @@
+// https://en.cppreference.com/w/cpp/memory/new/operator_new (global replacements)
+
+#pragma once
+
+#include <cstddef>
+
+namespace ajcf {
+
+    // Number of dynamic allocations (calls to the global operator new) made by the calling thread
+    // The program's global operator new and operator delete are replaced to count them
+    std::size_t thread_allocations_count() noexcept;
+
+    // Count the dynamic allocations made by the calling thread during the lifetime of the counter:
+    //   AllocationCounter counter;
+    //   std::string s(100, 'A');
+    //   REQUIRE(counter.allocations() == 1);
+    class AllocationCounter
+    {
+    public:
+        AllocationCounter() noexcept : m_start(thread_allocations_count())
+        {
+        }
+
+        std::size_t allocations() const noexcept
+        {
+            return thread_allocations_count() - m_start;
+        }
+
+    private:
+        std::size_t m_start;
+    };
+
+} // namespace ajcf
@@ -0,0 +1,795 @@
+// https://man7.org/linux/man-pages/man7/io_uring.7.html
+// https://man7.org/linux/man-pages/man2/io_uring_setup.2.html
+// https://man7.org/linux/man-pages/man2/io_uring_enter.2.html
+// https://man7.org/linux/man-pages/man2/io_uring_register.2.html
+
+#include "async_file_io.hpp"
+
+#if defined(AJCF_ASYNC_FILE_IO_AVAILABLE)
+
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace ajcf {
+
+    const char* to_string(AsyncIoBackend backend) noexcept
+    {
+        switch (backend)
+        {
+        case AsyncIoBackend::io_uring:
+            return "io_uring";
+        case AsyncIoBackend::thread_pool:
+            return "thread pool";
+        }
+        return "?";
+    }
+
+    namespace async_file_io_details {
+
+        namespace {
+
+            // Like pread and pwrite on Linux, which transfer at most 0x7ffff000 bytes
+            constexpr std::size_t max_transfer_size = 0x7ffff000;
+
+#if defined(__linux__)
+            // Without liburing: the rings are shared with the kernel by mmap, the heads and the tails are
+            // written by one side and read by the other, with release and acquire
+            class IoUringBackend final : public Backend
+            {
+            public:
+                // nullptr if io_uring is not available
+                static std::unique_ptr<Backend> create(unsigned entries)
+                {
+                    io_uring_params params{};
+                    const auto ring = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+                    if (ring == -1)
+                        return nullptr;
+                    std::unique_ptr<IoUringBackend> backend{new IoUringBackend{ring, params}};
+                    if (!backend->map(params) || !backend->supports_operations())
+                        return nullptr;
+                    return backend;
+                }
+
+                IoUringBackend(const IoUringBackend&) = delete;
+                IoUringBackend& operator=(const IoUringBackend&) = delete;
+
+                ~IoUringBackend() override
+                {
+                    if (m_sqes != MAP_FAILED)
+                        ::munmap(m_sqes, m_sqes_size);
+                    if (m_cq_ring != MAP_FAILED && m_cq_ring != m_sq_ring)
+                        ::munmap(m_cq_ring, m_cq_ring_size);
+                    if (m_sq_ring != MAP_FAILED)
+                        ::munmap(m_sq_ring, m_sq_ring_size);
+                    ::close(m_ring);
+                }
+
+                AsyncIoBackend kind() const noexcept override
+                {
+                    return AsyncIoBackend::io_uring;
+                }
+
+                void register_buffers(gsl::span<const gsl::span<char>> buffers) override
+                {
+                    if (m_buffers_registered)
+                    {
+                        ::syscall(__NR_io_uring_register, m_ring, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+                        m_buffers_registered = false;
+                    }
+                    if (buffers.empty())
+                        return;
+                    std::vector<iovec> vectors;
+                    vectors.reserve(buffers.size());
+                    for (const auto buffer : buffers)
+                        vectors.push_back({buffer.data(), buffer.size()});
+                    if (::syscall(__NR_io_uring_register, m_ring, IORING_REGISTER_BUFFERS, vectors.data(),
+                                  static_cast<unsigned>(vectors.size())) == -1)
+                        throw std::system_error(errno, std::generic_category(), "cannot register the buffers");
+                    m_buffers_registered = true;
+                }
+
+                void prepare(Operation&& operation) override
+                {
+                    const auto slot = m_free_slots.back();
+                    m_free_slots.pop_back();
+                    m_callbacks[slot] = std::move(operation.callback);
+
+                    const auto index = m_sq_local_tail & m_sq_mask;
+                    auto& entry = m_sqes[index];
+                    std::memset(&entry, 0, sizeof(entry));
+                    const bool fixed = operation.buffer_index >= 0;
+                    entry.opcode = operation.is_write ? (fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE)
+                                                      : (fixed ? IORING_OP_READ_FIXED : IORING_OP_READ);
+                    entry.fd = operation.descriptor;
+                    entry.off = operation.offset;
+                    entry.addr = reinterpret_cast<std::uintptr_t>(operation.data);
+                    entry.len = static_cast<std::uint32_t>(std::min(operation.size, max_transfer_size));
+                    entry.buf_index = static_cast<std::uint16_t>(fixed ? operation.buffer_index : 0);
+                    entry.user_data = slot;
+                    m_sq_array[index] = index;
+                    ++m_sq_local_tail;
+                    ++m_prepared_count;
+                }
+
+                void submit() override
+                {
+                    if (m_prepared_count == 0)
+                        return;
+                    __atomic_store_n(m_sq_tail, m_sq_local_tail, __ATOMIC_RELEASE);
+                    while (m_prepared_count != 0)
+                    {
+                        const auto submitted = enter(m_prepared_count, 0, 0);
+                        if (submitted == -1)
+                            throw std::system_error(errno, std::generic_category(), "cannot submit to io_uring");
+                        m_prepared_count -= static_cast<unsigned>(submitted);
+                    }
+                }
+
+                void reap(std::vector<Completion>& completions, bool wait) override
+                {
+                    auto head = *m_cq_head;
+                    auto tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+                    while (head == tail && wait)
+                    {
+                        if (enter(0, 1, IORING_ENTER_GETEVENTS) == -1)
+                            throw std::system_error(errno, std::generic_category(), "cannot wait for io_uring");
+                        tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+                    }
+                    for (; head != tail; ++head)
+                    {
+                        const auto& entry = m_cqes[head & m_cq_mask];
+                        const auto slot = static_cast<unsigned>(entry.user_data);
+                        completions.push_back({std::move(m_callbacks[slot]),
+                                               entry.res < 0 ? AsyncIoResult{tl::unexpected(std::error_code(
+                                                                   -entry.res, std::generic_category()))}
+                                                             : AsyncIoResult{static_cast<std::size_t>(entry.res)}});
+                        m_free_slots.push_back(slot);
+                    }
+                    __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+                }
+
+            private:
+                IoUringBackend(int ring, const io_uring_params& params)
+                    : m_ring(ring), m_callbacks(params.sq_entries), m_free_slots(params.sq_entries)
+                {
+                    std::iota(m_free_slots.rbegin(), m_free_slots.rend(), 0u);
+                }
+
+                bool map(const io_uring_params& params)
+                {
+                    m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                    m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                    const bool single_mapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                    if (single_mapping)
+                        m_sq_ring_size = m_cq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+                    m_sq_ring = ::mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                       m_ring, IORING_OFF_SQ_RING);
+                    if (m_sq_ring == MAP_FAILED)
+                        return false;
+                    m_cq_ring = single_mapping ? m_sq_ring
+                                               : ::mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE,
+                                                        MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_CQ_RING);
+                    if (m_cq_ring == MAP_FAILED)
+                        return false;
+                    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+                    const auto sqes = ::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                             m_ring, IORING_OFF_SQES);
+                    if (sqes == MAP_FAILED)
+                        return false;
+                    m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+                    const auto sq_ring = static_cast<char*>(m_sq_ring);
+                    m_sq_tail = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.tail);
+                    m_sq_mask = *reinterpret_cast<unsigned*>(sq_ring + params.sq_off.ring_mask);
+                    m_sq_array = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.array);
+                    m_sq_local_tail = *m_sq_tail;
+                    const auto cq_ring = static_cast<char*>(m_cq_ring);
+                    m_cq_head = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.head);
+                    m_cq_tail = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.tail);
+                    m_cq_mask = *reinterpret_cast<unsigned*>(cq_ring + params.cq_off.ring_mask);
+                    m_cqes = reinterpret_cast<io_uring_cqe*>(cq_ring + params.cq_off.cqes);
+                    return true;
+                }
+
+                // IORING_OP_READ and IORING_OP_WRITE appeared in Linux 5.6
+                bool supports_operations() const
+                {
+                    constexpr unsigned operations_count = 256;
+                    std::vector<char> storage(sizeof(io_uring_probe) + operations_count * sizeof(io_uring_probe_op));
+                    const auto probe = reinterpret_cast<io_uring_probe*>(storage.data());
+                    if (::syscall(__NR_io_uring_register, m_ring, IORING_REGISTER_PROBE, probe, operations_count) == -1)
+                        return false;
+                    const auto supports = [&](unsigned operation) {
+                        return operation <= probe->last_op && (probe->ops[operation].flags & IO_URING_OP_SUPPORTED);
+                    };
+                    return supports(IORING_OP_READ) && supports(IORING_OP_WRITE);
+                }
+
+                int enter(unsigned to_submit, unsigned min_complete, unsigned flags) const
+                {
+                    for (;;)
+                    {
+                        const auto result = static_cast<int>(
+                            ::syscall(__NR_io_uring_enter, m_ring, to_submit, min_complete, flags, nullptr, 0));
+                        if (result != -1 || errno != EINTR)
+                            return result;
+                    }
+                }
+
+                int m_ring;
+                void* m_sq_ring{MAP_FAILED};
+                std::size_t m_sq_ring_size{0};
+                void* m_cq_ring{MAP_FAILED};
+                std::size_t m_cq_ring_size{0};
+                io_uring_sqe* m_sqes{static_cast<io_uring_sqe*>(MAP_FAILED)};
+                std::size_t m_sqes_size{0};
+                unsigned* m_sq_tail{nullptr};
+                unsigned m_sq_mask{0};
+                unsigned* m_sq_array{nullptr};
+                unsigned m_sq_local_tail{0}; // tail of the prepared entries, published by submit
+                unsigned m_prepared_count{0};
+                unsigned* m_cq_head{nullptr};
+                unsigned* m_cq_tail{nullptr};
+                unsigned m_cq_mask{0};
+                io_uring_cqe* m_cqes{nullptr};
+                bool m_buffers_registered{false};
+                // the callbacks of the operations in flight, the user data of an operation is its slot
+                std::vector<AsyncIoCallback> m_callbacks;
+                std::vector<unsigned> m_free_slots;
+            };
+#endif
+
+            // pread and pwrite on a pool of threads, the completions are queued for the waiting thread
+            class ThreadPoolBackend final : public Backend
+            {
+            public:
+                explicit ThreadPoolBackend(unsigned threads_count)
+                {
+                    m_threads.reserve(threads_count);
+                    for (unsigned index = 0; index != threads_count; ++index)
+                        m_threads.emplace_back([this] { run(); });
+                }
+
+                ThreadPoolBackend(const ThreadPoolBackend&) = delete;
+                ThreadPoolBackend& operator=(const ThreadPoolBackend&) = delete;
+
+                ~ThreadPoolBackend() override
+                {
+                    {
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        m_closed = true;
+                    }
+                    m_operation_queued.notify_all();
+                    for (auto& thread : m_threads)
+                        thread.join();
+                }
+
+                AsyncIoBackend kind() const noexcept override
+                {
+                    return AsyncIoBackend::thread_pool;
+                }
+
+                // The operations receive the addresses of the registered buffers
+                void register_buffers(gsl::span<const gsl::span<char>>) override
+                {
+                }
+
+                void prepare(Operation&& operation) override
+                {
+                    m_prepared.push_back(std::move(operation));
+                }
+
+                void submit() override
+                {
+                    if (m_prepared.empty())
+                        return;
+                    {
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        for (auto& operation : m_prepared)
+                            m_operations.push_back(std::move(operation));
+                    }
+                    if (m_prepared.size() == 1)
+                        m_operation_queued.notify_one();
+                    else
+                        m_operation_queued.notify_all();
+                    m_prepared.clear();
+                }
+
+                void reap(std::vector<Completion>& completions, bool wait) override
+                {
+                    std::unique_lock<std::mutex> lock{m_mutex};
+                    if (wait)
+                        m_operation_completed.wait(lock, [&] { return !m_completions.empty(); });
+                    for (auto& completion : m_completions)
+                        completions.push_back(std::move(completion));
+                    m_completions.clear();
+                }
+
+            private:
+                static AsyncIoResult perform(const Operation& operation) noexcept
+                {
+                    const auto size = std::min(operation.size, max_transfer_size);
+                    const auto offset = static_cast<off_t>(operation.offset);
+                    for (;;)
+                    {
+                        const auto result = operation.is_write
+                                                ? ::pwrite(operation.descriptor, operation.data, size, offset)
+                                                : ::pread(operation.descriptor, operation.data, size, offset);
+                        if (result != -1)
+                            return static_cast<std::size_t>(result);
+                        if (errno != EINTR)
+                            return tl::unexpected(std::error_code(errno, std::generic_category()));
+                    }
+                }
+
+                void run()
+                {
+                    std::unique_lock<std::mutex> lock{m_mutex};
+                    for (;;)
+                    {
+                        m_operation_queued.wait(lock, [&] { return m_closed || !m_operations.empty(); });
+                        if (m_operations.empty())
+                            return;
+                        auto operation = std::move(m_operations.front());
+                        m_operations.pop_front();
+                        lock.unlock();
+                        auto result = perform(operation);
+                        lock.lock();
+                        m_completions.push_back({std::move(operation.callback), std::move(result)});
+                        m_operation_completed.notify_one();
+                    }
+                }
+
+                std::vector<Operation> m_prepared; // accessed by the submitting thread only
+                std::mutex m_mutex;
+                std::condition_variable m_operation_queued;
+                std::condition_variable m_operation_completed;
+                std::deque<Operation> m_operations;
+                std::vector<Completion> m_completions;
+                bool m_closed{false};
+                std::vector<std::thread> m_threads;
+            };
+
+            std::unique_ptr<Backend> create_backend(const AsyncFileIoOptions& options)
+            {
+                if (options.queue_depth == 0)
+                    throw std::invalid_argument("the queue depth of ajcf::AsyncFileIo must not be 0");
+#if defined(__linux__)
+                if (options.use_io_uring)
+                {
+                    if (auto backend = IoUringBackend::create(options.queue_depth))
+                        return backend;
+                }
+#endif
+                // the threads wait for the disk most of the time: more threads than cores
+                const auto threads_count = options.threads_count != 0
+                                               ? options.threads_count
+                                               : std::max(4u, std::thread::hardware_concurrency());
+                return std::make_unique<ThreadPoolBackend>(threads_count);
+            }
+
+        } // namespace
+
+    } // namespace async_file_io_details
+
+    AsyncFileIo::AsyncFileIo(const AsyncFileIoOptions& options)
+        : m_backend(async_file_io_details::create_backend(options)), m_queue_depth(options.queue_depth)
+    {
+    }
+
+    AsyncFileIo::~AsyncFileIo()
+    {
+        // the kernel or the threads still write in the buffers of the operations in flight
+        try
+        {
+            while (m_in_flight_count != 0)
+            {
+                m_completions.clear();
+                m_backend->reap(m_completions, true);
+                m_in_flight_count -= m_completions.size();
+            }
+        }
+        catch (const std::system_error&)
+        {
+        }
+    }
+
+    void AsyncFileIo::register_buffers(gsl::span<const gsl::span<char>> buffers)
+    {
+        if (m_in_flight_count != 0)
+            throw std::logic_error("ajcf::AsyncFileIo::register_buffers: operations are in flight");
+        m_backend->register_buffers(buffers);
+        m_registered_buffers.assign(buffers.begin(), buffers.end());
+    }
+
+    void AsyncFileIo::read(int descriptor, gsl::span<char> buffer, std::uint64_t offset, AsyncIoCallback callback)
+    {
+        queue(false, descriptor, buffer.data(), buffer.size(), offset, -1, std::move(callback));
+    }
+
+    void AsyncFileIo::write(int descriptor, gsl::span<const char> data, std::uint64_t offset, AsyncIoCallback callback)
+    {
+        // the data is only read by the kernel
+        queue(true, descriptor, const_cast<char*>(data.data()), data.size(), offset, -1, std::move(callback));
+    }
+
+    void AsyncFileIo::read_fixed(int descriptor, std::size_t buffer_index, std::size_t size, std::uint64_t offset,
+                                 AsyncIoCallback callback)
+    {
+        queue(false, descriptor, registered_buffer(buffer_index, size), size, offset, static_cast<int>(buffer_index),
+              std::move(callback));
+    }
+
+    void AsyncFileIo::write_fixed(int descriptor, std::size_t buffer_index, std::size_t size, std::uint64_t offset,
+                                  AsyncIoCallback callback)
+    {
+        queue(true, descriptor, registered_buffer(buffer_index, size), size, offset, static_cast<int>(buffer_index),
+              std::move(callback));
+    }
+
+    std::size_t AsyncFileIo::submit()
+    {
+        std::size_t submitted_count = 0;
+        while (!m_queued.empty() && m_in_flight_count != m_queue_depth)
+        {
+            m_backend->prepare(std::move(m_queued.front()));
+            m_queued.pop_front();
+            ++m_in_flight_count;
+            ++submitted_count;
+        }
+        m_backend->submit();
+        return submitted_count;
+    }
+
+    std::size_t AsyncFileIo::wait_some()
+    {
+        submit();
+        if (m_in_flight_count == 0)
+            return 0;
+        m_completions.clear();
+        m_backend->reap(m_completions, true);
+        m_in_flight_count -= m_completions.size();
+        // the callbacks can queue other operations, which are submitted by the next wait
+        for (auto& completion : m_completions)
+            completion.callback(std::move(completion.result));
+        const auto completed_count = m_completions.size();
+        m_completions.clear();
+        return completed_count;
+    }
+
+    void AsyncFileIo::wait_all()
+    {
+        while (pending_count() != 0)
+            wait_some();
+    }
+
+    void AsyncFileIo::queue(bool is_write, int descriptor, char* data, std::size_t size, std::uint64_t offset,
+                            int buffer_index, AsyncIoCallback&& callback)
+    {
+        m_queued.push_back({is_write, descriptor, data, size, offset, buffer_index, std::move(callback)});
+    }
+
+    char* AsyncFileIo::registered_buffer(std::size_t buffer_index, std::size_t size) const
+    {
+        if (buffer_index >= m_registered_buffers.size())
+            throw std::out_of_range("ajcf::AsyncFileIo: no registered buffer " + std::to_string(buffer_index));
+        if (size > m_registered_buffers[buffer_index].size())
+            throw std::out_of_range("ajcf::AsyncFileIo: the registered buffer " + std::to_string(buffer_index) +
+                                    " is smaller than " + std::to_string(size) + " bytes");
+        return m_registered_buffers[buffer_index].data();
+    }
+
+} // namespace ajcf
+
+namespace {
+
+    // Descriptor of a file (RAII)
+    class Descriptor
+    {
+    public:
+        Descriptor(const std::filesystem::path& path, int flags) : m_descriptor(::open(path.c_str(), flags, 0666))
+        {
+            if (m_descriptor == -1)
+                throw std::system_error(errno, std::generic_category(), "cannot open the file " + path.string());
+        }
+
+        Descriptor(const Descriptor&) = delete;
+        Descriptor& operator=(const Descriptor&) = delete;
+
+        ~Descriptor()
+        {
+            ::close(m_descriptor);
+        }
+
+        int get() const noexcept
+        {
+            return m_descriptor;
+        }
+
+    private:
+        int m_descriptor;
+    };
+
+    std::vector<ajcf::AsyncFileIoOptions> all_backends_options()
+    {
+        ajcf::AsyncFileIoOptions thread_pool;
+        thread_pool.use_io_uring = false;
+        return {ajcf::AsyncFileIoOptions{}, thread_pool};
+    }
+
+    TEST_CASE("asynchronous file I/O: write then read", "[input][output][async_file_io]")
+    {
+        const auto path = std::filesystem::temp_directory_path() / "ajcf_async_file_io.bin";
+        for (const auto& options : all_backends_options())
+        {
+            ajcf::AsyncFileIo io{options};
+            INFO(ajcf::to_string(io.backend()));
+            if (!options.use_io_uring)
+                REQUIRE(io.backend() == ajcf::AsyncIoBackend::thread_pool);
+
+            const std::string first(100'000, 'a');
+            const std::string second = "second block";
+            {
+                const Descriptor file{path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC};
+                std::vector<ajcf::AsyncIoResult> results;
+                io.write(file.get(), first, 0, [&](ajcf::AsyncIoResult result) { results.push_back(result); });
+                io.write(file.get(), second, first.size(), [&](ajcf::AsyncIoResult result) {
+                    results.push_back(result);
+                });
+                REQUIRE(io.pending_count() == 2);
+                REQUIRE(results.empty()); // nothing done before a wait
+                io.wait_all();
+                REQUIRE(io.pending_count() == 0);
+                REQUIRE(results.size() == 2);
+                std::sort(results.begin(), results.end(), [](const auto& left, const auto& right) {
+                    return left.value() < right.value();
+                });
+                REQUIRE(results[0].value() == second.size());
+                REQUIRE(results[1].value() == first.size());
+            }
+            REQUIRE(std::filesystem::file_size(path) == first.size() + second.size());
+
+            const Descriptor file{path, O_RDONLY | O_CLOEXEC};
+            std::string buffer(first.size() + second.size() + 100, '\0');
+            std::size_t bytes_read = 0;
+            io.read(file.get(), buffer, 0, [&](ajcf::AsyncIoResult result) { bytes_read = result.value(); });
+            io.wait_all();
+            REQUIRE(bytes_read == first.size() + second.size()); // fewer bytes at the end of the file
+            REQUIRE(buffer.substr(0, bytes_read) == first + second);
+
+            // at the end of the file
+            io.read(file.get(), buffer, 1'000'000, [&](ajcf::AsyncIoResult result) { bytes_read = result.value(); });
+            io.wait_all();
+            REQUIRE(bytes_read == 0);
+        }
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("asynchronous file I/O: registered buffers, queue depth and callbacks", "[input][async_file_io]")
+    {
+        constexpr std::size_t block_size = 4096;
+        constexpr std::size_t blocks_count = 50;
+        const auto path = std::filesystem::temp_directory_path() / "ajcf_async_file_io_blocks.bin";
+        {
+            std::string content;
+            for (std::size_t block = 0; block != blocks_count; ++block)
+                content.append(block_size, static_cast<char>('A' + block % 26));
+            const Descriptor file{path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC};
+            REQUIRE(::write(file.get(), content.data(), content.size()) == static_cast<ssize_t>(content.size()));
+        }
+
+        for (auto options : all_backends_options())
+        {
+            options.queue_depth = 4;
+            ajcf::AsyncFileIo io{options};
+            INFO(ajcf::to_string(io.backend()));
+
+            std::vector<std::vector<char>> buffers(options.queue_depth, std::vector<char>(block_size));
+            std::vector<gsl::span<char>> spans(buffers.begin(), buffers.end());
+            io.register_buffers(spans);
+            REQUIRE_THROWS_AS(io.read_fixed(0, buffers.size(), block_size, 0, [](ajcf::AsyncIoResult) {}),
+                              std::out_of_range);
+            REQUIRE_THROWS_AS(io.read_fixed(0, 0, block_size + 1, 0, [](ajcf::AsyncIoResult) {}), std::out_of_range);
+
+            // each callback reads the next block in its buffer: at most queue_depth operations in flight
+            const Descriptor file{path, O_RDONLY | O_CLOEXEC};
+            std::size_t next_block = 0;
+            std::string first_bytes(blocks_count, ' ');
+            std::function<void(std::size_t)> read_next_block = [&](std::size_t buffer_index) {
+                if (next_block == blocks_count)
+                    return;
+                const auto block = next_block++;
+                io.read_fixed(file.get(), buffer_index, block_size, block * block_size,
+                              [&, block, buffer_index](ajcf::AsyncIoResult result) {
+                                  REQUIRE(result.value() == block_size);
+                                  first_bytes[block] = buffers[buffer_index].front();
+                                  REQUIRE(buffers[buffer_index].back() == first_bytes[block]);
+                                  read_next_block(buffer_index);
+                              });
+            };
+            for (std::size_t buffer_index = 0; buffer_index != buffers.size(); ++buffer_index)
+                read_next_block(buffer_index);
+            REQUIRE(io.submit() == options.queue_depth);
+            io.wait_all();
+            for (std::size_t block = 0; block != blocks_count; ++block)
+                REQUIRE(first_bytes[block] == static_cast<char>('A' + block % 26));
+
+            // more operations than the queue depth: they wait in the queue
+            int completed_count = 0;
+            for (std::size_t block = 0; block != blocks_count; ++block)
+                io.read(file.get(), buffers[block % buffers.size()], block * block_size,
+                        [&](ajcf::AsyncIoResult result) { completed_count += result.value() == block_size; });
+            REQUIRE(io.submit() == options.queue_depth);
+            REQUIRE(io.pending_count() == blocks_count);
+            io.wait_all();
+            REQUIRE(completed_count == static_cast<int>(blocks_count));
+        }
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("asynchronous file I/O: errors", "[input][async_file_io]")
+    {
+        for (const auto& options : all_backends_options())
+        {
+            ajcf::AsyncFileIo io{options};
+            INFO(ajcf::to_string(io.backend()));
+            std::vector<char> buffer(16);
+            ajcf::AsyncIoResult read_result;
+            io.read(-1, buffer, 0, [&](ajcf::AsyncIoResult result) { read_result = result; });
+            io.wait_all();
+            REQUIRE(!read_result);
+            REQUIRE(read_result.error() == std::errc::bad_file_descriptor);
+
+            const Descriptor file{std::filesystem::temp_directory_path(), O_RDONLY | O_DIRECTORY | O_CLOEXEC};
+            ajcf::AsyncIoResult write_result;
+            io.write(file.get(), buffer, 0, [&](ajcf::AsyncIoResult result) { write_result = result; });
+            io.wait_all();
+            REQUIRE(!write_result);
+        }
+        ajcf::AsyncFileIoOptions options;
+        options.queue_depth = 0;
+        REQUIRE_THROWS_AS(ajcf::AsyncFileIo{options}, std::invalid_argument);
+    }
+
+    namespace benchmarks {
+
+        TEST_CASE("1000 files of 256 KB read: pread vs ajcf::AsyncFileIo", "[input][async_file_io][benchmark][!hide]")
+        {
+            constexpr std::size_t files_count = 1000;
+            constexpr std::size_t file_size = 256 * 1024;
+            constexpr unsigned queue_depth = 32;
+            const auto directory = std::filesystem::temp_directory_path() / "ajcf_async_file_io_files";
+            std::filesystem::create_directories(directory);
+            std::vector<std::filesystem::path> paths;
+            {
+                const std::string content(file_size, 'x');
+                for (std::size_t index = 0; index != files_count; ++index)
+                {
+                    paths.push_back(directory / fmt::format("{}.bin", index));
+                    const Descriptor file{paths.back(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC};
+                    REQUIRE(::write(file.get(), content.data(), content.size()) == static_cast<ssize_t>(file_size));
+                }
+            }
+            std::vector<std::vector<char>> buffers(queue_depth, std::vector<char>(file_size));
+
+            // the cold runs drop the files from the page cache before reading them (like after a reboot)
+            const auto drop_from_cache = [&] {
+                for (const auto& path : paths)
+                {
+                    const Descriptor file{path, O_RDONLY | O_CLOEXEC};
+                    ::fdatasync(file.get());
+                    ::posix_fadvise(file.get(), 0, 0, POSIX_FADV_DONTNEED);
+                }
+            };
+
+            const auto print_megabytes_per_second = [&](const char* name, bool cold, auto&& process) {
+                std::size_t bytes_count = 0;
+                std::chrono::duration<double> best_elapsed{1e9};
+                for (int run = 0; run != 3; ++run)
+                {
+                    if (cold)
+                        drop_from_cache();
+                    const auto start = std::chrono::steady_clock::now();
+                    bytes_count = process();
+                    best_elapsed =
+                        std::min<std::chrono::duration<double>>(best_elapsed, std::chrono::steady_clock::now() - start);
+                }
+                REQUIRE(bytes_count == files_count * file_size);
+                fmt::print("{:<42} {:>8.0f} MB/s\n", name, bytes_count / best_elapsed.count() / 1e6);
+            };
+
+            const auto read_synchronously = [&] {
+                std::size_t bytes_count = 0;
+                for (const auto& path : paths)
+                {
+                    const Descriptor file{path, O_RDONLY | O_CLOEXEC};
+                    bytes_count += static_cast<std::size_t>(::pread(file.get(), buffers[0].data(), file_size, 0));
+                }
+                return bytes_count;
+            };
+
+            // queue_depth files in flight, each completion closes its file and reads the next one in its buffer
+            const auto read_asynchronously = [&](const ajcf::AsyncFileIoOptions& options, bool fixed) {
+                ajcf::AsyncFileIo io{options};
+                if (fixed)
+                {
+                    std::vector<gsl::span<char>> spans(buffers.begin(), buffers.end());
+                    io.register_buffers(spans);
+                }
+                std::size_t bytes_count = 0;
+                std::size_t next_file = 0;
+                std::vector<int> descriptors(queue_depth, -1);
+                std::function<void(std::size_t)> read_next_file = [&](std::size_t buffer_index) {
+                    if (descriptors[buffer_index] != -1)
+                        ::close(descriptors[buffer_index]);
+                    descriptors[buffer_index] = -1;
+                    if (next_file == files_count)
+                        return;
+                    const auto descriptor = ::open(paths[next_file++].c_str(), O_RDONLY | O_CLOEXEC);
+                    descriptors[buffer_index] = descriptor;
+                    const auto on_completion = [&, buffer_index](ajcf::AsyncIoResult result) {
+                        bytes_count += result.value();
+                        read_next_file(buffer_index);
+                    };
+                    if (fixed)
+                        io.read_fixed(descriptor, buffer_index, file_size, 0, on_completion);
+                    else
+                        io.read(descriptor, buffers[buffer_index], 0, on_completion);
+                };
+                for (std::size_t buffer_index = 0; buffer_index != queue_depth; ++buffer_index)
+                    read_next_file(buffer_index);
+                io.wait_all();
+                return bytes_count;
+            };
+
+            ajcf::AsyncFileIoOptions io_uring_options;
+            io_uring_options.queue_depth = queue_depth;
+            ajcf::AsyncFileIoOptions thread_pool_options = io_uring_options;
+            thread_pool_options.use_io_uring = false;
+            const bool has_io_uring = ajcf::AsyncFileIo{io_uring_options}.backend() == ajcf::AsyncIoBackend::io_uring;
+
+            fmt::print("{} files of {} KB read, {} in flight{}:\n", files_count, file_size / 1024, queue_depth,
+                       has_io_uring ? "" : " (io_uring not available: thread pool)");
+            for (const bool cold : {false, true})
+            {
+                fmt::print("{}\n", cold ? "  not in the page cache" : "  in the page cache");
+                print_megabytes_per_second("    open + pread, one file at a time", cold, read_synchronously);
+                print_megabytes_per_second("    ajcf::AsyncFileIo, thread pool", cold,
+                                           [&] { return read_asynchronously(thread_pool_options, false); });
+                print_megabytes_per_second("    ajcf::AsyncFileIo, io_uring", cold,
+                                           [&] { return read_asynchronously(io_uring_options, false); });
+                print_megabytes_per_second("    ajcf::AsyncFileIo, io_uring, read_fixed", cold,
+                                           [&] { return read_asynchronously(io_uring_options, true); });
+            }
+
+            std::filesystem::remove_all(directory);
+        }
+
+    } // namespace benchmarks
+
+} // namespace
+
+#endif
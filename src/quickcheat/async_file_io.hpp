@@ -0,0 +1,163 @@
+// https://man7.org/linux/man-pages/man7/io_uring.7.html
+// https://kernel.dk/io_uring.pdf
+// https://man7.org/linux/man-pages/man2/pread.2.html
+
+#pragma once
+
+#include "inline_function.hpp"
+#include <gsl/span>
+#include <tl/expected.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define AJCF_ASYNC_FILE_IO_AVAILABLE 1
+#endif
+
+#if defined(AJCF_ASYNC_FILE_IO_AVAILABLE)
+
+namespace ajcf {
+
+    // Number of bytes read or written (fewer than requested at the end of a file, like pread), or the error
+    using AsyncIoResult = tl::expected<std::size_t, std::error_code>;
+
+    // Called on the thread which waits for the completions, no dynamic allocation for each operation
+    using AsyncIoCallback = InlineFunction<void(AsyncIoResult), 6 * sizeof(void*)>;
+
+    enum class AsyncIoBackend
+    {
+        io_uring,    // Linux 5.6 or later
+        thread_pool, // pread and pwrite on threads
+    };
+
+    const char* to_string(AsyncIoBackend backend) noexcept;
+
+    struct AsyncFileIoOptions
+    {
+        unsigned queue_depth{64};  // maximum number of operations in flight, the next ones wait in a queue
+        unsigned threads_count{0}; // threads of the thread pool, 0 for max(4, std::thread::hardware_concurrency())
+        bool use_io_uring{true};   // false for the thread pool, even if io_uring is available
+    };
+
+    namespace async_file_io_details {
+
+        struct Operation
+        {
+            bool is_write;
+            int descriptor;
+            char* data;
+            std::size_t size;
+            std::uint64_t offset;
+            int buffer_index; // of a registered buffer, else -1
+            AsyncIoCallback callback;
+        };
+
+        struct Completion
+        {
+            AsyncIoCallback callback;
+            AsyncIoResult result;
+        };
+
+        // io_uring, or the thread pool
+        class Backend
+        {
+        public:
+            virtual ~Backend() = default;
+
+            virtual AsyncIoBackend kind() const noexcept = 0;
+
+            virtual void register_buffers(gsl::span<const gsl::span<char>> buffers) = 0;
+
+            // Prepare an operation, started by the next submit
+            virtual void prepare(Operation&& operation) = 0;
+
+            // Start the prepared operations together
+            virtual void submit() = 0;
+
+            // Append the completed operations to completions, waiting for at least one if wait is true
+            virtual void reap(std::vector<Completion>& completions, bool wait) = 0;
+        };
+
+    } // namespace async_file_io_details
+
+    // Asynchronous reads and writes of files (POSIX file descriptors), which do not block the calling thread:
+    // - on Linux, with io_uring: the operations are written in a ring shared with the kernel, then submitted
+    //   together by one system call, and the registered buffers are pinned once for all the operations
+    // - where io_uring is not available (kernels before 5.6, seccomp filters of containers, other systems),
+    //   pread and pwrite run on a pool of threads
+    // read and write queue the operations, submit starts them, wait_some and wait_all call the callbacks of the
+    // completed operations on the calling thread: a callback can queue other operations (but not wait)
+    // The buffers and the file descriptors must stay valid until the callbacks are called
+    //   ajcf::AsyncFileIo io;
+    //   io.read(descriptor, buffer, 0, [&](ajcf::AsyncIoResult result) { ... });
+    //   io.wait_all();
+    class AsyncFileIo
+    {
+    public:
+        explicit AsyncFileIo(const AsyncFileIoOptions& options = {});
+
+        // Wait for the operations in flight, without calling their callbacks (the queued ones are not started)
+        ~AsyncFileIo();
+
+        AsyncFileIo(const AsyncFileIo&) = delete;
+        AsyncFileIo& operator=(const AsyncFileIo&) = delete;
+
+        AsyncIoBackend backend() const noexcept
+        {
+            return m_backend->kind();
+        }
+
+        // Buffers for read_fixed and write_fixed, replacing the previous ones, when no operation is in flight
+        // Throw std::logic_error if operations are in flight, std::system_error if the kernel refuses to pin them
+        void register_buffers(gsl::span<const gsl::span<char>> buffers);
+
+        void read(int descriptor, gsl::span<char> buffer, std::uint64_t offset, AsyncIoCallback callback);
+
+        void write(int descriptor, gsl::span<const char> data, std::uint64_t offset, AsyncIoCallback callback);
+
+        // Read in the first size bytes of a registered buffer
+        // Throw std::out_of_range if there is no such buffer, or if it is smaller
+        void read_fixed(int descriptor, std::size_t buffer_index, std::size_t size, std::uint64_t offset,
+                        AsyncIoCallback callback);
+
+        void write_fixed(int descriptor, std::size_t buffer_index, std::size_t size, std::uint64_t offset,
+                         AsyncIoCallback callback);
+
+        // Start the queued operations, as many as the queue depth allows, and return their number
+        // Throw std::system_error if the operations cannot be submitted
+        std::size_t submit();
+
+        // Submit, then wait for at least one completion if operations are in flight, call the callbacks of the
+        // completed operations and return their number
+        std::size_t wait_some();
+
+        // Wait until no operation is queued nor in flight, including the ones queued by the callbacks
+        void wait_all();
+
+        // Number of operations queued or in flight
+        std::size_t pending_count() const noexcept
+        {
+            return m_queued.size() + m_in_flight_count;
+        }
+
+    private:
+        void queue(bool is_write, int descriptor, char* data, std::size_t size, std::uint64_t offset,
+                   int buffer_index, AsyncIoCallback&& callback);
+
+        char* registered_buffer(std::size_t buffer_index, std::size_t size) const;
+
+        std::unique_ptr<async_file_io_details::Backend> m_backend;
+        std::size_t m_queue_depth;
+        std::deque<async_file_io_details::Operation> m_queued;
+        std::size_t m_in_flight_count{0};
+        std::vector<gsl::span<char>> m_registered_buffers;
+        std::vector<async_file_io_details::Completion> m_completions;
+    };
+
+} // namespace ajcf
+
+#endif
@@ -0,0 +1,365 @@
+// https://man7.org/linux/man-pages/man2/read.2.html
+// https://man7.org/linux/man-pages/man2/write.2.html
+// https://man7.org/linux/man-pages/man2/posix_fadvise.2.html
+
+#include "buffered_io.hpp"
+#include "allocation_counter.hpp"
+#include "simd_string.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(AJCF_BUFFERED_IO_USE_POSIX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ajcf {
+
+    namespace buffered_io_details {
+
+        AlignedBuffer allocate_buffer(std::size_t size)
+        {
+            return AlignedBuffer{static_cast<char*>(::operator new[](size, std::align_val_t{buffer_alignment}))};
+        }
+
+#if defined(AJCF_BUFFERED_IO_USE_POSIX)
+        File::File(const std::filesystem::path& path, bool for_writing)
+            : m_descriptor(for_writing ? ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666)
+                                       : ::open(path.c_str(), O_RDONLY | O_CLOEXEC))
+        {
+            if (m_descriptor == -1)
+                throw std::system_error(errno, std::generic_category(), "cannot open the file " + path.string());
+#if defined(__linux__)
+            // the kernel can read ahead more
+            if (!for_writing)
+                ::posix_fadvise(m_descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        }
+
+        File::~File()
+        {
+            ::close(m_descriptor);
+        }
+
+        std::size_t File::read_some(char* buffer, std::size_t size)
+        {
+            for (;;)
+            {
+                const auto read_bytes = ::read(m_descriptor, buffer, size);
+                if (read_bytes >= 0)
+                    return static_cast<std::size_t>(read_bytes);
+                if (errno != EINTR)
+                    throw std::system_error(errno, std::generic_category(), "cannot read the file");
+            }
+        }
+
+        void File::write_all(const char* data, std::size_t size)
+        {
+            while (size != 0)
+            {
+                const auto written_bytes = ::write(m_descriptor, data, size);
+                if (written_bytes == -1)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::system_error(errno, std::generic_category(), "cannot write the file");
+                }
+                data += written_bytes;
+                size -= static_cast<std::size_t>(written_bytes);
+            }
+        }
+#else
+        File::File(const std::filesystem::path& path, bool for_writing)
+            : m_file(std::fopen(path.string().c_str(), for_writing ? "wb" : "rb"))
+        {
+            if (!m_file)
+                throw std::system_error(errno, std::generic_category(), "cannot open the file " + path.string());
+            // the buffers are the ones of LineReader and BufferedWriter
+            std::setvbuf(m_file, nullptr, _IONBF, 0);
+        }
+
+        File::~File()
+        {
+            std::fclose(m_file);
+        }
+
+        std::size_t File::read_some(char* buffer, std::size_t size)
+        {
+            const auto read_bytes = std::fread(buffer, 1, size, m_file);
+            if (read_bytes == 0 && std::ferror(m_file))
+                throw std::system_error(std::make_error_code(std::errc::io_error), "cannot read the file");
+            return read_bytes;
+        }
+
+        void File::write_all(const char* data, std::size_t size)
+        {
+            if (std::fwrite(data, 1, size, m_file) != size)
+                throw std::system_error(std::make_error_code(std::errc::io_error), "cannot write the file");
+        }
+#endif
+
+    } // namespace buffered_io_details
+
+    LineReader::LineReader(const std::filesystem::path& path, std::size_t buffer_size)
+        : m_file(path, false), m_buffer(buffered_io_details::allocate_buffer(std::max<std::size_t>(buffer_size, 1))),
+          m_capacity(std::max<std::size_t>(buffer_size, 1)), m_find_char(simd::best_string_kernels().find_char),
+          m_begin(m_buffer.get()), m_search(m_begin), m_end(m_begin)
+    {
+    }
+
+    bool LineReader::read_line(std::string_view& line)
+    {
+        for (;;)
+        {
+            const char* const newline = m_find_char(m_search, m_end, '\n');
+            if (newline != m_end)
+            {
+                line = std::string_view(m_begin, static_cast<std::size_t>(newline - m_begin));
+                m_begin = m_search = m_begin + (newline - m_begin) + 1;
+                return true;
+            }
+            m_search = m_end;
+            if (!refill())
+            {
+                if (m_begin == m_end)
+                    return false;
+                // the last line, without '\n'
+                line = std::string_view(m_begin, static_cast<std::size_t>(m_end - m_begin));
+                m_begin = m_search = m_end;
+                return true;
+            }
+        }
+    }
+
+    bool LineReader::refill()
+    {
+        if (m_end_of_file)
+            return false;
+
+        const auto rest_size = static_cast<std::size_t>(m_end - m_begin);
+        const auto searched_size = static_cast<std::size_t>(m_search - m_begin);
+        if (m_begin != m_buffer.get())
+            std::memmove(m_buffer.get(), m_begin, rest_size);
+        else if (rest_size == m_capacity)
+        {
+            // a line longer than the buffer
+            auto bigger_buffer = buffered_io_details::allocate_buffer(2 * m_capacity);
+            std::memcpy(bigger_buffer.get(), m_buffer.get(), rest_size);
+            m_buffer = std::move(bigger_buffer);
+            m_capacity *= 2;
+        }
+        m_begin = m_buffer.get();
+        m_search = m_begin + searched_size;
+        m_end = m_begin + rest_size;
+
+        const auto read_bytes = m_file.read_some(m_end, m_capacity - rest_size);
+        if (read_bytes == 0)
+        {
+            m_end_of_file = true;
+            return false;
+        }
+        m_end += read_bytes;
+        return true;
+    }
+
+    BufferedWriter::BufferedWriter(const std::filesystem::path& path, std::size_t buffer_size)
+        : m_file(path, true),
+          m_buffer(buffered_io_details::allocate_buffer(std::max<std::size_t>(buffer_size, min_buffer_size))),
+          m_end(m_buffer.get()), m_buffer_end(m_buffer.get() + std::max<std::size_t>(buffer_size, min_buffer_size))
+    {
+    }
+
+    BufferedWriter::~BufferedWriter()
+    {
+        try
+        {
+            flush_buffer();
+        }
+        catch (const std::system_error&)
+        {
+            // like std::ofstream, the errors are known only by flushing before
+        }
+    }
+
+    BufferedWriter& BufferedWriter::write_big(std::string_view text)
+    {
+        flush_buffer();
+        if (text.size() >= static_cast<std::size_t>(m_buffer_end - m_buffer.get()))
+            m_file.write_all(text.data(), text.size());
+        else
+        {
+            std::memcpy(m_end, text.data(), text.size());
+            m_end += text.size();
+        }
+        return *this;
+    }
+
+    void BufferedWriter::flush_buffer()
+    {
+        m_file.write_all(m_buffer.get(), static_cast<std::size_t>(m_end - m_buffer.get()));
+        m_end = m_buffer.get();
+    }
+
+} // namespace ajcf
+
+namespace {
+
+    std::string read_file(const std::filesystem::path& path)
+    {
+        std::ifstream input{path, std::ios::binary};
+        std::ostringstream content;
+        content << input.rdbuf();
+        return content.str();
+    }
+
+    std::vector<std::string> read_lines(const std::filesystem::path& path, std::size_t buffer_size)
+    {
+        ajcf::LineReader reader{path, buffer_size};
+        std::vector<std::string> lines;
+        std::string_view line;
+        while (reader.read_line(line))
+            lines.emplace_back(line);
+        return lines;
+    }
+
+    TEST_CASE("buffered writer", "[output][buffered_io]")
+    {
+        const auto path = std::filesystem::temp_directory_path() / "ajcf_buffered_writer.txt";
+        {
+            // a buffer smaller than some texts
+            ajcf::BufferedWriter writer{path, 16};
+            writer << "One line\n";
+            writer << 1.0 << " other " << std::string{"line"} << '\n';
+            writer << -1234567 << ' ' << 0.1 << ' ' << true << ' ' << 18446744073709551615u << '\n';
+            writer << std::string(100, 'x') << '\n';
+            // characters, like std::ofstream
+            writer << std::uint8_t{65} << static_cast<signed char>('B') << std::int8_t{67} << std::uint16_t{68} << '\n';
+        }
+
+        REQUIRE(read_file(path) == "One line\n1 other line\n-1234567 0.1 1 18446744073709551615\n" +
+                                       std::string(100, 'x') + "\nABC68\n");
+
+        {
+            ajcf::BufferedWriter writer{path};
+            writer << "written by flush";
+            writer.flush();
+
+            REQUIRE(read_file(path) == "written by flush");
+        }
+
+        std::filesystem::remove(path);
+
+        REQUIRE_THROWS_AS(ajcf::BufferedWriter(path / "not_a_directory.txt"), std::system_error);
+    }
+
+    TEST_CASE("line reader", "[input][buffered_io]")
+    {
+        const auto path = std::filesystem::temp_directory_path() / "ajcf_line_reader.txt";
+        const std::vector<std::string> lines{"first line", "", "a longer line than the buffer of 8 bytes", "last"};
+        std::ofstream{path, std::ios::binary} << "first line\n\na longer line than the buffer of 8 bytes\nlast";
+
+        // the lines cross the end of the buffer, the buffer grows for the long line
+        REQUIRE(read_lines(path, 8) == lines);
+        REQUIRE(read_lines(path, 1) == lines);
+        REQUIRE(read_lines(path, ajcf::LineReader::default_buffer_size) == lines);
+
+        // no allocation per line
+        ajcf::LineReader reader{path};
+        ajcf::AllocationCounter counter;
+        std::size_t lines_count = 0;
+        std::string_view line;
+        while (reader.read_line(line))
+            ++lines_count;
+
+        REQUIRE(counter.allocations() == 0);
+        REQUIRE(lines_count == 4);
+
+        std::ofstream{path, std::ios::binary} << "";
+
+        REQUIRE(read_lines(path, 8).empty());
+
+        std::ofstream{path, std::ios::binary} << "\n";
+
+        REQUIRE(read_lines(path, 8) == std::vector<std::string>{""});
+
+        std::filesystem::remove(path);
+
+        REQUIRE_THROWS_AS(ajcf::LineReader{path}, std::system_error);
+    }
+
+    namespace benchmarks {
+
+        TEST_CASE("10M lines: std::ofstream and std::getline vs ajcf::BufferedWriter and ajcf::LineReader",
+                  "[input][output][buffered_io][benchmark][!hide]")
+        {
+            constexpr int lines_count = 10'000'000;
+            const auto path = std::filesystem::temp_directory_path() / "ajcf_buffered_io_lines.txt";
+
+            const auto print_lines_per_second = [&](const char* name, auto&& process) {
+                std::size_t checksum = 0;
+                std::chrono::duration<double> best_elapsed{1e9};
+                for (int run = 0; run != 3; ++run)
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    checksum = process();
+                    best_elapsed =
+                        std::min<std::chrono::duration<double>>(best_elapsed, std::chrono::steady_clock::now() - start);
+                }
+                fmt::print("{:<34} {:>8.1f} M lines/s {:>8.0f} MB/s (checksum {})\n", name,
+                           lines_count / best_elapsed.count() / 1e6,
+                           std::filesystem::file_size(path) / best_elapsed.count() / 1e6, checksum);
+            };
+
+            // lines like "1234567 name 0.25 -42\n"
+            fmt::print("{}M lines written:\n", lines_count / 1'000'000);
+            // std::ofstream writes the doubles with 6 significant digits, ajcf::BufferedWriter with the shortest text
+            // which gives back the same number
+            print_lines_per_second("  std::ofstream << (not round-trip)", [&] {
+                std::ofstream output{path, std::ios::binary};
+                for (int index = 0; index != lines_count; ++index)
+                    output << index << " name " << index * 0.25 << ' ' << -index % 1000 << '\n';
+                output.flush();
+                return static_cast<std::size_t>(std::filesystem::file_size(path));
+            });
+            print_lines_per_second("  ajcf::BufferedWriter <<", [&] {
+                ajcf::BufferedWriter output{path};
+                for (int index = 0; index != lines_count; ++index)
+                    output << index << " name " << index * 0.25 << ' ' << -index % 1000 << '\n';
+                output.flush();
+                return static_cast<std::size_t>(std::filesystem::file_size(path));
+            });
+
+            // the file written by ajcf::BufferedWriter
+            fmt::print("{}M lines read:\n", lines_count / 1'000'000);
+            print_lines_per_second("  std::ifstream + std::getline", [&] {
+                std::size_t characters_count = 0;
+                std::ifstream input{path, std::ios::binary};
+                std::string line;
+                while (std::getline(input, line))
+                    characters_count += line.size();
+                return characters_count;
+            });
+            print_lines_per_second("  ajcf::LineReader", [&] {
+                std::size_t characters_count = 0;
+                ajcf::LineReader input{path};
+                std::string_view line;
+                while (input.read_line(line))
+                    characters_count += line.size();
+                return characters_count;
+            });
+
+            std::filesystem::remove(path);
+        }
+
+    } // namespace benchmarks
+
+} // namespace
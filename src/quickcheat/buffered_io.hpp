@@ -0,0 +1,227 @@
+// https://man7.org/linux/man-pages/man2/read.2.html
+// https://man7.org/linux/man-pages/man2/write.2.html
+// https://en.cppreference.com/w/cpp/io/basic_filebuf
+
+#pragma once
+
+#include "number_formatting.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define AJCF_BUFFERED_IO_USE_POSIX 1
+#endif
+
+namespace ajcf {
+
+    namespace buffered_io_details {
+
+        // Buffers aligned on a page: the kernel copies whole pages
+        constexpr std::size_t buffer_alignment = 4096;
+
+        struct AlignedDelete
+        {
+            void operator()(char* buffer) const noexcept
+            {
+                ::operator delete[](buffer, std::align_val_t{buffer_alignment});
+            }
+        };
+
+        using AlignedBuffer = std::unique_ptr<char[], AlignedDelete>;
+
+        AlignedBuffer allocate_buffer(std::size_t size);
+
+        // File opened for reading or for writing, without any buffer of the library (read(2) and write(2))
+        class File
+        {
+        public:
+            // Throw std::system_error if the file cannot be opened (or created, for writing)
+            File(const std::filesystem::path& path, bool for_writing);
+            File(const File&) = delete;
+            File& operator=(const File&) = delete;
+            ~File();
+
+            // Read at most size bytes, return 0 at the end of the file
+            // Throw std::system_error on failure
+            std::size_t read_some(char* buffer, std::size_t size);
+
+            // Throw std::system_error on failure
+            void write_all(const char* data, std::size_t size);
+
+        private:
+#if defined(AJCF_BUFFERED_IO_USE_POSIX)
+            int m_descriptor;
+#else
+            std::FILE* m_file;
+#endif
+        };
+
+    } // namespace buffered_io_details
+
+    // Reader of the lines of a file, a replacement of std::getline on a std::ifstream:
+    // - the file is read by big blocks in an aligned buffer, without any other copy
+    // - the '\n' are searched with the vectorized kernels of ajcf::simd
+    // - the lines are views on the buffer, valid until the next call of read_line
+    // - the buffer grows for the lines longer than the buffer
+    //   ajcf::LineReader reader{"data.txt"};
+    //   std::string_view line;
+    //   while (reader.read_line(line))
+    class LineReader
+    {
+    public:
+        static constexpr std::size_t default_buffer_size = 1024 * 1024;
+
+        // Throw std::system_error if the file cannot be opened
+        explicit LineReader(const std::filesystem::path& path, std::size_t buffer_size = default_buffer_size);
+
+        // The next line without its '\n' (the last line can end without '\n'), or false at the end of the file
+        // Throw std::system_error on failure
+        bool read_line(std::string_view& line);
+
+    private:
+        // Move the rest of the buffer to its beginning, grow it if it is full, then read more bytes
+        // Return false at the end of the file
+        bool refill();
+
+        buffered_io_details::File m_file;
+        buffered_io_details::AlignedBuffer m_buffer;
+        std::size_t m_capacity;
+        const char* (*m_find_char)(const char* first, const char* last, char c) noexcept;
+        char* m_begin;  // first byte not read yet
+        char* m_search; // where to search the next '\n' (the bytes before are not '\n')
+        char* m_end;    // end of the bytes read from the file
+        bool m_end_of_file{false};
+    };
+
+    // Writer of a file, a replacement of std::ofstream when it only writes texts and numbers:
+    // - no locale, no virtual call, no sentry object for each operator<<
+    // - the numbers are formatted in the buffer by ajcf::format_number (the floating-point numbers as their
+    //   shortest text which gives back the same number)
+    // - the buffer is written with write(2), the texts bigger than the buffer are written without any copy
+    //   ajcf::BufferedWriter writer{"data.txt"};
+    //   writer << "value " << 12 << ' ' << 0.5 << '\n';
+    //   writer.flush();
+    class BufferedWriter
+    {
+    public:
+        static constexpr std::size_t default_buffer_size = 1024 * 1024;
+
+        // Room for any number
+        static constexpr std::size_t min_buffer_size = 64;
+
+        // Create the file, or truncate it if it exists, the buffer has at least min_buffer_size bytes
+        // Throw std::system_error if the file cannot be created
+        explicit BufferedWriter(const std::filesystem::path& path, std::size_t buffer_size = default_buffer_size);
+
+        // Write the rest of the buffer, ignoring the errors: call flush before to know them
+        ~BufferedWriter();
+
+        BufferedWriter(const BufferedWriter&) = delete;
+        BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+        // The functions which write can throw std::system_error when the buffer is written to the file
+        BufferedWriter& write(std::string_view text)
+        {
+            if (text.size() > static_cast<std::size_t>(m_buffer_end - m_end))
+                return write_big(text);
+            std::memcpy(m_end, text.data(), text.size());
+            m_end += text.size();
+            return *this;
+        }
+
+        BufferedWriter& write(char character)
+        {
+            if (m_end == m_buffer_end)
+                flush_buffer();
+            *m_end++ = character;
+            return *this;
+        }
+
+        // like std::ofstream: the other types of characters (std::int8_t and std::uint8_t too) are characters
+        BufferedWriter& write(signed char character)
+        {
+            return write(static_cast<char>(character));
+        }
+
+        BufferedWriter& write(unsigned char character)
+        {
+            return write(static_cast<char>(character));
+        }
+
+        template <typename Number,
+                  std::enable_if_t<std::is_arithmetic_v<Number> && !std::is_same_v<Number, bool>, int> = 0>
+        BufferedWriter& write(Number value)
+        {
+            if (static_cast<std::size_t>(m_buffer_end - m_end) < max_formatted_size<Number>)
+                flush_buffer();
+            m_end = format_number(m_end, value);
+            return *this;
+        }
+
+        BufferedWriter& operator<<(std::string_view text)
+        {
+            return write(text);
+        }
+
+        BufferedWriter& operator<<(const char* text)
+        {
+            return write(std::string_view(text));
+        }
+
+        BufferedWriter& operator<<(const std::string& text)
+        {
+            return write(std::string_view(text));
+        }
+
+        BufferedWriter& operator<<(char character)
+        {
+            return write(character);
+        }
+
+        BufferedWriter& operator<<(signed char character)
+        {
+            return write(character);
+        }
+
+        BufferedWriter& operator<<(unsigned char character)
+        {
+            return write(character);
+        }
+
+        // like std::ofstream without std::boolalpha
+        BufferedWriter& operator<<(bool value)
+        {
+            return write(value ? '1' : '0');
+        }
+
+        template <typename Number,
+                  std::enable_if_t<std::is_arithmetic_v<Number> && !std::is_same_v<Number, bool>, int> = 0>
+        BufferedWriter& operator<<(Number value)
+        {
+            return write(value);
+        }
+
+        // Write the buffer to the file
+        void flush()
+        {
+            flush_buffer();
+        }
+
+    private:
+        BufferedWriter& write_big(std::string_view text);
+        void flush_buffer();
+
+        buffered_io_details::File m_file;
+        buffered_io_details::AlignedBuffer m_buffer;
+        char* m_end;        // end of the bytes not written to the file yet
+        char* m_buffer_end; // end of the buffer
+    };
+
+} // namespace ajcf
@@ -0,0 +1,176 @@
+// https://en.cppreference.com/w/cpp/language/constexpr
+// https://en.cppreference.com/w/cpp/container/map
+
+#include "character_table.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+
+namespace {
+
+    int add(int x, int y)
+    {
+        return x + y;
+    }
+
+    int sub(int x, int y)
+    {
+        return x - y;
+    }
+
+    int mul(int x, int y)
+    {
+        return x * y;
+    }
+
+    int div(int x, int y)
+    {
+        return x / y;
+    }
+
+    using Operation = int (*)(int, int);
+
+    constexpr auto operations = ajcf::make_character_table<Operation>([](char c) -> Operation {
+        switch (c)
+        {
+        case '+':
+            return &add;
+        case '-':
+            return &sub;
+        case '*':
+            return &mul;
+        case '/':
+            return &div;
+        }
+        return nullptr;
+    });
+
+    // computed by the compiler
+    static_assert(ajcf::is_arithmetic_operator('%'));
+    static_assert(!ajcf::is_arithmetic_operator('a'));
+    static_assert(ajcf::character_classes['7'] == ajcf::character_class::digit);
+    static_assert(operations['*'] == &mul);
+    static_assert(operations['%'] == nullptr);
+
+    TEST_CASE("compile-time character tables", "[function][character_table]")
+    {
+        REQUIRE(operations['+'](23, 48) == 71);
+        REQUIRE(operations['/'](95, 5) == 19);
+        REQUIRE(operations['x'] == nullptr);
+
+        // the characters which are negative as char are in the table too
+        REQUIRE(operations['\xFF'] == nullptr);
+        REQUIRE(ajcf::character_classes['\xE9'] == ajcf::character_class::none);
+
+        std::string classes;
+        for (const auto c : std::string("x1 + (y*2)"))
+        {
+            const auto character_class = ajcf::character_classes[c];
+            classes += character_class == ajcf::character_class::letter                ? 'L'
+                       : character_class == ajcf::character_class::digit               ? 'D'
+                       : character_class == ajcf::character_class::space               ? 'S'
+                       : character_class == ajcf::character_class::arithmetic_operator ? 'O'
+                       : character_class == ajcf::character_class::parenthesis         ? 'P'
+                                                                                       : '?';
+        }
+
+        REQUIRE(classes == "LDSOSPLODP");
+
+        constexpr auto is_vowel = ajcf::make_character_table<bool>([](char c) {
+            return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u' || c == 'y';
+        });
+
+        REQUIRE(is_vowel['e']);
+        REQUIRE(!is_vowel['z']);
+    }
+
+    namespace benchmarks {
+
+        // like example_function_pointer in function_objects.cpp
+        const std::map<char, Operation> possible_operations = {
+            {'+', &add},
+            {'-', &sub},
+            {'*', &mul},
+            {'/', &div},
+        };
+
+        bool is_operator(char op)
+        {
+            return op == '+' || op == '-' || op == '*' || op == '/' || op == '%';
+        }
+
+        TEST_CASE("character tables vs std::map and comparisons", "[function][character_table][benchmark][!hide]")
+        {
+            // characters of arithmetic expressions
+            const std::string alphabet = "0123456789     ()+-*/abcxyz";
+            std::mt19937 random{42};
+            std::uniform_int_distribution<std::size_t> distribution(0, alphabet.size() - 1);
+            std::string text(10'000'000, ' ');
+            for (auto& c : text)
+                c = alphabet[distribution(random)];
+
+            const auto print_characters_per_second = [&](const char* name, auto&& function) {
+                double best_seconds = 1e9;
+                std::size_t result = 0;
+                for (int run = 0; run != 3; ++run)
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    result = function();
+                    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                    best_seconds = std::min(best_seconds, elapsed.count());
+                }
+                fmt::print("{:<40} {:>8.1f} M characters/s (result {})\n", name,
+                           static_cast<double>(text.size()) / best_seconds / 1e6, result);
+            };
+
+            print_characters_per_second("classification - comparisons", [&] {
+                std::size_t count = 0;
+                for (const auto c : text)
+                    count += is_operator(c) ? 1 : 0;
+                return count;
+            });
+            print_characters_per_second("classification - character table", [&] {
+                std::size_t count = 0;
+                for (const auto c : text)
+                    count += ajcf::is_arithmetic_operator(c) ? 1 : 0;
+                return count;
+            });
+            print_characters_per_second("operation lookup - std::map", [&] {
+                std::size_t total = 0;
+                for (const auto c : text)
+                {
+                    const auto iter = possible_operations.find(c);
+                    if (iter != possible_operations.end())
+                        total += static_cast<std::size_t>(iter->second(12, 3));
+                }
+                return total;
+            });
+            print_characters_per_second("operation lookup - character table", [&] {
+                std::size_t total = 0;
+                for (const auto c : text)
+                {
+                    if (const auto operation = operations[c])
+                        total += static_cast<std::size_t>(operation(12, 3));
+                }
+                return total;
+            });
+
+            const auto operator_char = text[text.find('*')];
+
+            BENCHMARK("operation lookup - std::map")
+            {
+                return possible_operations.find(operator_char)->second;
+            };
+
+            BENCHMARK("operation lookup - character table")
+            {
+                return operations[operator_char];
+            };
+        }
+
+    } // namespace benchmarks
+
+} // namespace
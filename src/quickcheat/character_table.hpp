@@ -0,0 +1,88 @@
+// https://en.cppreference.com/w/cpp/language/constexpr
+// https://en.cppreference.com/w/cpp/string/byte/isalpha (the character classes of the C library use a table too)
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace ajcf {
+
+    // Table of 256 values indexed by a character, computed at compile time:
+    // a lookup is a single load, instead of a chain of comparisons or a search in a std::map
+    //   constexpr auto is_vowel = ajcf::make_character_table<bool>([](char c) { return c == 'a' || c == 'e'; });
+    //   constexpr auto operations = ajcf::make_character_table<int (*)(int, int)>([](char c) { ... });
+    //   if (is_vowel[text[i]]) ...
+    template <typename Value>
+    class CharacterTable
+    {
+    public:
+        static constexpr std::size_t size = std::numeric_limits<unsigned char>::max() + 1;
+
+        constexpr explicit CharacterTable(const std::array<Value, size>& values) noexcept : m_values(values)
+        {
+        }
+
+        constexpr const Value& operator[](char c) const noexcept
+        {
+            return m_values[static_cast<unsigned char>(c)];
+        }
+
+        constexpr const Value& operator[](unsigned char c) const noexcept
+        {
+            return m_values[c];
+        }
+
+    private:
+        std::array<Value, size> m_values;
+    };
+
+    // Table of generator(c) for all the characters, generator must be usable in a constant expression
+    template <typename Value, typename Generator>
+    constexpr CharacterTable<Value> make_character_table(Generator generator)
+    {
+        std::array<Value, CharacterTable<Value>::size> values{};
+        for (std::size_t index = 0; index != values.size(); ++index)
+            values[index] = generator(static_cast<char>(static_cast<unsigned char>(index)));
+        return CharacterTable<Value>(values);
+    }
+
+    // Classes of characters of arithmetic expressions, which can be combined
+    namespace character_class {
+
+        using Type = std::uint8_t;
+
+        constexpr Type none = 0;
+        constexpr Type space = 1 << 0;
+        constexpr Type digit = 1 << 1;
+        constexpr Type letter = 1 << 2;
+        constexpr Type arithmetic_operator = 1 << 3; // + - * / %
+        constexpr Type parenthesis = 1 << 4;
+
+        constexpr Type of(char c) noexcept
+        {
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f')
+                return space;
+            if (c >= '0' && c <= '9')
+                return digit;
+            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')
+                return letter;
+            if (c == '+' || c == '-' || c == '*' || c == '/' || c == '%')
+                return arithmetic_operator;
+            if (c == '(' || c == ')')
+                return parenthesis;
+            return none;
+        }
+
+    } // namespace character_class
+
+    constexpr auto character_classes = make_character_table<character_class::Type>(&character_class::of);
+
+    constexpr bool is_arithmetic_operator(char c) noexcept
+    {
+        return (character_classes[c] & character_class::arithmetic_operator) != 0;
+    }
+
+} // namespace ajcf
@@ -2,31 +2,36 @@
 // https://en.cppreference.com/w/cpp/language/class c.f. Peter Sommerlad
 // https://en.cppreference.com/w/cpp/memory/unique_ptr
 
+#include "allocation_counter.hpp"
+#include "closed_polymorphism.hpp"
+#include "mapped_file.hpp"
+#include "noinline.hpp"
+#include "small_value.hpp"
 #include <string_view>
 #include <catch2/catch.hpp>
+#include <fmt/format.h>
 #include <algorithm>
 #include <cstdio>
 #include <iostream>
 #include <memory>
+#include <variant>
 
 namespace {
 
     namespace classes_value {
 
+        // the int is stored inside the object: no allocation for the copies nor for operator+
+        // (with a std::unique_ptr<int>, each copy allocated a new int)
         class Regular
         {
         public:
-            Regular() : m_pi(std::make_unique<int>(0))
-            {
-            }
+            Regular() = default;
 
-            explicit Regular(int i) : m_pi(std::make_unique<int>(i))
+            explicit Regular(int i) : m_i(std::in_place, i)
             {
             }
 
-            Regular(const Regular& autre) : m_pi(std::make_unique<int>(*autre.m_pi))
-            {
-            }
+            Regular(const Regular& autre) = default;
 
             Regular(Regular&& autre) = default;
 
@@ -42,22 +47,22 @@ namespace {
 
             void swap(Regular& autre)
             {
-                m_pi.swap(autre.m_pi);
+                m_i.swap(autre.m_i);
             }
 
             int value() const
             {
-                return *m_pi;
+                return *m_i;
             }
 
             bool operator==(const Regular& autre) const
             {
-                return *m_pi == *autre.m_pi;
+                return *m_i == *autre.m_i;
             }
 
             Regular& operator+=(const Regular& y)
             {
-                *m_pi += *y.m_pi;
+                *m_i += *y.m_i;
                 return *this;
             }
 
@@ -69,12 +74,12 @@ namespace {
 
             friend inline std::ostream& operator<<(std::ostream& os, const Regular& x)
             {
-                os << *x.m_pi;
+                os << *x.m_i;
                 return os;
             }
 
         private:
-            std::unique_ptr<int> m_pi;
+            ajcf::SmallValue<int> m_i;
         };
 
         TEST_CASE("regular", "[classes]")
@@ -90,8 +95,98 @@ namespace {
             const auto reg3 = reg1 + reg2;
 
             REQUIRE(reg3.value() == 3 + 5);
+
+            ajcf::AllocationCounter counter;
+            auto reg4 = reg1 + reg2 + reg3;
+            reg4 = reg1;
+            reg4.swap(reg2);
+
+            REQUIRE(reg4 == Regular{5});
+            REQUIRE(reg2.value() == 3);
+            REQUIRE(counter.allocations() == 0);
         }
 
+        namespace benchmarks {
+
+            // Regular before ajcf::SmallValue
+            class RegularWithUniquePtr
+            {
+            public:
+                explicit RegularWithUniquePtr(int i) : m_pi(std::make_unique<int>(i))
+                {
+                }
+
+                RegularWithUniquePtr(const RegularWithUniquePtr& autre) : m_pi(std::make_unique<int>(*autre.m_pi))
+                {
+                }
+
+                RegularWithUniquePtr(RegularWithUniquePtr&& autre) = default;
+
+                int value() const
+                {
+                    return *m_pi;
+                }
+
+                RegularWithUniquePtr& operator+=(const RegularWithUniquePtr& y)
+                {
+                    *m_pi += *y.m_pi;
+                    return *this;
+                }
+
+                friend inline RegularWithUniquePtr operator+(RegularWithUniquePtr x, const RegularWithUniquePtr& y)
+                {
+                    x += y;
+                    return x;
+                }
+
+            private:
+                std::unique_ptr<int> m_pi;
+            };
+
+            // operator+ not inlined, else the compiler can remove the allocation and the deallocation of the copies
+            template <typename Value>
+            AJCF_NOINLINE Value add(const Value& x, const Value& y)
+            {
+                return x + y;
+            }
+
+            template <typename Value>
+            int sum_chain(const Value& reg1, const Value& reg2)
+            {
+                // each operator+ takes its left operand by copy
+                const auto sum = add(add(add(add(add(add(add(reg1, reg2), reg1), reg2), reg1), reg2), reg1), reg2);
+                return sum.value();
+            }
+
+            TEST_CASE("reg1 + reg2 chains: std::unique_ptr<int> vs ajcf::SmallValue<int>",
+                      "[classes][small_value][benchmark][!hide]")
+            {
+                const RegularWithUniquePtr unique_ptr_reg1{3};
+                const RegularWithUniquePtr unique_ptr_reg2{5};
+                const Regular reg1{3};
+                const Regular reg2{5};
+
+                ajcf::AllocationCounter counter;
+                sum_chain(unique_ptr_reg1, unique_ptr_reg2);
+                const auto unique_ptr_allocations = counter.allocations();
+                sum_chain(reg1, reg2);
+                fmt::print("allocations for reg1 + reg2 + ... (8 terms): std::unique_ptr<int> {}, "
+                           "ajcf::SmallValue {}\n",
+                           unique_ptr_allocations, counter.allocations() - unique_ptr_allocations);
+
+                BENCHMARK("reg1 + reg2 + ... (8 terms) - std::unique_ptr<int>")
+                {
+                    return sum_chain(unique_ptr_reg1, unique_ptr_reg2);
+                };
+
+                BENCHMARK("reg1 + reg2 + ... (8 terms) - ajcf::SmallValue<int>")
+                {
+                    return sum_chain(reg1, reg2);
+                };
+            }
+
+        } // namespace benchmarks
+
     } // namespace classes_value
 
     namespace classes_polymorphic {
@@ -169,6 +264,55 @@ namespace {
             REQUIRE(who_is_it_by_copy(derived_with_virtual) == "BaseWithVirtual");
         }
 
+        // the same without virtual function, when all the derived types are known at compile time
+        template <typename Derived>
+        class BaseWithStaticInterface : public ajcf::StaticInterface<Derived>
+        {
+        public:
+            std::string who_am_i()
+            {
+                return this->derived().name();
+            }
+        };
+
+        class DerivedWithStaticInterface : public BaseWithStaticInterface<DerivedWithStaticInterface>
+        {
+        public:
+            std::string name()
+            {
+                return "DerivedWithStaticInterface";
+            }
+        };
+
+        class OtherDerivedWithStaticInterface : public BaseWithStaticInterface<OtherDerivedWithStaticInterface>
+        {
+        public:
+            std::string name()
+            {
+                return "OtherDerivedWithStaticInterface";
+            }
+        };
+
+        template <typename Derived>
+        std::string who_is_it_by_ref(BaseWithStaticInterface<Derived>& base)
+        {
+            return base.who_am_i();
+        }
+
+        TEST_CASE("static interface and closed set of types", "[classes][closed_polymorphism]")
+        {
+            DerivedWithStaticInterface derived;
+
+            REQUIRE(who_is_it_by_ref(derived) == "DerivedWithStaticInterface");
+
+            // one of the closed set of types, chosen at runtime: no virtual table, no allocation
+            std::variant<DerivedWithStaticInterface, OtherDerivedWithStaticInterface> any_derived{
+                OtherDerivedWithStaticInterface{}};
+
+            REQUIRE(ajcf::visit([](auto& base) { return who_is_it_by_ref(base); }, any_derived) ==
+                    "OtherDerivedWithStaticInterface");
+        }
+
     } // namespace classes_polymorphic
 
     namespace classes_resource_manager {
@@ -255,6 +399,27 @@ namespace {
             INFO("File's destructor closes the underlying file automatically when exiting the function");
         }
 
+        TEST_CASE("RAII: memory-mapped file", "[classes][mapped_file]")
+        {
+            INFO("Trying mapping file");
+
+            const auto file = ajcf::MappedFile::open("my_file.txt");
+            if (file)
+            {
+                INFO("Reading the first 49 bytes of the file, in place: no copy into a buffer");
+
+                const auto first_bytes = file->bytes().first(std::min<std::size_t>(file->size(), 49));
+
+                REQUIRE(first_bytes.size() <= 49);
+            }
+            else
+            {
+                REQUIRE(!file);
+            }
+
+            INFO("File's destructor unmaps the underlying file automatically when exiting the function");
+        }
+
     } // namespace classes_resource_manager
 
 } // namespace
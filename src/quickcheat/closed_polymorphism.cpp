@@ -0,0 +1,375 @@
+// https://en.cppreference.com/w/cpp/utility/variant/visit
+// https://en.cppreference.com/w/cpp/language/crtp
+
+#include "closed_polymorphism.hpp"
+#include "allocation_counter.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+
+    // the static interface of the shapes
+    template <typename Derived>
+    class Shape : public ajcf::StaticInterface<Derived>
+    {
+    public:
+        double area() const
+        {
+            return this->derived().compute_area();
+        }
+
+        std::string name() const
+        {
+            return Derived::shape_name;
+        }
+    };
+
+    class Circle : public Shape<Circle>
+    {
+    public:
+        static constexpr const char* shape_name = "circle";
+
+        explicit Circle(double radius) : m_radius(radius)
+        {
+        }
+
+        double compute_area() const
+        {
+            return 3.0 * m_radius * m_radius;
+        }
+
+    private:
+        double m_radius;
+    };
+
+    class Rectangle : public Shape<Rectangle>
+    {
+    public:
+        static constexpr const char* shape_name = "rectangle";
+
+        Rectangle(double width, double height) : m_width(width), m_height(height)
+        {
+        }
+
+        double compute_area() const
+        {
+            return m_width * m_height;
+        }
+
+    private:
+        double m_width;
+        double m_height;
+    };
+
+    TEST_CASE("closed polymorphism: visit", "[classes][closed_polymorphism]")
+    {
+        std::variant<Circle, Rectangle> shape{Rectangle{2.0, 3.0}};
+        const auto area = [](const auto& any_shape) { return any_shape.area(); };
+
+        REQUIRE(ajcf::visit(area, shape) == 6.0);
+
+        shape = Circle{1.0};
+
+        REQUIRE(ajcf::visit(area, shape) == 3.0);
+        REQUIRE(ajcf::visit([](auto& any_shape) { return any_shape.name(); }, shape) == "circle");
+
+        // the visitor can modify the alternative and return nothing
+        std::variant<int, std::string> value{std::string{"abc"}};
+        ajcf::visit([](auto& alternative) { alternative += alternative; }, value);
+
+        REQUIRE(std::get<std::string>(value) == "abcabc");
+
+        // many alternatives: through the table of functions
+        using Many = std::variant<char, short, int, long long, float, double, long double, std::string, Circle>;
+        static_assert(std::variant_size_v<Many> > ajcf::closed_polymorphism_details::max_inlined_alternatives);
+        const auto size_of = [](const auto& alternative) { return sizeof(alternative); };
+
+        const Many number{short{1}};
+        const Many circle{Circle{1.0}};
+
+        REQUIRE(ajcf::visit(size_of, number) == sizeof(short));
+        REQUIRE(ajcf::visit(size_of, circle) == sizeof(Circle));
+    }
+
+    TEST_CASE("closed polymorphism: containers", "[classes][closed_polymorphism]")
+    {
+        ajcf::ClosedVector<Circle, Rectangle> vector;
+        ajcf::ClosedCollection<Circle, Rectangle> collection;
+        vector.reserve(3);
+        collection.values<Circle>().reserve(2);
+        collection.values<Rectangle>().reserve(1);
+
+        ajcf::AllocationCounter counter;
+
+        vector.emplace_back<Circle>(1.0);
+        vector.emplace_back<Rectangle>(2.0, 3.0);
+        vector.emplace_back<Circle>(2.0);
+        collection.emplace_back<Circle>(1.0);
+        collection.emplace_back<Rectangle>(2.0, 3.0);
+        collection.emplace_back<Circle>(2.0);
+
+        // stored by value, without any allocation per object
+        REQUIRE(counter.allocations() == 0);
+        REQUIRE(vector.size() == 3);
+        REQUIRE(collection.size() == 3);
+
+        // the vector keeps the order of insertion, the collection groups the objects by type
+        std::string vector_names;
+        vector.for_each([&](const auto& shape) { vector_names += shape.name() + " "; });
+        std::string collection_names;
+        collection.for_each([&](const auto& shape) { collection_names += shape.name() + " "; });
+
+        REQUIRE(vector_names == "circle rectangle circle ");
+        REQUIRE(collection_names == "circle circle rectangle ");
+
+        double vector_area = 0.0;
+        vector.for_each([&](const auto& shape) { vector_area += shape.area(); });
+        double collection_area = 0.0;
+        collection.for_each([&](const auto& shape) { collection_area += shape.area(); });
+
+        REQUIRE(vector_area == 21.0);
+        REQUIRE(collection_area == 21.0);
+        REQUIRE(collection.values<Rectangle>().front().area() == 6.0);
+
+        collection.clear();
+
+        REQUIRE(collection.empty());
+    }
+
+    namespace benchmarks {
+
+        // the same shapes with virtual functions, each allocated on its own
+        class VirtualShape
+        {
+        public:
+            virtual ~VirtualShape() = default;
+
+            virtual double area() const = 0;
+        };
+
+        class VirtualCircle : public VirtualShape
+        {
+        public:
+            explicit VirtualCircle(double radius) : m_radius(radius)
+            {
+            }
+
+            double area() const override
+            {
+                return 3.0 * m_radius * m_radius;
+            }
+
+        private:
+            double m_radius;
+        };
+
+        class VirtualRectangle : public VirtualShape
+        {
+        public:
+            VirtualRectangle(double width, double height) : m_width(width), m_height(height)
+            {
+            }
+
+            double area() const override
+            {
+                return m_width * m_height;
+            }
+
+        private:
+            double m_width;
+            double m_height;
+        };
+
+        class Square : public Shape<Square>
+        {
+        public:
+            static constexpr const char* shape_name = "square";
+
+            explicit Square(double side) : m_side(side)
+            {
+            }
+
+            double compute_area() const
+            {
+                return m_side * m_side;
+            }
+
+        private:
+            double m_side;
+        };
+
+        class VirtualSquare : public VirtualShape
+        {
+        public:
+            explicit VirtualSquare(double side) : m_side(side)
+            {
+            }
+
+            double area() const override
+            {
+                return m_side * m_side;
+            }
+
+        private:
+            double m_side;
+        };
+
+        class Triangle : public Shape<Triangle>
+        {
+        public:
+            static constexpr const char* shape_name = "triangle";
+
+            Triangle(double base, double height) : m_base(base), m_height(height)
+            {
+            }
+
+            double compute_area() const
+            {
+                return 0.5 * m_base * m_height;
+            }
+
+        private:
+            double m_base;
+            double m_height;
+        };
+
+        class VirtualTriangle : public VirtualShape
+        {
+        public:
+            VirtualTriangle(double base, double height) : m_base(base), m_height(height)
+            {
+            }
+
+            double area() const override
+            {
+                return 0.5 * m_base * m_height;
+            }
+
+        private:
+            double m_base;
+            double m_height;
+        };
+
+        TEST_CASE("sum of the areas of 10M mixed shapes: virtual functions vs closed polymorphism",
+                  "[classes][closed_polymorphism][benchmark][!hide]")
+        {
+            constexpr std::size_t shapes_count = 10'000'000;
+
+            // the same random kinds of shapes for all the containers, so that the branches are not predictable
+            std::vector<unsigned char> kinds(shapes_count);
+            std::mt19937 random{42};
+            std::uniform_int_distribution<int> kind_distribution{0, 3};
+            std::generate(kinds.begin(), kinds.end(),
+                          [&] { return static_cast<unsigned char>(kind_distribution(random)); });
+
+            const auto print_shapes_per_second = [&](const char* name, std::size_t bytes, auto&& sum_areas) {
+                double total_area = 0.0;
+                std::chrono::duration<double> best_elapsed{1e9};
+                for (int run = 0; run != 3; ++run)
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    total_area = sum_areas();
+                    best_elapsed = std::min<std::chrono::duration<double>>(best_elapsed,
+                                                                           std::chrono::steady_clock::now() - start);
+                }
+                fmt::print("{:<44} {:>8.1f} M shapes/s {:>6} MB (total area {})\n", name,
+                           shapes_count / best_elapsed.count() / 1e6, bytes / 1'000'000, total_area);
+            };
+
+            const auto size_of = [](double value) { return 1.0 + value / 1'000'000; };
+
+            fmt::print("{}M shapes, 4 types in random order:\n", shapes_count / 1'000'000);
+            {
+                std::vector<std::unique_ptr<VirtualShape>> shapes;
+                shapes.reserve(shapes_count);
+                for (std::size_t index = 0; index != shapes_count; ++index)
+                {
+                    const auto size = size_of(static_cast<double>(index));
+                    switch (kinds[index])
+                    {
+                    case 0:
+                        shapes.push_back(std::make_unique<VirtualCircle>(size));
+                        break;
+                    case 1:
+                        shapes.push_back(std::make_unique<VirtualRectangle>(size, 2.0));
+                        break;
+                    case 2:
+                        shapes.push_back(std::make_unique<VirtualSquare>(size));
+                        break;
+                    default:
+                        shapes.push_back(std::make_unique<VirtualTriangle>(size, 2.0));
+                        break;
+                    }
+                }
+
+                // the allocated objects are not counted (at least 16 bytes each)
+                print_shapes_per_second("  std::vector<std::unique_ptr<VirtualShape>>",
+                                        shapes_count * sizeof(std::unique_ptr<VirtualShape>), [&] {
+                                            double total_area = 0.0;
+                                            for (const auto& shape : shapes)
+                                                total_area += shape->area();
+                                            return total_area;
+                                        });
+            }
+
+            {
+                ajcf::ClosedVector<Circle, Rectangle, Square, Triangle> shapes;
+                ajcf::ClosedCollection<Circle, Rectangle, Square, Triangle> collection;
+                shapes.reserve(shapes_count);
+                for (std::size_t index = 0; index != shapes_count; ++index)
+                {
+                    const auto size = size_of(static_cast<double>(index));
+                    switch (kinds[index])
+                    {
+                    case 0:
+                        shapes.emplace_back<Circle>(size);
+                        collection.emplace_back<Circle>(size);
+                        break;
+                    case 1:
+                        shapes.emplace_back<Rectangle>(size, 2.0);
+                        collection.emplace_back<Rectangle>(size, 2.0);
+                        break;
+                    case 2:
+                        shapes.emplace_back<Square>(size);
+                        collection.emplace_back<Square>(size);
+                        break;
+                    default:
+                        shapes.emplace_back<Triangle>(size, 2.0);
+                        collection.emplace_back<Triangle>(size, 2.0);
+                        break;
+                    }
+                }
+
+                const auto shapes_bytes = shapes_count * sizeof(decltype(shapes)::value_type);
+                print_shapes_per_second("  ajcf::ClosedVector, std::visit", shapes_bytes, [&] {
+                    double total_area = 0.0;
+                    for (const auto& shape : shapes)
+                        total_area += std::visit([](const auto& any_shape) { return any_shape.area(); }, shape);
+                    return total_area;
+                });
+                print_shapes_per_second("  ajcf::ClosedVector, ajcf::visit", shapes_bytes, [&] {
+                    double total_area = 0.0;
+                    shapes.for_each([&](const auto& shape) { total_area += shape.area(); });
+                    return total_area;
+                });
+
+                std::size_t collection_bytes = 0;
+                collection.for_each([&](const auto& shape) { collection_bytes += sizeof(shape); });
+                print_shapes_per_second("  ajcf::ClosedCollection (grouped by type)", collection_bytes, [&] {
+                    double total_area = 0.0;
+                    collection.for_each([&](const auto& shape) { total_area += shape.area(); });
+                    return total_area;
+                });
+            }
+        }
+
+    } // namespace benchmarks
+
+} // namespace
@@ -0,0 +1,259 @@
+// https://en.cppreference.com/w/cpp/utility/variant/visit
+// https://en.cppreference.com/w/cpp/language/crtp
+// https://www.youtube.com/watch?v=gKbORJtnVu8 (runtime polymorphism without virtual functions)
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace ajcf {
+
+    // Base class of a static interface (CRTP): the functions of the interface call the functions of Derived
+    // directly, they are inlined, there is no virtual table
+    //   template <typename Derived>
+    //   class Shape : public ajcf::StaticInterface<Derived>
+    //   {
+    //   public:
+    //       double area() const { return this->derived().compute_area(); }
+    //   };
+    //   class Square : public Shape<Square> { ... double compute_area() const; };
+    template <typename Derived>
+    class StaticInterface
+    {
+    protected:
+        StaticInterface() = default;
+        StaticInterface(const StaticInterface&) = default;
+        StaticInterface& operator=(const StaticInterface&) = default;
+        ~StaticInterface() = default;
+
+        Derived& derived() noexcept
+        {
+            static_assert(std::is_base_of_v<StaticInterface, Derived>, "Derived must derive from its interface");
+            return static_cast<Derived&>(*this);
+        }
+
+        const Derived& derived() const noexcept
+        {
+            static_assert(std::is_base_of_v<StaticInterface, Derived>, "Derived must derive from its interface");
+            return static_cast<const Derived&>(*this);
+        }
+    };
+
+    namespace closed_polymorphism_details {
+
+        template <typename Result, typename Visitor, typename Variant, std::size_t Index>
+        Result visit_alternative(Visitor& visitor, Variant& variant)
+        {
+            // the index is checked by the caller: no check, no exception
+            return visitor(*std::get_if<Index>(&variant));
+        }
+
+        template <typename Result, typename Visitor, typename Variant, std::size_t... Indexes>
+        constexpr auto make_jump_table(std::index_sequence<Indexes...>) noexcept
+        {
+            using Function = Result (*)(Visitor&, Variant&);
+            return std::array<Function, sizeof...(Indexes)>{
+                &visit_alternative<Result, Visitor, Variant, Indexes>...};
+        }
+
+        // One function per alternative, generated at compile time, indexed by variant.index()
+        template <typename Result, typename Visitor, typename Variant>
+        inline constexpr auto jump_table = make_jump_table<Result, Visitor, Variant>(
+            std::make_index_sequence<std::variant_size_v<std::remove_const_t<Variant>>>{});
+
+        // One comparison per alternative, the last one needs none: the compiler turns the comparisons into
+        // its own jump table, and inlines the calls of the visitor
+        template <typename Result, std::size_t Index, typename Visitor, typename Variant>
+        Result visit_from(Visitor& visitor, Variant& variant, std::size_t index)
+        {
+            if constexpr (Index + 1 == std::variant_size_v<std::remove_const_t<Variant>>)
+                return visitor(*std::get_if<Index>(&variant));
+            else
+            {
+                if (index == Index)
+                    return visitor(*std::get_if<Index>(&variant));
+                return visit_from<Result, Index + 1>(visitor, variant, index);
+            }
+        }
+
+        // Above, the table of functions, which are not inlined, gives smaller code
+        constexpr std::size_t max_inlined_alternatives = 8;
+
+    } // namespace closed_polymorphism_details
+
+    // Call visitor with the alternative held by variant, through a jump table indexed by the alternative
+    // Unlike std::visit, there is no check of valueless_by_exception and no std::bad_variant_access:
+    // the variant must hold a value (the alternatives of a closed set are usually nothrow movable)
+    // All the alternatives must give the same result type
+    template <typename Visitor, typename Variant>
+    decltype(auto) visit(Visitor&& visitor, Variant& variant)
+    {
+        namespace details = closed_polymorphism_details;
+        using Result = std::invoke_result_t<Visitor&, decltype(*std::get_if<0>(&variant))>;
+        if constexpr (std::variant_size_v<std::remove_const_t<Variant>> <= details::max_inlined_alternatives)
+            return details::visit_from<Result, 0>(visitor, variant, variant.index());
+        else
+        {
+            constexpr auto& table = details::jump_table<Result, std::remove_reference_t<Visitor>, Variant>;
+            return table[variant.index()](visitor, variant);
+        }
+    }
+
+    // Objects of a closed set of types, stored by value in one contiguous array, in the order of insertion:
+    // no allocation per object and no virtual call, for_each visits them through ajcf::visit
+    //   ajcf::ClosedVector<Circle, Square> shapes;
+    //   shapes.emplace_back<Circle>(1.5);
+    //   shapes.for_each([&](const auto& shape) { total += shape.area(); });
+    template <typename... Types>
+    class ClosedVector
+    {
+    public:
+        using value_type = std::variant<Types...>;
+        using iterator = typename std::vector<value_type>::iterator;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+
+        template <typename T, typename... Args>
+        T& emplace_back(Args&&... args)
+        {
+            return std::get<T>(m_values.emplace_back(std::in_place_type<T>, std::forward<Args>(args)...));
+        }
+
+        template <typename Function>
+        void for_each(Function&& function)
+        {
+            for (auto& value : m_values)
+                ajcf::visit(function, value);
+        }
+
+        template <typename Function>
+        void for_each(Function&& function) const
+        {
+            for (const auto& value : m_values)
+                ajcf::visit(function, value);
+        }
+
+        std::size_t size() const noexcept
+        {
+            return m_values.size();
+        }
+
+        bool empty() const noexcept
+        {
+            return m_values.empty();
+        }
+
+        void reserve(std::size_t count)
+        {
+            m_values.reserve(count);
+        }
+
+        void clear() noexcept
+        {
+            m_values.clear();
+        }
+
+        value_type& operator[](std::size_t index) noexcept
+        {
+            return m_values[index];
+        }
+
+        const value_type& operator[](std::size_t index) const noexcept
+        {
+            return m_values[index];
+        }
+
+        iterator begin() noexcept
+        {
+            return m_values.begin();
+        }
+
+        iterator end() noexcept
+        {
+            return m_values.end();
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return m_values.begin();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return m_values.end();
+        }
+
+    private:
+        std::vector<value_type> m_values;
+    };
+
+    // Objects of a closed set of types, stored in one contiguous array per type: for_each visits all the objects
+    // of a type, then all the objects of the next type, without any dispatch at all
+    // The order of insertion is kept only between the objects of the same type
+    template <typename... Types>
+    class ClosedCollection
+    {
+    public:
+        template <typename T, typename... Args>
+        T& emplace_back(Args&&... args)
+        {
+            return values<T>().emplace_back(std::forward<Args>(args)...);
+        }
+
+        template <typename Function>
+        void for_each(Function&& function)
+        {
+            std::apply([&](auto&... vectors) { (for_each_in(vectors, function), ...); }, m_vectors);
+        }
+
+        template <typename Function>
+        void for_each(Function&& function) const
+        {
+            std::apply([&](const auto&... vectors) { (for_each_in(vectors, function), ...); }, m_vectors);
+        }
+
+        // The objects of type T
+        template <typename T>
+        std::vector<T>& values() noexcept
+        {
+            return std::get<std::vector<T>>(m_vectors);
+        }
+
+        template <typename T>
+        const std::vector<T>& values() const noexcept
+        {
+            return std::get<std::vector<T>>(m_vectors);
+        }
+
+        std::size_t size() const noexcept
+        {
+            return std::apply([](const auto&... vectors) { return (vectors.size() + ... + 0); }, m_vectors);
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        void clear() noexcept
+        {
+            std::apply([](auto&... vectors) { (vectors.clear(), ...); }, m_vectors);
+        }
+
+    private:
+        template <typename Vector, typename Function>
+        static void for_each_in(Vector& vector, Function& function)
+        {
+            for (auto& value : vector)
+                function(value);
+        }
+
+        std::tuple<std::vector<Types>...> m_vectors;
+    };
+
+} // namespace ajcf
@@ -7,6 +7,8 @@
 // https://en.cppreference.com/w/cpp/language/for
 // https://en.cppreference.com/w/cpp/language/range-for
 
+#include "string_builder.hpp"
+#include "string_pool.hpp"
 #include <catch2/catch.hpp>
 #include <sstream>
 #include <string>
@@ -88,6 +90,36 @@ namespace {
         REQUIRE(example_if("meuh", 4) == "others");
     }
 
+    // with interned strings, each comparison only compares two pointers
+    std::string example_if_with_interned_strings(ajcf::InternedString sound, int legs_count)
+    {
+        static const auto miaou = ajcf::intern("miaou");
+        static const auto ouaf = ajcf::intern("ouaf");
+        static const auto cuicui = ajcf::intern("cuicui");
+
+        std::string result;
+
+        if (sound == miaou || sound == ouaf)
+            result += "dogs and cats";
+        else if (sound == cuicui && legs_count == 1)
+            result += "pink floyds";
+        else
+            result += legs_count == 2 ? "othersbipeds" : "others";
+
+        return result;
+    }
+
+    TEST_CASE("if with interned strings", "[conditions]")
+    {
+        REQUIRE(example_if_with_interned_strings(ajcf::intern("miaou"), 123) == "dogs and cats");
+
+        REQUIRE(example_if_with_interned_strings(ajcf::intern("cuicui"), 1) == "pink floyds");
+
+        REQUIRE(example_if_with_interned_strings(ajcf::intern("cuicui"), 2) == "othersbipeds");
+
+        REQUIRE(example_if_with_interned_strings(ajcf::intern("meuh"), 4) == "others");
+    }
+
     std::string example_ternary_operator(std::string sound)
     {
         return (sound == "meuh") ? "This is a cow" : "This is NOT a cow";
@@ -100,9 +132,11 @@ namespace {
         REQUIRE(example_ternary_operator("grrr") == "This is NOT a cow");
     }
 
+    // the text is built with a std::stringstream or an ajcf::StringBuilder (faster, no dynamic allocation)
+    template <typename Builder = ajcf::StringBuilder>
     std::string example_while_do()
     {
-        std::stringstream result{};
+        Builder result{};
 
         int i = 5;
 
@@ -136,6 +170,8 @@ namespace {
     TEST_CASE("while / do", "[loops]")
     {
         REQUIRE(example_while_do() == "5,4,exited first loop,3,4,exited second loop.");
+
+        REQUIRE(example_while_do<std::stringstream>() == example_while_do());
     }
 
     std::string example_for()
@@ -219,4 +255,22 @@ namespace {
         REQUIRE(example_range_for() == "[h][e][l][l][o]");
     }
 
+    namespace benchmarks {
+
+        TEST_CASE("example_while_do: std::stringstream vs ajcf::StringBuilder",
+                  "[loops][string_builder][benchmark][!hide]")
+        {
+            BENCHMARK("example_while_do - std::stringstream")
+            {
+                return example_while_do<std::stringstream>();
+            };
+
+            BENCHMARK("example_while_do - ajcf::StringBuilder")
+            {
+                return example_while_do<ajcf::StringBuilder>();
+            };
+        }
+
+    } // namespace benchmarks
+
 } // namespace
@@ -2,6 +2,7 @@
 // https://en.cppreference.com/w/cpp/language/cv
 // https://en.cppreference.com/w/cpp/language/constexpr
 
+#include "simd_string.hpp"
 #include <catch2/catch.hpp>
 #include <cassert>
 #include <string>
@@ -114,12 +115,8 @@ namespace {
 
     bool find_by_const_ref(const std::string& s, char c)
     {
-        for (char car : s)
-        {
-            if (car == c)
-                return true;
-        }
-        return false;
+        // compare 16 or 32 characters at once instead of looping on each character
+        return ajcf::simd::find_char(s, c) != std::string_view::npos;
     }
 
     bool find_by_ref(std::string& s, char c)
@@ -1,6 +1,7 @@
 
 // https://en.cppreference.com/w/cpp/container
 
+#include "slab_allocator.hpp"
 #include <type_traits>
 #include <unordered_map>
 #include <catch2/catch.hpp>
@@ -216,4 +217,38 @@ namespace {
         // Cannot know which element was removed because elements are not sorted
     }
 
+    TEST_CASE("containers with a custom allocator", "[containers][allocation]")
+    {
+        INFO("every standard container takes an optional allocator type as its last template parameter");
+        INFO("it is used for all the container's dynamic allocations (elements, nodes, buckets, ...)");
+
+        // the slab allocator serves small allocations from per-thread caches of fixed-size blocks
+        std::vector<int, ajcf::SlabAllocator<int>> vec{1, 2, 3, 4, 5, 6, 7};
+        vec.push_back(45);
+
+        REQUIRE(vec == std::vector<int, ajcf::SlabAllocator<int>>{1, 2, 3, 4, 5, 6, 7, 45});
+
+        // each node of a list is allocated separately: this is where a small-object allocator helps the most
+        std::list<int, ajcf::SlabAllocator<int>> lst{1, 2, 3};
+        lst.push_front(98);
+
+        REQUIRE(lst == std::list<int, ajcf::SlabAllocator<int>>{98, 1, 2, 3});
+
+        // note: the allocator's value_type must be the container's value_type, i.e. std::pair<const Key, Value>
+        std::map<int, double, std::less<int>, ajcf::SlabAllocator<std::pair<const int, double>>> map{{3, 2.3},
+                                                                                                       {1, 8.1}};
+        map[2] = 5.5;
+
+        REQUIRE(map.begin()->first == 1);
+        REQUIRE(map.size() == 3);
+
+        std::unordered_map<int, double, std::hash<int>, std::equal_to<int>,
+                           ajcf::SlabAllocator<std::pair<const int, double>>>
+            umap{{1, 2.3}, {2, 5.5}};
+        umap[123] = 45.67;
+
+        REQUIRE(umap.size() == 3);
+        REQUIRE(umap.at(123) == Approx(45.67));
+    }
+
 } // namespace
@@ -1,7 +1,11 @@
 
+#include "closed_polymorphism.hpp"
+#include "number_formatting.hpp"
+#include "rtti_lite.hpp"
 #include <catch2/catch.hpp>
 #include <cstring>
 #include <string>
+#include <variant>
 
 namespace {
 
@@ -60,6 +64,12 @@ namespace {
         REQUIRE(derived_again != nullptr);
         REQUIRE(derived_again->what() == "Derived");
 
+        // when the set of types is closed, a std::variant knows the type without any dynamic_cast
+        std::variant<Base, Derived> closed_base{Derived{}};
+
+        REQUIRE(std::get_if<Derived>(&closed_base) != nullptr);
+        REQUIRE(ajcf::visit([](const auto& any_base) { return any_base.what(); }, closed_base) == "Derived");
+
         char c_style_string[] = "ABC";
 
         // warning: you should avoid using void*
@@ -75,6 +85,67 @@ namespace {
         REQUIRE(std::strcmp(pointer_to_chars, "ABC") == 0);
     }
 
+    // the same Base and Derived with type ids instead of RTTI
+    class TaggedBase;
+    class TaggedDerived;
+    class OtherTaggedDerived;
+
+    using TaggedHierarchy = ajcf::TypeHierarchy<TaggedBase, TaggedDerived, OtherTaggedDerived>;
+
+    // the copy constructors give the id too (ajcf::TypeTagged cannot be copied without an id)
+    class TaggedBase : public ajcf::TypeTagged<TaggedHierarchy>
+    {
+    protected:
+        explicit TaggedBase(ajcf::TypeId type_id) : TypeTagged(type_id)
+        {
+        }
+
+        TaggedBase(const TaggedBase& other, ajcf::TypeId type_id) : TypeTagged(other, type_id)
+        {
+        }
+    };
+
+    class TaggedDerived : public TaggedBase
+    {
+    public:
+        TaggedDerived() : TaggedBase(TaggedHierarchy::id<TaggedDerived>)
+        {
+        }
+
+        TaggedDerived(const TaggedDerived& other) : TaggedBase(other, TaggedHierarchy::id<TaggedDerived>)
+        {
+        }
+    };
+
+    class OtherTaggedDerived : public TaggedBase
+    {
+    public:
+        OtherTaggedDerived() : TaggedBase(TaggedHierarchy::id<OtherTaggedDerived>)
+        {
+        }
+
+        OtherTaggedDerived(const OtherTaggedDerived& other)
+            : TaggedBase(other, TaggedHierarchy::id<OtherTaggedDerived>)
+        {
+        }
+    };
+
+    TEST_CASE("explicit conversions without RTTI", "[conversions][rtti_lite]")
+    {
+        TaggedDerived derived;
+        TaggedBase& base = derived;
+        // like dynamic_cast, but the type id is compared with the range of ids of TaggedDerived and its derived
+        // classes: no walk through the RTTI of the hierarchy
+        TaggedDerived* derived_again = ajcf::dyn_cast<TaggedDerived>(&base);
+
+        REQUIRE(derived_again == &derived);
+        REQUIRE(ajcf::dyn_cast<OtherTaggedDerived>(&base) == nullptr);
+
+        const TaggedDerived copy = derived;
+
+        REQUIRE(ajcf::isa<TaggedDerived>(copy));
+    }
+
     void func(std::string s)
     {
     }
@@ -99,9 +170,10 @@ namespace {
         }
 
         // explicitely convertible to std::string
+        // (formatted on the stack without locale, std::to_string may use the C library sprintf)
         explicit operator std::string() const
         {
-            return std::to_string(m_i);
+            return ajcf::FormattedNumber<int>{m_i}.str();
         }
 
     private:
@@ -116,6 +188,8 @@ namespace {
         // ct can be copied only explicitely (with a cast) because of explicit ConvertibleThing::operator
         // std::string()
         std::string s = static_cast<std::string>(ct);
+
+        REQUIRE(s == std::to_string(static_cast<int>(d)));
     }
 
     TEST_CASE("implicit conversions and temporary objects", "[conversions]")
@@ -149,6 +223,8 @@ namespace {
 
         // we can however tell the compiler we want this conversion
         take_ref_to_non_mutable_convertible_thing(ConvertibleThing{12.45});
+
+        REQUIRE(static_cast<std::string>(ConvertibleThing{-123}) == "-123");
     }
 
 } // namespace
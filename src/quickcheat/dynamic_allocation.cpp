@@ -2,6 +2,8 @@
 // https://en.cppreference.com/w/cpp/language/new
 // https://en.cppreference.com/w/cpp/language/delete
 
+#include "huge_page_allocator.hpp"
+#include "relocating_vector.hpp"
 #include <catch2/catch.hpp>
 #include <memory>
 #include <vector>
@@ -86,6 +88,19 @@ namespace {
 
     } // call delete[] behind the scene automatically in the unique_ptr object's destructor
 
+    TEST_CASE("big array allocation backed by huge pages", "[dynamic][allocation]")
+    {
+        // map memory directly from the OS behind the scene, asking for huge pages (2 MiB instead of 4 KiB)
+        // then construct all the objects of the array
+        // and store the resulting pointer as a member of the returned unique_ptr object
+        ajcf::unique_huge_page_array<S> p = ajcf::make_unique_huge_page_array<S>(1'000'000);
+
+        // Use any object of the allocated array
+        REQUIRE(p[3].i == 0);
+        REQUIRE(p[3].j == 0);
+
+    } // destroy all the objects then unmap the memory behind the scene in the unique_ptr object's destructor
+
     TEST_CASE("resizable array allocation with std::vector", "[dynamic][allocation]")
     {
         // call new[50] behind the scene
@@ -111,4 +126,28 @@ namespace {
 
     } // call delete[] behind the scene automatically in the vector object's destructor
 
+    TEST_CASE("resizable array allocation without copies", "[dynamic][allocation]")
+    {
+        // S is trivially copyable, so its objects can be moved to a new memory area by copying their bytes
+        ajcf::RelocatingVector<S> v(50);
+
+        REQUIRE(v[3].i == 0);
+        REQUIRE(v[3].j == 0);
+
+        v[12] = S{12, 34};
+
+        // call realloc behind the scene
+        // which first tries to expand the memory area in place
+        // and else moves the bytes to a new area (big areas are moved by the OS without copying)
+        // no constructor and no destructor is called for the already existing objects
+        v.resize(100);
+
+        REQUIRE(v[12].i == 12);
+        REQUIRE(v[12].j == 34);
+        REQUIRE(v[75].i == 0);
+        REQUIRE(v[75].j == 0);
+        REQUIRE(v.statistics().element_moves == 0);
+
+    } // call free behind the scene automatically in the vector object's destructor
+
 } // namespace
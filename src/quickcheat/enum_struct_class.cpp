@@ -2,6 +2,7 @@
 // https://en.cppreference.com/w/cpp/language/enum
 // https://en.cppreference.com/w/cpp/language/class
 
+#include "string_builder.hpp"
 #include <catch2/catch.hpp>
 #include <sstream>
 #include <string>
@@ -28,9 +29,11 @@ namespace {
         Magenta = 5,
     };
 
+    // the text is built with a std::stringstream or an ajcf::StringBuilder (faster, no dynamic allocation)
+    template <typename Builder = ajcf::StringBuilder>
     std::string display_enum(Color_C color)
     {
-        std::stringstream result;
+        Builder result;
         result << "color = " << static_cast<int>(color) << " (";
         switch (color)
         {
@@ -51,9 +54,10 @@ namespace {
         return result.str();
     }
 
+    template <typename Builder = ajcf::StringBuilder>
     std::string display_enum(Color_Cpp11 color)
     {
-        std::stringstream result;
+        Builder result;
         result << "color = " << static_cast<int>(color) << " (";
         switch (color)
         {
@@ -79,6 +83,8 @@ namespace {
         REQUIRE(display_enum(Color_C_Blue) == "color = 1 (Color_C_Blue)");
 
         REQUIRE(display_enum(Color_Cpp11::Green) == "color = 5 (Color_Cpp11::Green)");
+
+        REQUIRE(display_enum<std::stringstream>(Color_C_Blue) == display_enum(Color_C_Blue));
     }
 
     // Differences between keywords struct/class:
@@ -169,4 +175,21 @@ namespace {
         c4 = std::move(c3);
     } // destruction of c4, c3, c2, c1, c0, in this order
 
+    namespace benchmarks {
+
+        TEST_CASE("display_enum: std::stringstream vs ajcf::StringBuilder", "[enum][string_builder][benchmark][!hide]")
+        {
+            BENCHMARK("display_enum - std::stringstream")
+            {
+                return display_enum<std::stringstream>(Color_Cpp11::Green);
+            };
+
+            BENCHMARK("display_enum - ajcf::StringBuilder")
+            {
+                return display_enum<ajcf::StringBuilder>(Color_Cpp11::Green);
+            };
+        }
+
+    } // namespace benchmarks
+
 } // namespace
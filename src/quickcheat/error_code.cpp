@@ -0,0 +1,196 @@
+// https://en.cppreference.com/w/cpp/error/error_category
+// https://github.com/TartanLlama/expected
+
+#include "error_code.hpp"
+#include "allocation_counter.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ajcf {
+
+    std::string Error::to_string() const
+    {
+        fmt::memory_buffer text;
+        fmt::format_to(text, "{}: {}", m_category->name(), message());
+        for (std::size_t index = 0; index != m_contexts_count; ++index)
+            fmt::format_to(text, "{}{}", index == 0 ? " (" : ", ", m_contexts[index]);
+        if (m_contexts_count != 0)
+            fmt::format_to(text, ")");
+        return fmt::to_string(text);
+    }
+
+    const char* to_string(ExceptionError error) noexcept
+    {
+        switch (error)
+        {
+        case ExceptionError::bad_alloc:
+            return "out of memory";
+        case ExceptionError::invalid_argument:
+            return "invalid argument";
+        case ExceptionError::domain_error:
+            return "domain error";
+        case ExceptionError::out_of_range:
+            return "out of range";
+        case ExceptionError::other_logic_error:
+            return "logic error";
+        case ExceptionError::other_runtime_error:
+            return "runtime error";
+        case ExceptionError::other_std_exception:
+            return "exception";
+        case ExceptionError::unknown_exception:
+            return "exception of unknown type";
+        }
+        return "unknown error";
+    }
+
+    const ErrorCategory& error_category(ExceptionError) noexcept
+    {
+        static const EnumErrorCategory<ExceptionError> category{"exception"};
+        return category;
+    }
+
+    Error current_exception_error(const char* context) noexcept
+    {
+        if (!std::current_exception())
+            return Error{ExceptionError::unknown_exception, context};
+
+        // the most derived types first
+        try
+        {
+            throw;
+        }
+        catch (const std::bad_alloc&)
+        {
+            return Error{ExceptionError::bad_alloc, context};
+        }
+        catch (const std::invalid_argument&)
+        {
+            return Error{ExceptionError::invalid_argument, context};
+        }
+        catch (const std::domain_error&)
+        {
+            return Error{ExceptionError::domain_error, context};
+        }
+        catch (const std::out_of_range&)
+        {
+            return Error{ExceptionError::out_of_range, context};
+        }
+        catch (const std::logic_error&)
+        {
+            return Error{ExceptionError::other_logic_error, context};
+        }
+        catch (const std::runtime_error&)
+        {
+            return Error{ExceptionError::other_runtime_error, context};
+        }
+        catch (const std::exception&)
+        {
+            return Error{ExceptionError::other_std_exception, context};
+        }
+        catch (...)
+        {
+            return Error{ExceptionError::unknown_exception, context};
+        }
+    }
+
+} // namespace ajcf
+
+namespace {
+
+    enum class StockError
+    {
+        out_of_stock = 1,
+        unknown_product,
+    };
+
+    const char* to_string(StockError error) noexcept
+    {
+        switch (error)
+        {
+        case StockError::out_of_stock:
+            return "out of stock";
+        case StockError::unknown_product:
+            return "unknown product";
+        }
+        return "unknown error";
+    }
+
+    const ajcf::ErrorCategory& error_category(StockError) noexcept
+    {
+        static const ajcf::EnumErrorCategory<StockError> category{"stock"};
+        return category;
+    }
+
+    static_assert(ajcf::is_error_code_enum<StockError>);
+    static_assert(!ajcf::is_error_code_enum<int>);
+    static_assert(std::is_trivially_copyable_v<ajcf::Error>);
+    static_assert(sizeof(ajcf::Error) <= 40);
+
+    tl::expected<int, ajcf::Error> quantity(const std::string& product)
+    {
+        if (product == "apple")
+            return 12;
+        if (product == "pear")
+            return tl::make_unexpected(ajcf::Error{StockError::out_of_stock, "looking for the quantity"});
+        return tl::make_unexpected(ajcf::Error{StockError::unknown_product, "looking for the quantity"});
+    }
+
+    tl::expected<int, ajcf::Error> price(const std::string& product, int unit_price)
+    {
+        return quantity(product)
+            .map([unit_price](int count) { return count * unit_price; })
+            .map_error([](ajcf::Error error) { return error.add_context("computing the price"); });
+    }
+
+    TEST_CASE("typed error codes", "[exceptions][error_code]")
+    {
+        ajcf::AllocationCounter counter;
+
+        REQUIRE(price("apple", 3) == 36);
+
+        const auto error = price("pear", 3).error();
+
+        REQUIRE(error == StockError::out_of_stock);
+        REQUIRE(error != StockError::unknown_product);
+        REQUIRE(error != ajcf::ExceptionError::bad_alloc); // same code, other category
+        REQUIRE(error.contexts_count() == 2);
+
+        // creating, propagating and inspecting the errors never allocates
+        REQUIRE(counter.allocations() == 0);
+
+        REQUIRE(std::string{error.category().name()} == "stock");
+        REQUIRE(std::string{error.message()} == "out of stock");
+        REQUIRE(std::string{error.context(1)} == "computing the price");
+
+        REQUIRE(error.to_string() == "stock: out of stock (looking for the quantity, computing the price)");
+        REQUIRE(ajcf::Error{StockError::unknown_product}.to_string() == "stock: unknown product");
+
+        // the oldest contexts are kept
+        ajcf::Error many_contexts{StockError::out_of_stock, "1"};
+        many_contexts.add_context("2").add_context("3").add_context("4");
+
+        REQUIRE(many_contexts.contexts_count() == ajcf::Error::max_contexts_count);
+        REQUIRE(std::string{many_contexts.context(2)} == "3");
+    }
+
+    TEST_CASE("typed error codes: functions which throw", "[exceptions][error_code]")
+    {
+        const auto to_int = [](const std::string& text) { return std::stoi(text); };
+
+        REQUIRE(ajcf::invoke_catching(to_int, "42") == 42);
+        REQUIRE(ajcf::invoke_catching(to_int, "abc").error() == ajcf::ExceptionError::invalid_argument);
+        REQUIRE(ajcf::invoke_catching(to_int, "99999999999").error() == ajcf::ExceptionError::out_of_range);
+        REQUIRE(ajcf::invoke_catching([] { std::vector<int>{}.at(1); }).error() ==
+                ajcf::ExceptionError::out_of_range);
+        REQUIRE(ajcf::invoke_catching([] { throw std::runtime_error("boum"); }).error() ==
+                ajcf::ExceptionError::other_runtime_error);
+        REQUIRE(ajcf::invoke_catching([] { throw 1234; }).error() == ajcf::ExceptionError::unknown_exception);
+        REQUIRE(ajcf::invoke_catching([] {}).has_value());
+
+        REQUIRE(ajcf::current_exception_error("no exception") == ajcf::ExceptionError::unknown_exception);
+    }
+
+} // namespace
@@ -0,0 +1,232 @@
+// https://en.cppreference.com/w/cpp/error/error_category
+// https://github.com/TartanLlama/expected
+// https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2018/p0709r0.pdf (zero-overhead deterministic exceptions)
+
+#pragma once
+
+#include <tl/expected.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace ajcf {
+
+    // Family of error codes, like std::error_category, but the messages are static texts:
+    // getting the message of an error never allocates
+    // There is one instance of each category, its address identifies it
+    class ErrorCategory
+    {
+    public:
+        ErrorCategory() = default;
+        ErrorCategory(const ErrorCategory&) = delete;
+        ErrorCategory& operator=(const ErrorCategory&) = delete;
+
+        virtual const char* name() const noexcept = 0;
+        virtual const char* message(int code) const noexcept = 0;
+
+    protected:
+        ~ErrorCategory() = default;
+    };
+
+    // Category of the errors of an enumeration, whose values are the codes and 0 is not an error
+    // The category is found by an overload of error_category(Enum) in the namespace of the enumeration
+    // and to_string(Enum) gives the messages:
+    //   enum class StockError { out_of_stock = 1, unknown_product };
+    //   const char* to_string(StockError error) noexcept;
+    //   const ajcf::ErrorCategory& error_category(StockError) noexcept
+    //   {
+    //       static const ajcf::EnumErrorCategory<StockError> category{"stock"};
+    //       return category;
+    //   }
+    template <typename Enum>
+    class EnumErrorCategory final : public ErrorCategory
+    {
+    public:
+        explicit constexpr EnumErrorCategory(const char* name) noexcept : m_name(name)
+        {
+        }
+
+        const char* name() const noexcept override
+        {
+            return m_name;
+        }
+
+        const char* message(int code) const noexcept override
+        {
+            return to_string(static_cast<Enum>(code));
+        }
+
+    private:
+        const char* m_name;
+    };
+
+    namespace error_code_details {
+
+        template <typename Enum, typename = void>
+        struct HasErrorCategory : std::false_type
+        {
+        };
+
+        template <typename Enum>
+        struct HasErrorCategory<Enum, std::void_t<decltype(error_category(std::declval<Enum>()))>>
+            : std::is_enum<Enum>
+        {
+        };
+
+    } // namespace error_code_details
+
+    template <typename Enum>
+    constexpr bool is_error_code_enum = error_code_details::HasErrorCategory<Enum>::value;
+
+    // Typed error code to return in a tl::expected<Value, ajcf::Error> instead of throwing an exception:
+    // - trivially copyable and small (40 bytes), creating, copying and inspecting an error never allocates
+    // - the code is compared without any rethrow nor dynamic_cast: error == StockError::out_of_stock
+    // - the callers which propagate the error can add up to max_contexts_count static texts of context
+    //   tl::expected<int, ajcf::Error> quantity(std::string_view product)
+    //   {
+    //       if (!is_known(product))
+    //           return tl::make_unexpected(ajcf::Error{StockError::unknown_product, "looking for the quantity"});
+    //       ...
+    //   }
+    //   quantity("apple").map_error([](ajcf::Error error) { return error.add_context("ordering"); });
+    class Error
+    {
+    public:
+        static constexpr std::size_t max_contexts_count = 3;
+
+        template <typename Enum, std::enable_if_t<is_error_code_enum<Enum>, int> = 0>
+        Error(Enum code, const char* context = nullptr) noexcept
+            : m_category(&error_category(code)), m_code(static_cast<int>(code))
+        {
+            if (context)
+                add_context(context);
+        }
+
+        const ErrorCategory& category() const noexcept
+        {
+            return *m_category;
+        }
+
+        int code() const noexcept
+        {
+            return m_code;
+        }
+
+        const char* message() const noexcept
+        {
+            return m_category->message(m_code);
+        }
+
+        template <typename Enum, std::enable_if_t<is_error_code_enum<Enum>, int> = 0>
+        bool is(Enum code) const noexcept
+        {
+            return m_category == &error_category(code) && m_code == static_cast<int>(code);
+        }
+
+        // The contexts are static texts, the first one is the closest to the origin of the error
+        // When there is no room left, the context is not kept (the origin of the error is more useful)
+        Error& add_context(const char* context) & noexcept
+        {
+            if (m_contexts_count != max_contexts_count)
+                m_contexts[m_contexts_count++] = context;
+            return *this;
+        }
+
+        Error&& add_context(const char* context) && noexcept
+        {
+            return std::move(add_context(context));
+        }
+
+        std::size_t contexts_count() const noexcept
+        {
+            return m_contexts_count;
+        }
+
+        const char* context(std::size_t index) const noexcept
+        {
+            return m_contexts[index];
+        }
+
+        // "category: message (context, outer context)", the only function which allocates
+        std::string to_string() const;
+
+        friend bool operator==(const Error& left, const Error& right) noexcept
+        {
+            return left.m_category == right.m_category && left.m_code == right.m_code;
+        }
+
+        friend bool operator!=(const Error& left, const Error& right) noexcept
+        {
+            return !(left == right);
+        }
+
+        template <typename Enum, std::enable_if_t<is_error_code_enum<Enum>, int> = 0>
+        friend bool operator==(const Error& error, Enum code) noexcept
+        {
+            return error.is(code);
+        }
+
+        template <typename Enum, std::enable_if_t<is_error_code_enum<Enum>, int> = 0>
+        friend bool operator!=(const Error& error, Enum code) noexcept
+        {
+            return !error.is(code);
+        }
+
+    private:
+        const ErrorCategory* m_category;
+        int m_code;
+        std::uint8_t m_contexts_count = 0;
+        std::array<const char*, max_contexts_count> m_contexts{};
+    };
+
+    // Errors of the functions which throw exceptions, see invoke_catching
+    enum class ExceptionError
+    {
+        bad_alloc = 1,
+        invalid_argument,
+        domain_error,
+        out_of_range,
+        other_logic_error,
+        other_runtime_error,
+        other_std_exception,
+        unknown_exception, // not derived from std::exception
+    };
+
+    const char* to_string(ExceptionError error) noexcept;
+    const ErrorCategory& error_category(ExceptionError) noexcept;
+
+    // Error of the exception being handled, to call in a catch block
+    // The message of the exception is lost: keeping it would need a dynamic allocation
+    Error current_exception_error(const char* context = nullptr) noexcept;
+
+    // Call a function which can throw, at the border between code with exceptions and code with ajcf::Error:
+    // the exceptions become errors, caught and inspected only once
+    //   tl::expected<int, ajcf::Error> value = ajcf::invoke_catching([&] { return std::stoi(text); });
+    template <typename Function, typename... Args>
+    auto invoke_catching(Function&& function, Args&&... args) noexcept
+        -> tl::expected<std::invoke_result_t<Function, Args...>, Error>
+    {
+        try
+        {
+            if constexpr (std::is_void_v<std::invoke_result_t<Function, Args...>>)
+            {
+                std::invoke(std::forward<Function>(function), std::forward<Args>(args)...);
+                return {};
+            }
+            else
+                return std::invoke(std::forward<Function>(function), std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            return tl::make_unexpected(current_exception_error());
+        }
+    }
+
+} // namespace ajcf
@@ -1,10 +1,20 @@
 
+#include "error_code.hpp"
+#include "noinline.hpp"
+#include "number_parsing.hpp"
 #include <catch2/catch.hpp>
+#include <fmt/format.h>
 #include <tl/expected.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <exception>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace {
 
@@ -196,21 +206,13 @@ namespace {
             }
         }
 
+        // no exception thrown nor caught: the error is created only for an invalid text
+        // The spaces around the number and a '+' are accepted, like the >> of std::istringstream
         IntOrError function_which_takes_a_string_and_returns_an_int_or_error(const std::string& text) noexcept
         {
-            try
-            {
-                std::istringstream iss(text);
-                int value{};
-                iss >> value;
-                if (iss.fail() || iss.peek() != std::istringstream::traits_type::eof())
-                    throw std::domain_error{"string does not contain a number"};
-                return value;
-            }
-            catch (const std::exception&)
-            {
-                return Error{std::current_exception()};
-            }
+            return ajcf::parse_number<int>(ajcf::trim_number(text)).map_error([](ajcf::ParseError) {
+                return std::make_exception_ptr(std::domain_error{"string does not contain a number"});
+            });
         }
 
         double function_which_takes_an_int_and_returns_a_double(int value) noexcept
@@ -289,8 +291,409 @@ namespace {
                 REQUIRE(result);
                 REQUIRE(result.value() == Approx{-8.4});
             }
+
+            // like std::istringstream: spaces and '+' accepted, not the characters after the number
+            REQUIRE(function_which_takes_a_string_and_returns_an_int_or_error(" +42 ").value() == 42);
+            REQUIRE(!function_which_takes_a_string_and_returns_an_int_or_error("42abc"));
         }
 
     } // namespace expected
 
+    namespace error_codes {
+
+        // the errors of function_which_throws_an_exception_sometime, as typed error codes
+        enum class StepError
+        {
+            int_1234 = 1,
+            run_time_error,
+            my_exception,
+            boum,
+        };
+
+        const char* to_string(StepError error) noexcept
+        {
+            switch (error)
+            {
+            case StepError::int_1234:
+                return "1234";
+            case StepError::run_time_error:
+                return "run time error";
+            case StepError::my_exception:
+                return "MyException";
+            case StepError::boum:
+                return "boum";
+            }
+            return "unknown error";
+        }
+
+        const ajcf::ErrorCategory& error_category(StepError) noexcept
+        {
+            static const ajcf::EnumErrorCategory<StepError> category{"step"};
+            return category;
+        }
+
+        using StringOrError = tl::expected<std::string, ajcf::Error>;
+        using IntOrError = tl::expected<int, ajcf::Error>;
+        using DoubleOrError = tl::expected<double, ajcf::Error>;
+        using Error = tl::unexpected<ajcf::Error>;
+
+        StringOrError function_which_returns_a_string_or_an_error_sometime(int choice, const char* text)
+        {
+            switch (choice)
+            {
+            case 1:
+                return Error{StepError::int_1234};
+            case 2:
+                return Error{StepError::run_time_error};
+            case 3:
+                return Error{StepError::my_exception};
+            case 4:
+                return Error{StepError::boum};
+            }
+
+            return std::string(" Everything is ok, we handled this text: ") + text;
+        }
+
+        // same as expected::function_which_returns_a_string_or_propagates_exceptions_without_leaks,
+        // the errors are returned instead of thrown, with the step where they happened
+        StringOrError function_which_returns_a_string_or_an_error(int choice_1, int choice_2)
+        {
+            if (choice_1 < 0)
+                return "-42";
+
+            std::stringstream result;
+
+            auto text1 = std::make_unique<char[]>(20 + 1);
+
+            function_which_promises_not_to_throw_any_exception(text1.get(), 20, static_cast<char>('0' + choice_1));
+            result << text1.get();
+
+            const auto step_1 = function_which_returns_a_string_or_an_error_sometime(choice_1, text1.get());
+            if (!step_1)
+                return Error{ajcf::Error{step_1.error()}.add_context("step 1")};
+            result << *step_1;
+
+            result << " Step 1 ok ";
+
+            auto text2 = std::vector<char>(20 + 1);
+
+            function_which_promises_not_to_throw_any_exception(text2.data(), 10, static_cast<char>('0' + choice_2));
+            result << text2.data();
+
+            const auto step_2 = function_which_returns_a_string_or_an_error_sometime(choice_2, text2.data());
+            if (!step_2)
+                return Error{ajcf::Error{step_2.error()}.add_context("step 2")};
+            result << *step_2;
+
+            result << " Step 2 ok ";
+
+            return result.str();
+        }
+
+        IntOrError function_which_takes_a_string_and_returns_an_int_or_an_error(const std::string& text) noexcept
+        {
+            return ajcf::parse_number<int>(text).map_error([](ajcf::ParseError error) { return ajcf::Error{error}; });
+        }
+
+        // no exception thrown, no exception_ptr (a dynamic allocation) and no rethrow to know the error
+        DoubleOrError function_which_chains_all_the_previous_functions(int choice_1, int choice_2)
+        {
+            return function_which_returns_a_string_or_an_error(choice_1, choice_2)
+                .and_then(function_which_takes_a_string_and_returns_an_int_or_an_error)
+                .map(expected::function_which_takes_an_int_and_returns_a_double);
+        }
+
+        TEST_CASE("expected with typed error codes", "[exceptions][error_code]")
+        {
+            {
+                const auto result = function_which_chains_all_the_previous_functions(1, 2);
+                REQUIRE(!result);
+                REQUIRE(result.error() == StepError::int_1234);
+                REQUIRE(result.error().to_string() == "step: 1234 (step 1)");
+            }
+
+            {
+                const auto result = function_which_chains_all_the_previous_functions(5, 2);
+                REQUIRE(!result);
+                REQUIRE(result.error() == StepError::run_time_error);
+                REQUIRE(std::string{result.error().context(0)} == "step 2");
+            }
+
+            {
+                const auto result = function_which_chains_all_the_previous_functions(5, 6);
+                REQUIRE(!result);
+                REQUIRE(std::string{result.error().category().name()} == "parse");
+            }
+
+            {
+                const auto result = function_which_chains_all_the_previous_functions(-1, 7);
+                REQUIRE(result);
+                REQUIRE(result.value() == Approx{-8.4});
+            }
+
+            // the existing functions which throw can be adapted
+            const auto adapted = [](int choice_1, int choice_2) {
+                return ajcf::invoke_catching(
+                    expected::function_which_returns_a_string_or_propagates_exceptions_without_leaks, choice_1,
+                    choice_2);
+            };
+
+            REQUIRE(adapted(2, 3).error() == ajcf::ExceptionError::other_runtime_error);
+            REQUIRE(adapted(4, 5).error() == ajcf::ExceptionError::other_runtime_error); // MyExceptionDerivedFromStd
+            REQUIRE(adapted(3, 4).error() == ajcf::ExceptionError::unknown_exception);  // MyException
+            REQUIRE(adapted(5, 6).has_value());
+        }
+
+    } // namespace error_codes
+
+    namespace benchmarks {
+
+        TEST_CASE("expected chains: std::exception_ptr vs typed error codes",
+                  "[exceptions][error_code][benchmark][!hide]")
+        {
+            constexpr int calls_count = 200'000;
+
+            // choice 2 fails at the first step (a std::runtime_error or StepError::run_time_error),
+            // choice -1 goes through all the steps
+            const auto print_nanoseconds_per_call = [&](const char* name, int failures_percent, auto&& chain) {
+                double best_seconds = 1e9;
+                std::size_t failures_count = 0;
+                for (int run = 0; run != 3; ++run)
+                {
+                    failures_count = 0;
+                    const auto start = std::chrono::steady_clock::now();
+                    for (int index = 0; index != calls_count; ++index)
+                        failures_count += chain(index % 100 < failures_percent ? 2 : -1) ? 0 : 1;
+                    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                    best_seconds = std::min(best_seconds, elapsed.count());
+                }
+                fmt::print("{:>3}% failures - {:<40} {:>8.1f} ns/call ({} failures)\n", failures_percent, name,
+                           best_seconds / calls_count * 1e9, failures_count);
+            };
+
+            for (const auto failures_percent : {0, 10, 100})
+            {
+                print_nanoseconds_per_call("std::exception_ptr, error text", failures_percent, [](int choice) {
+                    return expected::function_which_chains_all_the_previous_functions(choice, 7);
+                });
+                print_nanoseconds_per_call("ajcf::Error", failures_percent, [](int choice) {
+                    return error_codes::function_which_chains_all_the_previous_functions(choice, 7);
+                });
+                print_nanoseconds_per_call("ajcf::Error, error text", failures_percent, [](int choice) {
+                    return error_codes::function_which_chains_all_the_previous_functions(choice, 7)
+                        .map_error([](const ajcf::Error& error) { return error.to_string(); });
+                });
+            }
+        }
+
+        // Exception without any dynamic allocation of its own (std::runtime_error allocates its message)
+        struct Failure : std::exception
+        {
+            const char* what() const noexcept override
+            {
+                return "failure";
+            }
+        };
+
+        // Failure at the bottom of a hierarchy of Depth classes, caught as a std::exception
+        template <int Depth>
+        struct DerivedFailure : DerivedFailure<Depth - 1>
+        {
+        };
+
+        template <>
+        struct DerivedFailure<0> : Failure
+        {
+        };
+
+        // a destructor to run in each frame, like the RAII objects of real code
+        struct FrameGuard
+        {
+            int& destroyed_count;
+
+            ~FrameGuard()
+            {
+                ++destroyed_count;
+            }
+        };
+
+        AJCF_NOINLINE int throw_at_depth(int depth, int& destroyed_count)
+        {
+            FrameGuard guard{destroyed_count};
+            if (depth == 0)
+                throw Failure{};
+            return throw_at_depth(depth - 1, destroyed_count) + 1;
+        }
+
+        AJCF_NOINLINE tl::expected<int, int> fail_at_depth(int depth, int& destroyed_count)
+        {
+            FrameGuard guard{destroyed_count};
+            if (depth == 0)
+                return tl::make_unexpected(42);
+            return fail_at_depth(depth - 1, destroyed_count).map([](int value) { return value + 1; });
+        }
+
+        template <int Depth>
+        AJCF_NOINLINE int throw_derived()
+        {
+            throw DerivedFailure<Depth>{};
+        }
+
+        int catch_at_depth(int depth)
+        {
+            int destroyed_count = 0;
+            try
+            {
+                return throw_at_depth(depth, destroyed_count);
+            }
+            catch (const std::exception&)
+            {
+                return destroyed_count;
+            }
+        }
+
+        int expected_at_depth(int depth)
+        {
+            int destroyed_count = 0;
+            const auto result = fail_at_depth(depth, destroyed_count);
+            return result ? *result : result.error() + destroyed_count;
+        }
+
+        template <int Depth>
+        int catch_derived()
+        {
+            try
+            {
+                return throw_derived<Depth>();
+            }
+            catch (const std::exception& e)
+            {
+                return static_cast<int>(e.what()[0]);
+            }
+        }
+
+        int rethrow_and_catch(const std::exception_ptr& error)
+        {
+            try
+            {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception& e)
+            {
+                return static_cast<int>(e.what()[0]);
+            }
+        }
+
+        struct Percentiles
+        {
+            double p50;
+            double p90;
+            double p99;
+            double p999;
+            double max;
+        };
+
+        Percentiles percentiles(std::vector<double>& latencies)
+        {
+            std::sort(latencies.begin(), latencies.end());
+            const auto at = [&latencies](double fraction) {
+                return latencies[static_cast<std::size_t>(fraction * static_cast<double>(latencies.size() - 1))];
+            };
+            return {at(0.5), at(0.9), at(0.99), at(0.999), latencies.back()};
+        }
+
+        // Nanoseconds of each call, with the overhead of the clock (see the "clock only" line)
+        template <typename Operation>
+        std::vector<double> measure_latencies(std::size_t calls_count, Operation& operation)
+        {
+            std::vector<double> latencies(calls_count);
+            int total = 0;
+            for (auto& latency : latencies)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                total += operation();
+                latency = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            }
+            // so that the calls are not optimized out
+            static std::atomic<int> sink{0};
+            sink += total;
+            return latencies;
+        }
+
+        // The operation is called by threads_count threads at the same time: the unwinder of some standard
+        // libraries takes a global lock to find the unwind tables, the latencies then grow with the threads
+        template <typename Operation>
+        void print_latencies(const char* name, unsigned threads_count, Operation operation)
+        {
+            constexpr std::size_t calls_count = 20'000;
+
+            std::vector<std::vector<double>> thread_latencies(threads_count);
+            const auto start = std::chrono::steady_clock::now();
+            {
+                std::vector<std::thread> threads;
+                for (unsigned index = 0; index != threads_count; ++index)
+                {
+                    threads.emplace_back([&thread_latencies, index, operation]() mutable {
+                        thread_latencies[index] = measure_latencies(calls_count, operation);
+                    });
+                }
+                for (auto& thread : threads)
+                    thread.join();
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            std::vector<double> latencies;
+            for (const auto& latencies_of_thread : thread_latencies)
+                latencies.insert(latencies.end(), latencies_of_thread.begin(), latencies_of_thread.end());
+            const auto result = percentiles(latencies);
+            fmt::print("{:<40} {:>2} threads | ns: p50 {:>7.0f} p90 {:>7.0f} p99 {:>7.0f} p99.9 {:>7.0f} "
+                       "max {:>8.0f} | {:>6.2f} M calls/s\n",
+                       name, threads_count, result.p50, result.p90, result.p99, result.p999, result.max,
+                       static_cast<double>(latencies.size()) / elapsed.count() / 1e6);
+        }
+
+        TEST_CASE("cost of the exceptions: depth, hierarchy, std::exception_ptr, threads",
+                  "[exceptions][benchmark][!hide]")
+        {
+            const auto many_threads = std::max(4U, std::thread::hardware_concurrency());
+            const auto captured = std::make_exception_ptr(Failure{});
+
+            for (const auto threads_count : {1U, many_threads})
+            {
+                print_latencies("clock only", threads_count, [] { return 0; });
+
+                // the cost of the unwinding grows with the number of frames between the throw and the catch
+                print_latencies("throw/catch, depth 1", threads_count, [] { return catch_at_depth(1); });
+                print_latencies("throw/catch, depth 10", threads_count, [] { return catch_at_depth(10); });
+                print_latencies("throw/catch, depth 100", threads_count, [] { return catch_at_depth(100); });
+                print_latencies("tl::expected failure, depth 1", threads_count, [] { return expected_at_depth(1); });
+                print_latencies("tl::expected failure, depth 10", threads_count, [] { return expected_at_depth(10); });
+                print_latencies("tl::expected failure, depth 100", threads_count,
+                                [] { return expected_at_depth(100); });
+
+                // to match a handler, the type of the exception is compared to each of its base classes
+                print_latencies("throw/catch base, hierarchy of 1", threads_count, [] { return catch_derived<0>(); });
+                print_latencies("throw/catch base, hierarchy of 10", threads_count, [] { return catch_derived<10>(); });
+                print_latencies("throw/catch base, hierarchy of 50", threads_count, [] { return catch_derived<50>(); });
+
+                // like the errors of the expected chain with std::exception_ptr
+                print_latencies("std::make_exception_ptr", threads_count,
+                                [] { return std::make_exception_ptr(Failure{}) ? 1 : 0; });
+                print_latencies("throw/catch/std::current_exception", threads_count, [] {
+                    try
+                    {
+                        throw Failure{};
+                    }
+                    catch (...)
+                    {
+                        return std::current_exception() ? 1 : 0;
+                    }
+                });
+                print_latencies("std::rethrow_exception/catch", threads_count,
+                                [&captured] { return rethrow_and_catch(captured); });
+            }
+        }
+
+    } // namespace benchmarks
+
 } // namespace
@@ -0,0 +1,340 @@
+// https://en.wikipedia.org/wiki/Recursive_descent_parser
+// https://en.wikipedia.org/wiki/Register_machine
+// https://en.wikipedia.org/wiki/Constant_folding
+
+#include "expression.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    TEST_CASE("compiled expressions", "[function][expression]")
+    {
+        const auto expression = ajcf::CompiledExpression::compile("(price - discount) * quantity");
+
+        REQUIRE(expression.variables() == std::vector<std::string>{"price", "discount", "quantity"});
+        REQUIRE(expression.variable_index("quantity") == 2);
+        REQUIRE(expression.variable_index("tax") == std::string_view::npos);
+        REQUIRE(expression.evaluate({100, 20, 3}) == 240);
+        REQUIRE(expression.evaluate({7, 2, -1}) == -5);
+        REQUIRE(expression.disassemble() == "r3 = price - discount\n"
+                                            "r3 = r3 * quantity\n"
+                                            "return r3\n");
+
+        REQUIRE_THROWS_AS(expression.evaluate({1, 2}), std::invalid_argument);
+    }
+
+    TEST_CASE("compiled expressions: precedence and associativity", "[function][expression]")
+    {
+        const auto evaluate = [](std::string_view text) {
+            return ajcf::CompiledExpression::compile(text).evaluate({});
+        };
+
+        REQUIRE(evaluate("42") == 42);
+        REQUIRE(evaluate("2 + 3 * 4") == 14);
+        REQUIRE(evaluate("(2 + 3) * 4") == 20);
+        REQUIRE(evaluate("20 - 5 - 3") == 12);
+        REQUIRE(evaluate("100 / 10 / 5") == 2);
+        REQUIRE(evaluate("17 % 5 * 2") == 4);
+        REQUIRE(evaluate("-3 * -(2 + +1)") == 9);
+        REQUIRE(evaluate("((((7))))") == 7);
+        REQUIRE(evaluate("2147483647 + 1") == INT_MIN);
+
+        const auto expression = ajcf::CompiledExpression::compile("x * x - 2 * x * y + y * y + (1 + 2) * 3");
+
+        REQUIRE(expression.evaluate({5, 3}) == 4 + 9);
+        REQUIRE(expression.evaluate({-4, 6}) == 100 + 9);
+    }
+
+    TEST_CASE("compiled expressions: constant folding", "[function][expression]")
+    {
+        // (1 + 2) * 3 is computed by the compiler
+        const auto expression = ajcf::CompiledExpression::compile("a + (1 + 2) * 3");
+
+        REQUIRE(expression.instructions().size() == 1);
+        REQUIRE(expression.disassemble() == "r2 = a + 9\nreturn r2\n");
+
+        REQUIRE(ajcf::CompiledExpression::compile("(1 + 2) * 3").instructions().empty());
+        REQUIRE(ajcf::CompiledExpression::compile("(1 + 2) * 3").evaluate({}) == 9);
+    }
+
+    TEST_CASE("compiled expressions: errors", "[function][expression]")
+    {
+        for (const auto* const text : {"", "1 +", "(1 + 2", "1 + 2)", "3 $ 4", "1 2", "99999999999", "* 2"})
+        {
+            CAPTURE(text);
+            REQUIRE_THROWS_AS(ajcf::CompiledExpression::compile(text), std::invalid_argument);
+        }
+
+        REQUIRE_THROWS_AS(ajcf::CompiledExpression::compile(std::string(1000, '(') + "1" + std::string(1000, ')')),
+                          std::length_error);
+
+        // the divisions by zero are not folded, they fail at each evaluation
+        REQUIRE_THROWS_AS(ajcf::CompiledExpression::compile("1 / 0").evaluate({}), std::domain_error);
+        REQUIRE_THROWS_AS(ajcf::CompiledExpression::compile("x % y").evaluate({1, 0}), std::domain_error);
+        REQUIRE(ajcf::CompiledExpression::compile("x / y").evaluate({INT_MIN, -1}) == INT_MIN);
+    }
+
+    TEST_CASE("compiled expressions: batch evaluation", "[function][expression]")
+    {
+        const auto expression = ajcf::CompiledExpression::compile("(a - b) * c + a / 3 - 7 % c");
+
+        // several blocks and a last partial block
+        const std::size_t rows_count = 3 * ajcf::CompiledExpression::batch_block_size + 17;
+        std::vector<int> a(rows_count);
+        std::vector<int> b(rows_count);
+        std::vector<int> c(rows_count);
+        for (std::size_t row = 0; row != rows_count; ++row)
+        {
+            a[row] = static_cast<int>(row * 7 % 1000) - 500;
+            b[row] = static_cast<int>(row % 13);
+            c[row] = static_cast<int>(row % 5) + 1;
+        }
+
+        const std::vector<gsl::span<const int>> columns{a, b, c};
+        std::vector<int> results(rows_count);
+        expression.evaluate_batch(columns, results);
+
+        bool same_results = true;
+        for (std::size_t row = 0; row != rows_count; ++row)
+            same_results &= results[row] == expression.evaluate({a[row], b[row], c[row]});
+
+        REQUIRE(same_results);
+
+        // expressions without instructions
+        const std::vector<gsl::span<const int>> single_column{a};
+        ajcf::CompiledExpression::compile("a").evaluate_batch(single_column, results);
+
+        REQUIRE(results == a);
+
+        ajcf::CompiledExpression::compile("2 * 21").evaluate_batch({}, results);
+
+        REQUIRE(std::all_of(results.begin(), results.end(), [](int value) { return value == 42; }));
+
+        c[rows_count - 1] = 0;
+
+        REQUIRE_THROWS_AS(expression.evaluate_batch(columns, results), std::domain_error);
+        REQUIRE_THROWS_AS(expression.evaluate_batch(single_column, results), std::invalid_argument);
+        const gsl::span<int> too_few_results(results.data(), 10);
+
+        REQUIRE_THROWS_AS(expression.evaluate_batch(columns, too_few_results), std::invalid_argument);
+    }
+
+    TEST_CASE("compiled expressions: batch evaluation of a partial block with computed divisors",
+              "[function][expression]")
+    {
+        // the padding of the partial block gives b - 1 == 0 and b - c == 0, not the rows
+        const std::vector<int> a{10, 20, 30};
+        const std::vector<int> b{3, 3, 3};
+        const std::vector<int> c{1, 2, 4};
+        const std::vector<gsl::span<const int>> two_columns{a, b};
+        const std::vector<gsl::span<const int>> three_columns{a, b, c};
+        std::vector<int> results(a.size());
+
+        ajcf::CompiledExpression::compile("a / (b - 1)").evaluate_batch(two_columns, results);
+
+        REQUIRE(results == std::vector<int>{5, 10, 15});
+
+        const auto modulo = ajcf::CompiledExpression::compile("a % (b - c)");
+        modulo.evaluate_batch(three_columns, results);
+
+        REQUIRE(results == std::vector<int>{0, 0, 0});
+
+        // a real zero divisor
+        const std::vector<int> zero_divisor_c{1, 3, 4};
+        const std::vector<gsl::span<const int>> zero_divisor_columns{a, b, zero_divisor_c};
+
+        REQUIRE_THROWS_AS(modulo.evaluate_batch(zero_divisor_columns, results), std::domain_error);
+    }
+
+    TEST_CASE("expression cache", "[function][expression]")
+    {
+        ajcf::ExpressionCache cache;
+
+        const auto first = cache.get("a * b");
+        const auto second = cache.get(std::string("a * b"));
+
+        REQUIRE(first == second);
+        REQUIRE(cache.size() == 1);
+        REQUIRE(first->evaluate({6, 7}) == 42);
+
+        REQUIRE_THROWS_AS(cache.get("a *"), std::invalid_argument);
+        REQUIRE(cache.size() == 1);
+
+        // concurrent compilations of the same texts give the same compiled expressions
+        std::vector<std::thread> threads;
+        std::vector<std::shared_ptr<const ajcf::CompiledExpression>> results(4 * 10);
+        for (int t = 0; t != 4; ++t)
+        {
+            threads.emplace_back([&cache, &results, t] {
+                for (int i = 0; i != 10; ++i)
+                    results[static_cast<std::size_t>(t * 10 + i)] = cache.get(fmt::format("x + {}", i));
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        bool same_expressions = true;
+        for (int t = 0; t != 4; ++t)
+            for (int i = 0; i != 10; ++i)
+                same_expressions &=
+                    results[static_cast<std::size_t>(t * 10 + i)] == results[static_cast<std::size_t>(i)];
+
+        REQUIRE(same_expressions);
+        REQUIRE(cache.size() == 11);
+
+        cache.clear();
+
+        REQUIRE(cache.size() == 0);
+        REQUIRE(first->evaluate({6, 7}) == 42); // still owned by first
+    }
+
+    namespace benchmarks {
+
+        // same as demo_function_objects in function_objects.cpp: re-scan and re-parse the text at each call
+        int evaluate_by_reparsing(const std::string& expression)
+        {
+            const auto iter_operator = std::find_if(expression.begin(), expression.end(), [](char c) {
+                return c == '+' || c == '-' || c == '*' || c == '/';
+            });
+            const auto first_operand = std::stoi(expression.substr(0, iter_operator - expression.begin()));
+            const auto second_operand = std::stoi(expression.substr(iter_operator - expression.begin() + 1));
+            switch (*iter_operator)
+            {
+            case '+':
+                return first_operand + second_operand;
+            case '-':
+                return first_operand - second_operand;
+            case '*':
+                return first_operand * second_operand;
+            }
+            return first_operand / second_operand;
+        }
+
+        template <typename Function>
+        void print_evaluations_time(const char* name, long long evaluations_count, Function&& function)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            long long total = 0;
+            for (long long i = 0; i != evaluations_count; ++i)
+                total += function(static_cast<int>(i & 1023));
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            fmt::print("{:<44} {:>8.3f} s {:>8.2f} ns/evaluation (total {})\n", name, elapsed.count(),
+                       elapsed.count() * 1e9 / static_cast<double>(evaluations_count), total);
+        }
+
+        TEST_CASE("compiled expression vs re-parsing", "[function][expression][benchmark][!hide]")
+        {
+            const std::vector<std::string> texts = [] {
+                std::vector<std::string> result;
+                for (int i = 0; i != 1024; ++i)
+                    result.push_back(fmt::format("{}*78", i));
+                return result;
+            }();
+            const auto expression = ajcf::CompiledExpression::compile("x * 78");
+            ajcf::ExpressionCache cache;
+
+            // same evaluations: i * 78 for i in [0, 1024)
+            constexpr long long evaluations_count = 100'000'000;
+            print_evaluations_time("re-parsing (demo_function_objects)", evaluations_count,
+                                   [&](int i) { return evaluate_by_reparsing(texts[static_cast<std::size_t>(i)]); });
+            print_evaluations_time("compiling each time", evaluations_count / 10, [&](int i) {
+                return ajcf::CompiledExpression::compile(texts[static_cast<std::size_t>(i)]).evaluate({});
+            });
+            print_evaluations_time("cache lookup and evaluation", evaluations_count, [&](int i) {
+                return cache.get(texts[static_cast<std::size_t>(i)])->evaluate({});
+            });
+            print_evaluations_time("compiled once (with a variable)", evaluations_count,
+                                   [&](int i) { return expression.evaluate({i}); });
+
+            BENCHMARK("re-parsing")
+            {
+                return evaluate_by_reparsing(texts[42]);
+            };
+
+            BENCHMARK("compiled once")
+            {
+                return expression.evaluate({42});
+            };
+        }
+
+        TEST_CASE("batch evaluation vs evaluation per row", "[function][expression][benchmark][!hide]")
+        {
+            constexpr std::size_t rows_count = 10'000'000;
+            std::vector<int> a(rows_count);
+            std::vector<int> b(rows_count);
+            std::vector<int> c(rows_count);
+            for (std::size_t row = 0; row != rows_count; ++row)
+            {
+                a[row] = static_cast<int>(row % 1000);
+                b[row] = static_cast<int>(row % 7);
+                c[row] = static_cast<int>(row % 3) + 1;
+            }
+            std::vector<int> results(rows_count);
+
+            const auto print_rows_per_second = [&](const char* name, auto&& function) {
+                double best_seconds = 1e9;
+                for (int run = 0; run != 3; ++run)
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    function();
+                    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                    best_seconds = std::min(best_seconds, elapsed.count());
+                }
+                fmt::print("{:<52} {:>8.1f} M rows/s (checksum {})\n", name,
+                           static_cast<double>(rows_count) / best_seconds / 1e6,
+                           std::accumulate(results.begin(), results.end(), 0LL));
+            };
+
+            // like function_objects::compute(x, y, Operation{'*'}): a switch on the operator for each row
+            const auto compute = [](int x, int y, char operator_char) {
+                switch (operator_char)
+                {
+                case '+':
+                    return x + y;
+                case '-':
+                    return x - y;
+                case '*':
+                    return x * y;
+                case '/':
+                    return x / y;
+                }
+                throw std::runtime_error("Unsupported operation");
+            };
+            volatile char multiply = '*'; // not known by the compiler, like an operator parsed from a text
+            print_rows_per_second("a * b - Operation per row", [&] {
+                const char operator_char = multiply;
+                for (std::size_t row = 0; row != rows_count; ++row)
+                    results[row] = compute(a[row], b[row], operator_char);
+            });
+
+            const auto product = ajcf::CompiledExpression::compile("a * b");
+            print_rows_per_second("a * b - CompiledExpression::evaluate per row", [&] {
+                for (std::size_t row = 0; row != rows_count; ++row)
+                    results[row] = product.evaluate({a[row], b[row]});
+            });
+            const std::vector<gsl::span<const int>> two_columns{a, b};
+            print_rows_per_second("a * b - CompiledExpression::evaluate_batch",
+                                  [&] { product.evaluate_batch(two_columns, results); });
+
+            const auto formula = ajcf::CompiledExpression::compile("(a - b) * c + a * 3 - 7");
+            print_rows_per_second("(a - b) * c + a * 3 - 7 - evaluate per row", [&] {
+                for (std::size_t row = 0; row != rows_count; ++row)
+                    results[row] = formula.evaluate({a[row], b[row], c[row]});
+            });
+            const std::vector<gsl::span<const int>> three_columns{a, b, c};
+            print_rows_per_second("(a - b) * c + a * 3 - 7 - evaluate_batch",
+                                  [&] { formula.evaluate_batch(three_columns, results); });
+        }
+
+    } // namespace benchmarks
+
+} // namespace
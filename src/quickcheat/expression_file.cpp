@@ -0,0 +1,96 @@
+// https://en.cppreference.com/w/cpp/thread/packaged_task
+// https://en.cppreference.com/w/cpp/io/basic_istream/read
+// https://en.cppreference.com/w/cpp/thread/condition_variable
+
+#include "expression_file.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+    std::string evaluate_text(const std::string& text, const ajcf::ExpressionFileOptions& options = {})
+    {
+        std::istringstream input{text};
+        std::ostringstream output;
+        ajcf::evaluate_expression_file(input, output, options);
+        return output.str();
+    }
+
+    TEST_CASE("expression files", "[function][expression_file]")
+    {
+        std::istringstream input{"1 + 2\n(3 + 4) * 5\r\n\n  \n-7 % 4\n1 / 0\n2 * x\n(1 +\n6 * 7"};
+        std::ostringstream output;
+        const auto statistics = ajcf::evaluate_expression_file(input, output);
+
+        // one line per input line, the last line does not need a newline
+        const auto lines = output.str();
+
+        REQUIRE(lines.substr(0, lines.find("\nerror")) == "3\n35\n\n\n-3");
+        REQUIRE(std::count(lines.begin(), lines.end(), '\n') == 9);
+        REQUIRE(lines.substr(lines.rfind('\n', lines.size() - 2)) == "\n42\n");
+        REQUIRE(statistics.expressions_count == 7);
+        REQUIRE(statistics.errors_count == 3);
+        REQUIRE(statistics.bytes_count == input.str().size());
+    }
+
+    TEST_CASE("expression files: the results are in the input order", "[function][expression_file]")
+    {
+        std::ostringstream generated;
+        ajcf::generate_expression_file(generated, 100'000);
+        const auto text = generated.str();
+
+        REQUIRE(text.size() >= 100'000);
+        REQUIRE(text.back() == '\n');
+
+        // one thread and whole text in one chunk vs many small chunks evaluated by many threads
+        const auto expected = evaluate_text(text, {text.size(), 1});
+
+        bool same_results = true;
+        for (const auto chunk_size : {1, 7, 100, 4096})
+            same_results = same_results && evaluate_text(text, {static_cast<std::size_t>(chunk_size), 4}) == expected;
+
+        REQUIRE(same_results);
+        REQUIRE(expected.find("error: ") != std::string::npos); // divisions by zero
+
+        // lines longer than the chunks
+        REQUIRE(evaluate_text("1 + 2 + 3 + 4 + 5 + 6\n7\n", {4, 2}) == "21\n7\n");
+    }
+
+    namespace benchmarks {
+
+        TEST_CASE("expression file of 1 GB", "[function][expression_file][benchmark][!hide]")
+        {
+            const auto directory = std::filesystem::temp_directory_path();
+            const auto input_path = directory / "ajcf_expressions.txt";
+            const auto output_path = directory / "ajcf_expressions_results.txt";
+            {
+                std::ofstream input{input_path, std::ios::binary};
+                ajcf::generate_expression_file(input, std::size_t{1} << 30);
+            }
+
+            const auto print_statistics = [&](const char* name, const ajcf::ExpressionFileOptions& options) {
+                std::ifstream input{input_path, std::ios::binary};
+                std::ofstream output{output_path, std::ios::binary};
+                const auto statistics = ajcf::evaluate_expression_file(input, output, options);
+                fmt::print("{:<24} {:>8.1f} MB/s {:>8.2f} M expressions/s {:>6.2f} s ({} errors)\n", name,
+                           statistics.megabytes_per_second(), statistics.expressions_per_second() / 1e6,
+                           statistics.elapsed.count(), statistics.errors_count);
+            };
+
+            fmt::print("{} cores\n", std::thread::hardware_concurrency());
+            print_statistics("1 thread", {1 << 20, 1});
+            print_statistics("all cores", {});
+            print_statistics("all cores, 64 KB chunks", {1 << 16, 0});
+
+            std::filesystem::remove(input_path);
+            std::filesystem::remove(output_path);
+        }
+
+    } // namespace benchmarks
+
+} // namespace
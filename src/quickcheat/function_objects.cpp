@@ -1,16 +1,32 @@
 
 // https://en.cppreference.com/w/cpp/language/lambda
+// https://en.cppreference.com/w/cpp/utility/from_chars
 
+#include "character_table.hpp"
+#include "expression.hpp"
+#include "inline_function.hpp"
+#include "number_parsing.hpp"
+#include "tokenizer.hpp"
 #include <catch2/catch.hpp>
 #include <algorithm>
 #include <functional>
 #include <iostream>
-#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace {
 
+    // like std::stoi, but without exception for the valid operands, nor locale
+    // The spaces around the operand and a '+' are accepted, the characters after the number are not
+    int to_operand(std::string_view text)
+    {
+        const auto operand = ajcf::parse_number<int>(ajcf::trim_number(text));
+        if (!operand)
+            throw std::invalid_argument(std::string{"Invalid operand: "} + ajcf::to_string(operand.error()));
+        return *operand;
+    }
+
     namespace example_function_pointer {
 
         int add(int x, int y)
@@ -43,15 +59,28 @@ namespace {
 
         bool is_operator(char op)
         {
-            return op == '+' || op == '-' || op == '*' || op == '/' || op == '%';
+            // one load in a table computed at compile time, instead of comparisons
+            return ajcf::is_arithmetic_operator(op);
         }
 
-        std::map<char, FunctionReturningIntAndTakingTwoInts*> possible_operations = {
-            {'+', &add},
-            {'-', &sub},
-            {'*', &mul},
-            {'/', &div},
-        };
+        // instead of a std::map<char, FunctionReturningIntAndTakingTwoInts*> searched at each call,
+        // a table of 256 function pointers, one for each character, computed at compile time
+        constexpr auto possible_operations =
+            ajcf::make_character_table<FunctionReturningIntAndTakingTwoInts*>(
+                [](char c) -> FunctionReturningIntAndTakingTwoInts* {
+                    switch (c)
+                    {
+                    case '+':
+                        return &add;
+                    case '-':
+                        return &sub;
+                    case '*':
+                        return &mul;
+                    case '/':
+                        return &div;
+                    }
+                    return nullptr;
+                });
 
         int demo_function_pointers(std::string expression)
         {
@@ -60,16 +89,15 @@ namespace {
                 throw std::invalid_argument("No arithmetic operator in expression");
 
             const char operator_char = *iter_operator;
-            const auto iter_operation = possible_operations.find(operator_char);
-            if (iter_operation == possible_operations.end())
+            const auto operation = possible_operations[operator_char];
+            if (!operation)
                 throw std::invalid_argument("Operation not supported");
-            const auto operation = iter_operation->second;
 
             const auto text_first_operand = expression.substr(0, iter_operator - expression.begin());
-            const auto first_operand = std::stoi(text_first_operand);
+            const auto first_operand = to_operand(text_first_operand);
 
             const auto text_second_operand = expression.substr(iter_operator - expression.begin() + 1);
-            const auto second_operand = std::stoi(text_second_operand);
+            const auto second_operand = to_operand(text_second_operand);
 
             return compute(first_operand, second_operand, operation);
         }
@@ -81,35 +109,27 @@ namespace {
         class Operation
         {
         public:
-            Operation(char operator_char) : m_operator_char(operator_char)
+            // the function is found once, in the same table as the function pointers demo
+            Operation(char operator_char) : m_function(example_function_pointer::possible_operations[operator_char])
             {
             }
 
             int operator()(int x, int y) const
             {
-                switch (m_operator_char)
-                {
-                case '+':
-                    return x + y;
-                case '-':
-                    return x - y;
-                case '*':
-                    return x * y;
-                case '/':
-                    return x / y;
-                }
-                throw std::runtime_error("operation non supportee !!!");
+                if (!m_function)
+                    throw std::runtime_error("operation non supportee !!!");
+                return m_function(x, y);
             }
 
         private:
-            char m_operator_char;
+            example_function_pointer::FunctionReturningIntAndTakingTwoInts* m_function;
         };
 
         struct IsOperator
         {
             bool operator()(char operator_char) const
             {
-                return operator_char == '+' || operator_char == '-' || operator_char == '*' || operator_char == '/';
+                return example_function_pointer::possible_operations[operator_char] != nullptr;
             }
         };
 
@@ -128,10 +148,10 @@ namespace {
             const auto operator_char = *iter_operator;
 
             const auto text_first_operand = expression.substr(0, iter_operator - expression.begin());
-            const auto first_operand = std::stoi(text_first_operand);
+            const auto first_operand = to_operand(text_first_operand);
 
             const auto text_second_operand = expression.substr(iter_operator - expression.begin() + 1);
-            const auto second_operand = std::stoi(text_second_operand);
+            const auto second_operand = to_operand(text_second_operand);
 
             Operation operation{operator_char};
 
@@ -142,7 +162,9 @@ namespace {
 
     namespace lambdas {
 
-        int compute(int x, int y, std::function<int(int, int)> operation)
+        // std::function<int(int, int)> would also accept any callable, but it can allocate dynamic memory
+        // to copy the lambda, a reference to the callable is enough here
+        int compute(int x, int y, ajcf::FunctionRef<int(int, int)> operation)
         {
             const auto result = operation(x, y);
             return result;
@@ -151,7 +173,7 @@ namespace {
         int demo_lambdas(std::string expression)
         {
             const auto iter_operator = std::find_if(expression.begin(), expression.end(), [](const auto operator_char) {
-                return operator_char == '+' || operator_char == '-' || operator_char == '*' || operator_char == '/';
+                return example_function_pointer::possible_operations[operator_char] != nullptr;
             });
 
             if (iter_operator == expression.end())
@@ -160,36 +182,76 @@ namespace {
             const auto operator_char = *iter_operator;
 
             const auto text_first_operand = expression.substr(0, iter_operator - expression.begin());
-            const auto first_operand = std::stoi(text_first_operand);
+            const auto first_operand = to_operand(text_first_operand);
 
             const auto text_second_operand = expression.substr(iter_operator - expression.begin() + 1);
-            const auto second_operand = std::stoi(text_second_operand);
-
-            return compute(first_operand, second_operand, [operator_char](auto x, auto y) {
-                switch (operator_char)
-                {
-                case '+':
-                    return x + y;
-                case '-':
-                    return x - y;
-                case '*':
-                    return x * y;
-                case '/':
-                    return x / y;
-                }
-                throw std::runtime_error("Unsupported operation");
-            });
+            const auto second_operand = to_operand(text_second_operand);
+
+            const auto function = example_function_pointer::possible_operations[operator_char];
+            return compute(first_operand, second_operand, [function](auto x, auto y) { return function(x, y); });
         }
 
     } // namespace lambdas
 
+    namespace string_views {
+
+        // same as demo_function_objects, but the operands are views on the expression instead of new strings:
+        // no dynamic allocation at all
+        int demo_string_views(std::string_view expression)
+        {
+            const auto [text_first_operand, operator_char, text_second_operand] =
+                ajcf::split_once(expression, "+-*/");
+            if (operator_char == '\0')
+                throw std::invalid_argument("No arithmetic operator in expression");
+
+            const auto first_operand = to_operand(text_first_operand);
+            const auto second_operand = to_operand(text_second_operand);
+
+            return function_objects::compute(first_operand, second_operand, function_objects::Operation{operator_char});
+        }
+
+    } // namespace string_views
+
+    namespace bytecode {
+
+        // full expressions (precedence, parentheses, variables), compiled only at the first call with this text
+        int demo_bytecode(std::string_view expression)
+        {
+            static ajcf::ExpressionCache cache;
+            return cache.get(expression)->evaluate({});
+        }
+
+    } // namespace bytecode
+
     TEST_CASE("function pointers, function objects, lambda expressions", "[function][pointer][lambda]")
     {
         REQUIRE(example_function_pointer::demo_function_pointers("23+48") == 71);
+        REQUIRE(example_function_pointer::demo_function_pointers("23 + 48") == 71);
+        REQUIRE(example_function_pointer::demo_function_pointers("23*+2") == 46);
+        REQUIRE_THROWS_AS(example_function_pointer::demo_function_pointers("12abc+1"), std::invalid_argument);
 
         REQUIRE(function_objects::demo_function_objects("12*78") == 936);
 
         REQUIRE(lambdas::demo_lambdas("95/5") == 19);
+
+        REQUIRE(string_views::demo_string_views("64-22") == 42);
+
+        REQUIRE(bytecode::demo_bytecode("(12 + 3) * 78 / 2") == 585);
+
+        // compiled once, evaluated for many values
+        const auto price_with_tax = ajcf::CompiledExpression::compile("price + price * tax_percent / 100");
+
+        REQUIRE(price_with_tax.evaluate({200, 20}) == 240);
+        REQUIRE(price_with_tax.evaluate({50, 10}) == 55);
+
+        // or for many rows at once, a column for each variable
+        const std::vector<int> prices{200, 50, 10};
+        const std::vector<int> taxes_percent{20, 10, 50};
+        const std::vector<gsl::span<const int>> columns{prices, taxes_percent};
+        std::vector<int> prices_with_tax(3);
+        price_with_tax.evaluate_batch(columns, prices_with_tax);
+
+        REQUIRE(prices_with_tax == std::vector<int>{240, 55, 15});
     }
 
     namespace more_examples {
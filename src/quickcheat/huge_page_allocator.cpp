@@ -0,0 +1,284 @@
+// https://www.kernel.org/doc/html/latest/admin-guide/mm/transhuge.html
+// https://man7.org/linux/man-pages/man2/mmap.2.html
+// https://man7.org/linux/man-pages/man2/madvise.2.html
+
+#include "huge_page_allocator.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define AJCF_HUGE_PAGES_USE_MMAP 1
+#endif
+
+namespace ajcf::huge_pages {
+
+    namespace {
+
+#if defined(AJCF_HUGE_PAGES_USE_MMAP)
+        std::size_t page_size() noexcept
+        {
+            static const auto size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            return size;
+        }
+
+        std::size_t mapped_size(std::size_t bytes) noexcept
+        {
+            return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+        }
+
+        void touch_each_page(char* buffer, std::size_t bytes) noexcept
+        {
+            const auto step = page_size();
+            for (std::size_t offset = 0; offset < bytes; offset += step)
+                static_cast<volatile char*>(buffer)[offset] = 0;
+        }
+
+        void* map_buffer(std::size_t bytes, const Options& options)
+        {
+            // Map one more huge page, then unmap the unaligned head and tail,
+            // so that the buffer starts on a huge page boundary and can be covered entirely by huge pages
+            const auto size = mapped_size(bytes);
+            void* const mapping =
+                ::mmap(nullptr, size + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping == MAP_FAILED)
+                throw std::bad_alloc();
+
+            const auto address = reinterpret_cast<std::uintptr_t>(mapping);
+            const auto aligned_address = (address + huge_page_size - 1) & ~(std::uintptr_t{huge_page_size} - 1);
+            const auto head_size = aligned_address - address;
+            if (head_size != 0)
+                ::munmap(mapping, head_size);
+            ::munmap(reinterpret_cast<char*>(aligned_address) + size, huge_page_size - head_size);
+
+            char* const buffer = reinterpret_cast<char*>(aligned_address);
+
+            // fails if transparent huge pages are disabled: the buffer then simply uses normal pages
+            if (options.use_huge_pages)
+                ::madvise(buffer, size, MADV_HUGEPAGE);
+            else
+                ::madvise(buffer, size, MADV_NOHUGEPAGE);
+
+            switch (options.prefault)
+            {
+            case Prefault::none:
+                break;
+            case Prefault::populate:
+#if defined(MADV_POPULATE_WRITE)
+                if (::madvise(buffer, size, MADV_POPULATE_WRITE) == 0)
+                    break;
+#endif
+                // kernel older than 5.14: populate by hand
+                touch_each_page(buffer, size);
+                break;
+            case Prefault::touch:
+                touch_each_page(buffer, size);
+                break;
+            }
+
+            return buffer;
+        }
+#endif
+
+    } // namespace
+
+    void* allocate(std::size_t bytes, const Options& options)
+    {
+#if defined(AJCF_HUGE_PAGES_USE_MMAP)
+        if (bytes >= min_mapped_size)
+            return map_buffer(bytes, options);
+#endif
+        void* const buffer = std::calloc(1, bytes == 0 ? 1 : bytes);
+        if (!buffer)
+            throw std::bad_alloc();
+        return buffer;
+    }
+
+    void deallocate(void* buffer, std::size_t bytes) noexcept
+    {
+        if (!buffer)
+            return;
+#if defined(AJCF_HUGE_PAGES_USE_MMAP)
+        if (bytes >= min_mapped_size)
+        {
+            ::munmap(buffer, mapped_size(bytes));
+            return;
+        }
+#endif
+        std::free(buffer);
+    }
+
+    std::size_t anonymous_huge_pages_bytes()
+    {
+#if defined(__linux__)
+        // sum of the lines "AnonHugePages:    2048 kB"
+        std::ifstream smaps{"/proc/self/smaps_rollup"};
+        if (!smaps)
+            smaps.open("/proc/self/smaps");
+        std::size_t total_kib = 0;
+        std::string line;
+        while (std::getline(smaps, line))
+        {
+            if (line.compare(0, 14, "AnonHugePages:") != 0)
+                continue;
+            std::istringstream fields{line.substr(14)};
+            std::size_t kib{};
+            if (fields >> kib)
+                total_kib += kib;
+        }
+        return total_kib * 1024;
+#else
+        return 0;
+#endif
+    }
+
+} // namespace ajcf::huge_pages
+
+namespace {
+
+    struct S
+    {
+        S() = default;
+        S(int i, int j) : i(i), j(j)
+        {
+        }
+
+        int i{0};
+        int j{0};
+    };
+
+    TEST_CASE("huge page buffers", "[hugepages][allocation]")
+    {
+        constexpr std::size_t bytes = 3 * ajcf::huge_pages::huge_page_size + 123;
+
+        for (const auto prefault : {ajcf::huge_pages::Prefault::none, ajcf::huge_pages::Prefault::populate,
+                                    ajcf::huge_pages::Prefault::touch})
+        {
+            auto* const buffer = static_cast<unsigned char*>(ajcf::huge_pages::allocate(bytes, {true, prefault}));
+
+#if defined(__linux__)
+            REQUIRE(reinterpret_cast<std::uintptr_t>(buffer) % ajcf::huge_pages::huge_page_size == 0);
+#endif
+            REQUIRE(buffer[0] == 0);
+            REQUIRE(buffer[bytes - 1] == 0);
+
+            buffer[0] = 1;
+            buffer[bytes - 1] = 2;
+
+            REQUIRE(buffer[0] == 1);
+            REQUIRE(buffer[bytes - 1] == 2);
+
+            ajcf::huge_pages::deallocate(buffer, bytes);
+        }
+
+        // small buffers are simply allocated on the heap
+        auto* const small_buffer = static_cast<unsigned char*>(ajcf::huge_pages::allocate(100));
+        REQUIRE(small_buffer[99] == 0);
+        ajcf::huge_pages::deallocate(small_buffer, 100);
+    }
+
+    TEST_CASE("huge page arrays", "[hugepages][allocation]")
+    {
+        // same as std::make_unique<S[]>(count)
+        const std::size_t count = 1'000'000;
+        ajcf::unique_huge_page_array<S> p = ajcf::make_unique_huge_page_array<S>(count);
+
+        REQUIRE(p[3].i == 0);
+        REQUIRE(p[3].j == 0);
+        REQUIRE(p[count - 1].j == 0);
+
+        p[count - 1] = S{1, 2};
+
+        REQUIRE(p[count - 1].i == 1);
+        REQUIRE(p.get_deleter().count() == count);
+
+        std::vector<double, ajcf::HugePageAllocator<double>> values(count, 1.5);
+        values.push_back(2.5);
+
+        REQUIRE(values[count - 1] == Approx(1.5));
+        REQUIRE(values[count] == Approx(2.5));
+    }
+
+    namespace benchmarks {
+
+        // Multi-gigabyte arrays do not fit in the TLB's reach with 4 KiB pages:
+        // random accesses then cost a page walk each time
+        // The size can be changed with the environment variable AJCF_HUGE_PAGES_BENCHMARK_MIB
+        std::size_t benchmark_array_bytes()
+        {
+            if (const char* const mib = std::getenv("AJCF_HUGE_PAGES_BENCHMARK_MIB"))
+                return std::strtoull(mib, nullptr, 10) * 1024 * 1024;
+            return std::size_t{2} * 1024 * 1024 * 1024;
+        }
+
+        std::uint64_t random_accesses(const std::uint64_t* values, std::size_t count, std::size_t accesses_count)
+        {
+            // xorshift pseudo-random indexes: cheap enough not to hide the memory latency
+            std::uint64_t state = 0x9E3779B97F4A7C15ULL;
+            std::uint64_t sum = 0;
+            for (std::size_t access = 0; access != accesses_count; ++access)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                sum += values[state % count];
+            }
+            return sum;
+        }
+
+        TEST_CASE("huge pages vs normal pages: random accesses over a big array",
+                  "[hugepages][allocation][benchmark][!hide]")
+        {
+            const auto bytes = benchmark_array_bytes();
+            const auto count = bytes / sizeof(std::uint64_t);
+            constexpr std::size_t accesses_count = 10'000'000;
+
+            for (const bool use_huge_pages : {false, true})
+            {
+                const auto huge_pages_before = ajcf::huge_pages::anonymous_huge_pages_bytes();
+                const auto values = ajcf::make_unique_huge_page_array<std::uint64_t>(
+                    count, {use_huge_pages, ajcf::huge_pages::Prefault::populate});
+                const auto huge_pages_after = ajcf::huge_pages::anonymous_huge_pages_bytes();
+
+                fmt::print("{} MiB array {} huge pages: {} MiB backed by huge pages\n", bytes / (1024 * 1024),
+                           use_huge_pages ? "with" : "without", (huge_pages_after - huge_pages_before) / (1024 * 1024));
+
+                BENCHMARK(fmt::format("10M random accesses - {}", use_huge_pages ? "huge pages" : "normal pages"))
+                {
+                    return random_accesses(values.get(), count, accesses_count);
+                };
+            }
+        }
+
+        TEST_CASE("huge pages vs normal pages: prefaulting", "[hugepages][allocation][benchmark][!hide]")
+        {
+            const auto bytes = benchmark_array_bytes() / 4;
+
+            for (const bool use_huge_pages : {false, true})
+            {
+                for (const auto prefault : {ajcf::huge_pages::Prefault::populate, ajcf::huge_pages::Prefault::touch})
+                {
+                    const auto name =
+                        fmt::format("map and prefault {} MiB - {} - {}", bytes / (1024 * 1024),
+                                    use_huge_pages ? "huge pages" : "normal pages",
+                                    prefault == ajcf::huge_pages::Prefault::populate ? "populate" : "touch");
+                    BENCHMARK(std::string{name})
+                    {
+                        void* const buffer = ajcf::huge_pages::allocate(bytes, {use_huge_pages, prefault});
+                        ajcf::huge_pages::deallocate(buffer, bytes);
+                        return buffer;
+                    };
+                }
+            }
+        }
+
+    } // namespace benchmarks
+
+} // namespace
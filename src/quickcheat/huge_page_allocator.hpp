@@ -0,0 +1,175 @@
+// https://www.kernel.org/doc/html/latest/admin-guide/mm/transhuge.html
+// https://man7.org/linux/man-pages/man2/madvise.2.html
+// https://en.cppreference.com/w/cpp/memory/unique_ptr
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace ajcf {
+
+    // Allocation of big buffers backed by huge pages (2 MiB instead of 4 KiB on x86-64),
+    // so that random accesses over gigabytes of memory need much less TLB entries
+    // On Linux, the buffer is mapped with mmap, aligned on a huge page, then advised with MADV_HUGEPAGE
+    // (transparent huge pages); if the kernel refuses, the buffer silently falls back to normal pages
+    // On other systems, or for small buffers, the buffer is allocated with std::calloc
+    namespace huge_pages {
+
+        constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+        // Smaller buffers are not worth a dedicated mapping
+        constexpr std::size_t min_mapped_size = huge_page_size;
+
+        enum class Prefault
+        {
+            none,     // pages are allocated on first access (page faults spread over the computation)
+            populate, // pages are allocated by the kernel just after mapping (MADV_POPULATE_WRITE)
+            touch,    // pages are allocated by writing one byte in each page just after mapping
+        };
+
+        struct Options
+        {
+            bool use_huge_pages{true};
+            Prefault prefault{Prefault::none};
+        };
+
+        inline bool operator==(const Options& left, const Options& right) noexcept
+        {
+            return left.use_huge_pages == right.use_huge_pages && left.prefault == right.prefault;
+        }
+
+        inline bool operator!=(const Options& left, const Options& right) noexcept
+        {
+            return !(left == right);
+        }
+
+        // Allocate a zero-initialized buffer of at least bytes bytes, aligned on huge_page_size if it is big enough
+        // Throw std::bad_alloc if no memory is available
+        void* allocate(std::size_t bytes, const Options& options = {});
+
+        // Deallocate a buffer previously returned by allocate(bytes), with the same size
+        void deallocate(void* buffer, std::size_t bytes) noexcept;
+
+        // Number of bytes of the process currently backed by transparent huge pages (0 if unknown)
+        std::size_t anonymous_huge_pages_bytes();
+
+    } // namespace huge_pages
+
+    // Standard allocator for containers of big arrays:
+    //   std::vector<double, ajcf::HugePageAllocator<double>> values(1'000'000'000);
+    template <typename T>
+    class HugePageAllocator
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+
+    public:
+        using value_type = T;
+
+        HugePageAllocator() = default;
+
+        explicit HugePageAllocator(const huge_pages::Options& options) noexcept : m_options(options)
+        {
+        }
+
+        template <typename U>
+        HugePageAllocator(const HugePageAllocator<U>& other) noexcept : m_options(other.options())
+        {
+        }
+
+        const huge_pages::Options& options() const noexcept
+        {
+            return m_options;
+        }
+
+        T* allocate(std::size_t n)
+        {
+            if (n > static_cast<std::size_t>(-1) / sizeof(T))
+                throw std::bad_array_new_length();
+            return static_cast<T*>(huge_pages::allocate(n * sizeof(T), m_options));
+        }
+
+        void deallocate(T* pointer, std::size_t n) noexcept
+        {
+            huge_pages::deallocate(pointer, n * sizeof(T));
+        }
+
+        template <typename U>
+        bool operator==(const HugePageAllocator<U>&) const noexcept
+        {
+            // any allocator can deallocate the buffers of any other
+            return true;
+        }
+
+        template <typename U>
+        bool operator!=(const HugePageAllocator<U>&) const noexcept
+        {
+            return false;
+        }
+
+    private:
+        huge_pages::Options m_options{};
+    };
+
+    // Deleter of an array allocated by make_unique_huge_page_array
+    template <typename T>
+    class HugePageArrayDeleter
+    {
+    public:
+        HugePageArrayDeleter() = default;
+
+        explicit HugePageArrayDeleter(std::size_t count) noexcept : m_count(count)
+        {
+        }
+
+        std::size_t count() const noexcept
+        {
+            return m_count;
+        }
+
+        void operator()(T* pointer) const noexcept
+        {
+            std::destroy_n(pointer, m_count);
+            huge_pages::deallocate(pointer, m_count * sizeof(T));
+        }
+
+    private:
+        std::size_t m_count{};
+    };
+
+    template <typename T>
+    using unique_huge_page_array = std::unique_ptr<T[], HugePageArrayDeleter<T>>;
+
+    // Equivalent to std::make_unique<T[]>(count), with the array backed by huge pages
+    template <typename T>
+    unique_huge_page_array<T> make_unique_huge_page_array(std::size_t count, const huge_pages::Options& options = {})
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+
+        if (count > static_cast<std::size_t>(-1) / sizeof(T))
+            throw std::bad_array_new_length();
+
+        T* const pointer = static_cast<T*>(huge_pages::allocate(count * sizeof(T), options));
+        if constexpr (!std::is_trivially_default_constructible_v<T>)
+        {
+            std::size_t constructed_count = 0;
+            try
+            {
+                for (; constructed_count != count; ++constructed_count)
+                    ::new (static_cast<void*>(pointer + constructed_count)) T();
+            }
+            catch (...)
+            {
+                std::destroy_n(pointer, constructed_count);
+                huge_pages::deallocate(pointer, count * sizeof(T));
+                throw;
+            }
+        }
+        // note: trivial types are value-initialized for free, because the buffer is zero-initialized
+
+        return unique_huge_page_array<T>(pointer, HugePageArrayDeleter<T>(count));
+    }
+
+} // namespace ajcf
@@ -0,0 +1,272 @@
+// https://en.cppreference.com/w/cpp/utility/functional/function
+// https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2019/p0792r5.html (function_ref)
+
+#include "inline_function.hpp"
+#include "allocation_counter.hpp"
+#include "noinline.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace {
+
+    int add(int x, int y)
+    {
+        return x + y;
+    }
+
+    int compute(int x, int y, ajcf::FunctionRef<int(int, int)> operation)
+    {
+        return operation(x, y);
+    }
+
+    TEST_CASE("function references", "[function][function_ref]")
+    {
+        ajcf::AllocationCounter counter;
+
+        REQUIRE(compute(23, 48, add) == 71);
+        REQUIRE(compute(23, 48, &add) == 71);
+        REQUIRE(compute(12, 78, std::multiplies<>{}) == 936);
+
+        // the captures are not copied: the reference sees the changes
+        int factor = 2;
+        const auto scaled = [&factor](int x, int y) { return factor * (x + y); };
+        const ajcf::FunctionRef<int(int, int)> reference = scaled;
+
+        REQUIRE(reference(1, 2) == 6);
+
+        factor = 10;
+
+        REQUIRE(reference(1, 2) == 30);
+
+        // a big capture does not need any dynamic allocation
+        const std::array<int, 100> weights{1, 2, 3};
+        REQUIRE(compute(1, 1, [weights](int x, int y) { return weights[0] * x + weights[2] * y; }) == 4);
+        REQUIRE(counter.allocations() == 0);
+    }
+
+    TEST_CASE("inline functions", "[function][function_ref]")
+    {
+        ajcf::AllocationCounter counter;
+
+        ajcf::InlineFunction<int(int, int)> operation;
+
+        REQUIRE(!operation);
+        REQUIRE_THROWS_AS(operation(1, 2), std::bad_function_call);
+
+        operation = &add;
+
+        REQUIRE(operation(23, 48) == 71);
+
+        // the captures are copied inside the object
+        int factor = 2;
+        operation = [factor](int x, int y) { return factor * (x + y); };
+        factor = 10;
+
+        REQUIRE(operation(1, 2) == 6);
+
+        // copyable like std::function, the moved from function is empty
+        auto copy = operation;
+        auto moved = std::move(operation);
+
+        REQUIRE(copy(1, 2) == 6);
+        REQUIRE(moved(1, 2) == 6);
+        REQUIRE(!operation);
+
+        // bigger captures need a bigger size (if not: compilation error)
+        const std::array<int, 10> weights{1, 2, 3};
+        ajcf::InlineFunction<int(int), sizeof(weights)> weighted = [weights](int x) { return weights[2] * x; };
+
+        REQUIRE(weighted(5) == 15);
+        REQUIRE(counter.allocations() == 0);
+
+        // a mutable lambda keeps its state between the calls
+        ajcf::InlineFunction<int()> next_id = [id = 0]() mutable { return ++id; };
+        next_id();
+
+        REQUIRE(next_id() == 2);
+
+        operation = nullptr;
+
+        REQUIRE(!operation);
+    }
+
+    TEST_CASE("inline functions destroy their callables", "[function][function_ref]")
+    {
+        const auto counter = std::make_shared<int>(0);
+        {
+            ajcf::InlineFunction<long()> function = [counter] { return counter.use_count(); };
+
+            REQUIRE(function() == 2);
+
+            auto copy = function;
+
+            REQUIRE(counter.use_count() == 3);
+
+            copy = [] { return 0L; };
+
+            REQUIRE(counter.use_count() == 2);
+        }
+
+        REQUIRE(counter.use_count() == 1);
+    }
+
+    namespace benchmarks {
+
+        int mul(int x, int y)
+        {
+            return x * y;
+        }
+
+        // like function_objects::Operation
+        class Operation
+        {
+        public:
+            Operation(char operator_char) : m_operator_char(operator_char)
+            {
+            }
+
+            int operator()(int x, int y) const
+            {
+                switch (m_operator_char)
+                {
+                case '+':
+                    return x + y;
+                case '-':
+                    return x - y;
+                case '*':
+                    return x * y;
+                case '/':
+                    return x / y;
+                }
+                throw std::runtime_error("Unsupported operation");
+            }
+
+        private:
+            char m_operator_char;
+        };
+
+        // the compute functions are not inlined, so that the callable is not known at the call
+        AJCF_NOINLINE int compute_function_pointer(int x, int y, int (*operation)(int, int))
+        {
+            return operation(x, y);
+        }
+
+        AJCF_NOINLINE int compute_operation(int x, int y, Operation operation)
+        {
+            return operation(x, y);
+        }
+
+        AJCF_NOINLINE int compute_std_function(int x, int y, const std::function<int(int, int)>& operation)
+        {
+            return operation(x, y);
+        }
+
+        AJCF_NOINLINE int compute_function_ref(int x, int y, ajcf::FunctionRef<int(int, int)> operation)
+        {
+            return operation(x, y);
+        }
+
+        AJCF_NOINLINE int compute_inline_function(int x, int y, const ajcf::InlineFunction<int(int, int)>& operation)
+        {
+            return operation(x, y);
+        }
+
+        AJCF_NOINLINE int compute_big_inline_function(int x, int y,
+                                                      const ajcf::InlineFunction<int(int, int), 32>& operation)
+        {
+            return operation(x, y);
+        }
+
+        TEST_CASE("call overhead of function pointers, functors, std::function, FunctionRef and InlineFunction",
+                  "[function][function_ref][benchmark][!hide]")
+        {
+            constexpr int calls_count = 1000;
+            int factor = 3;
+            const auto lambda = [factor](int x, int y) { return factor * x * y; };
+            // a capture bigger than the small buffer of std::function
+            const std::array<int, 8> factors{3, 1, 4, 1, 5, 9, 2, 6};
+            const auto big_lambda = [factors](int x, int y) { return factors[0] * x * y; };
+
+            BENCHMARK("function pointer")
+            {
+                int total = 0;
+                for (int i = 0; i != calls_count; ++i)
+                    total += compute_function_pointer(i, 3, &mul);
+                return total;
+            };
+
+            BENCHMARK("Operation functor")
+            {
+                int total = 0;
+                for (int i = 0; i != calls_count; ++i)
+                    total += compute_operation(i, 3, Operation{'*'});
+                return total;
+            };
+
+            BENCHMARK("std::function")
+            {
+                const std::function<int(int, int)> operation = lambda;
+                int total = 0;
+                for (int i = 0; i != calls_count; ++i)
+                    total += compute_std_function(i, 3, operation);
+                return total;
+            };
+
+            BENCHMARK("ajcf::FunctionRef")
+            {
+                int total = 0;
+                for (int i = 0; i != calls_count; ++i)
+                    total += compute_function_ref(i, 3, lambda);
+                return total;
+            };
+
+            BENCHMARK("ajcf::InlineFunction")
+            {
+                const ajcf::InlineFunction<int(int, int)> operation = lambda;
+                int total = 0;
+                for (int i = 0; i != calls_count; ++i)
+                    total += compute_inline_function(i, 3, operation);
+                return total;
+            };
+
+            // creating the callable at each call, like lambdas::compute does
+            BENCHMARK("std::function created at each call, big capture")
+            {
+                int total = 0;
+                for (int i = 0; i != calls_count; ++i)
+                    total += compute_std_function(i, 3, big_lambda);
+                return total;
+            };
+
+            BENCHMARK("ajcf::FunctionRef created at each call, big capture")
+            {
+                int total = 0;
+                for (int i = 0; i != calls_count; ++i)
+                    total += compute_function_ref(i, 3, big_lambda);
+                return total;
+            };
+
+            BENCHMARK("ajcf::InlineFunction created at each call, big capture")
+            {
+                int total = 0;
+                for (int i = 0; i != calls_count; ++i)
+                    total += compute_big_inline_function(i, 3, big_lambda);
+                return total;
+            };
+
+            ajcf::AllocationCounter counter;
+            compute_std_function(1, 3, big_lambda);
+            const auto std_function_allocations = counter.allocations();
+            compute_function_ref(1, 3, big_lambda);
+            compute_big_inline_function(1, 3, big_lambda);
+            fmt::print("allocations for one call: std::function {}, FunctionRef and InlineFunction {}\n",
+                       std_function_allocations, counter.allocations() - std_function_allocations);
+        }
+
+    } // namespace benchmarks
+
+} // namespace
@@ -0,0 +1,210 @@
+// https://en.cppreference.com/w/cpp/utility/functional/function
+// https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2019/p0792r5.html (function_ref)
+// https://en.cppreference.com/w/cpp/utility/functional/invoke
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ajcf {
+
+    template <typename Signature>
+    class FunctionRef;
+
+    // Non-owning reference to a callable, a replacement of std::function for the parameters:
+    // two pointers, no dynamic allocation, no copy of the callable
+    // The callable must live longer than the reference (like for std::string_view)
+    //   int compute(int x, int y, ajcf::FunctionRef<int(int, int)> operation);
+    //   compute(12, 78, [factor](int x, int y) { return factor * x * y; });
+    template <typename Result, typename... Args>
+    class FunctionRef<Result(Args...)>
+    {
+    public:
+        // Functions are referenced by their address, which lives as long as the program
+        FunctionRef(Result (*function)(Args...)) noexcept : m_call(&call_function)
+        {
+            m_target.function = reinterpret_cast<void (*)()>(function);
+        }
+
+        template <typename Callable,
+                  std::enable_if_t<!std::is_same_v<std::decay_t<Callable>, FunctionRef> &&
+                                       !std::is_function_v<std::remove_reference_t<Callable>> &&
+                                       std::is_invocable_r_v<Result, Callable&, Args...>,
+                                   int> = 0>
+        FunctionRef(Callable&& callable) noexcept : m_call(&call_object<std::remove_reference_t<Callable>>)
+        {
+            m_target.object = const_cast<void*>(static_cast<const void*>(std::addressof(callable)));
+        }
+
+        Result operator()(Args... args) const
+        {
+            return m_call(m_target, std::forward<Args>(args)...);
+        }
+
+    private:
+        union Target
+        {
+            void* object;
+            void (*function)();
+        };
+
+        static Result call_function(Target target, Args... args)
+        {
+            return reinterpret_cast<Result (*)(Args...)>(target.function)(std::forward<Args>(args)...);
+        }
+
+        template <typename Callable>
+        static Result call_object(Target target, Args... args)
+        {
+            return std::invoke(*static_cast<Callable*>(target.object), std::forward<Args>(args)...);
+        }
+
+        Target m_target;
+        Result (*m_call)(Target, Args...);
+    };
+
+    template <typename Signature, std::size_t Size = 3 * sizeof(void*)>
+    class InlineFunction;
+
+    // Owning callable stored inside the object, a replacement of std::function which never allocates:
+    // a callable bigger than Size bytes is a compilation error, not a dynamic allocation
+    // Like std::function, it is copyable and calling an empty InlineFunction throws std::bad_function_call
+    //   ajcf::InlineFunction<int(int, int)> operation = [factor](int x, int y) { return factor * x * y; };
+    //   ajcf::InlineFunction<void(), 64> task = [big_capture] { ... };
+    template <typename Result, typename... Args, std::size_t Size>
+    class InlineFunction<Result(Args...), Size>
+    {
+    public:
+        static constexpr std::size_t size = Size;
+
+        InlineFunction() noexcept = default;
+
+        InlineFunction(std::nullptr_t) noexcept
+        {
+        }
+
+        template <typename Callable,
+                  std::enable_if_t<!std::is_same_v<std::decay_t<Callable>, InlineFunction> &&
+                                       std::is_invocable_r_v<Result, std::decay_t<Callable>&, Args...>,
+                                   int> = 0>
+        InlineFunction(Callable&& callable)
+        {
+            using Stored = std::decay_t<Callable>;
+            static_assert(sizeof(Stored) <= Size, "the callable does not fit in the InlineFunction, increase its Size");
+            static_assert(alignof(Stored) <= alignof(std::max_align_t), "the callable is over-aligned");
+            static_assert(std::is_copy_constructible_v<Stored>, "the callable must be copyable");
+            static_assert(std::is_nothrow_move_constructible_v<Stored>, "the callable must be nothrow movable");
+
+            ::new (static_cast<void*>(&m_storage)) Stored(std::forward<Callable>(callable));
+            m_operations = &operations_of<Stored>;
+        }
+
+        InlineFunction(const InlineFunction& other)
+        {
+            if (other.m_operations)
+            {
+                other.m_operations->copy(&m_storage, &other.m_storage);
+                m_operations = other.m_operations;
+            }
+        }
+
+        // The moved from function is left empty
+        InlineFunction(InlineFunction&& other) noexcept
+        {
+            if (other.m_operations)
+            {
+                other.m_operations->move(&m_storage, &other.m_storage);
+                m_operations = std::exchange(other.m_operations, nullptr);
+            }
+        }
+
+        InlineFunction& operator=(const InlineFunction& other)
+        {
+            if (this != &other)
+            {
+                InlineFunction copy{other};
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        InlineFunction& operator=(InlineFunction&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                if (other.m_operations)
+                {
+                    other.m_operations->move(&m_storage, &other.m_storage);
+                    m_operations = std::exchange(other.m_operations, nullptr);
+                }
+            }
+            return *this;
+        }
+
+        InlineFunction& operator=(std::nullptr_t) noexcept
+        {
+            reset();
+            return *this;
+        }
+
+        ~InlineFunction()
+        {
+            reset();
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return m_operations != nullptr;
+        }
+
+        Result operator()(Args... args) const
+        {
+            if (!m_operations)
+                throw std::bad_function_call();
+            return m_operations->call(&m_storage, std::forward<Args>(args)...);
+        }
+
+    private:
+        // The operations on the stored callable, one constant table for each type of callable
+        struct Operations
+        {
+            Result (*call)(const void* storage, Args... args);
+            void (*copy)(void* destination, const void* source);
+            void (*move)(void* destination, void* source) noexcept; // and destroy the source
+            void (*destroy)(void* storage) noexcept;
+        };
+
+        template <typename Stored>
+        static constexpr Operations operations_of{
+            [](const void* storage, Args... args) -> Result {
+                // like std::function, the callable is called as non-const
+                return std::invoke(*const_cast<Stored*>(static_cast<const Stored*>(storage)),
+                                   std::forward<Args>(args)...);
+            },
+            [](void* destination, const void* source) {
+                ::new (destination) Stored(*static_cast<const Stored*>(source));
+            },
+            [](void* destination, void* source) noexcept {
+                ::new (destination) Stored(std::move(*static_cast<Stored*>(source)));
+                static_cast<Stored*>(source)->~Stored();
+            },
+            [](void* storage) noexcept { static_cast<Stored*>(storage)->~Stored(); },
+        };
+
+        void reset() noexcept
+        {
+            if (m_operations)
+                std::exchange(m_operations, nullptr)->destroy(&m_storage);
+        }
+
+        std::aligned_storage_t<Size, alignof(std::max_align_t)> m_storage;
+        const Operations* m_operations{nullptr};
+    };
+
+} // namespace ajcf
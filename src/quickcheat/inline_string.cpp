@@ -0,0 +1,198 @@
+// https://en.cppreference.com/w/cpp/string/basic_string
+// https://en.cppreference.com/w/cpp/string/basic_string_view
+
+#include "inline_string.hpp"
+#include "allocation_counter.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+    TEST_CASE("fixed capacity inline strings", "[strings][allocation]")
+    {
+        ajcf::AllocationCounter counter;
+
+        ajcf::InlineString<15> s = "Hello";
+        s += "++";
+
+        REQUIRE(s == "Hello++");
+        REQUIRE(s.size() == 7);
+        REQUIRE(std::string_view(s.c_str()) == "Hello++");
+
+        // interoperable with std::string_view and std::string
+        std::string_view view = s;
+
+        REQUIRE(view == "Hello++");
+        REQUIRE(s == std::string("Hello++"));
+        REQUIRE(s.substr(0, 5) == "Hello");
+        REQUIRE(s + " World" == "Hello++ World");
+        REQUIRE(counter.allocations() == 0);
+
+        s.append(s);
+
+        REQUIRE(s == "Hello++Hello++");
+
+        REQUIRE_THROWS_AS(s.append("too long"), std::length_error);
+
+        // assignment of texts
+        ajcf::InlineString<15> assigned;
+        assigned = "literal";
+
+        REQUIRE(assigned == "literal");
+
+        assigned = std::string("std::string");
+
+        REQUIRE(assigned == "std::string");
+        REQUIRE_THROWS_AS(assigned = "much too long for it", std::length_error);
+        REQUIRE_THROWS_AS(ajcf::InlineString<3>("abcd"), std::length_error);
+
+        std::ostringstream stream;
+        stream << s;
+
+        REQUIRE(stream.str() == "Hello++Hello++");
+    }
+
+    TEST_CASE("strings with a bigger small string optimization buffer", "[strings][allocation]")
+    {
+        ajcf::AllocationCounter counter;
+
+        // 32 characters: longer than std::string's inline buffer
+        ajcf::SmallString<> s = "0123456789abcdefghijklmnopqrstuv";
+
+        REQUIRE(s.is_inline());
+        REQUIRE(s.size() == 32);
+        REQUIRE(s == "0123456789abcdefghijklmnopqrstuv");
+        REQUIRE(counter.allocations() == 0);
+
+        auto copy = s;
+        auto moved = std::move(copy);
+
+        REQUIRE(moved == s);
+        REQUIRE(copy.empty());
+        REQUIRE(counter.allocations() == 0);
+
+        // assignment of texts
+        copy = "literal";
+
+        REQUIRE(copy == "literal");
+
+        copy = std::string("std::string");
+
+        REQUIRE(copy == "std::string");
+        REQUIRE(counter.allocations() == 0);
+
+        // longer strings are stored in dynamic memory
+        s += '!';
+
+        REQUIRE(!s.is_inline());
+        REQUIRE(s == "0123456789abcdefghijklmnopqrstuv!");
+        REQUIRE(counter.allocations() == 1);
+
+        const auto* const data = s.data();
+        moved = std::move(s);
+
+        REQUIRE(moved.data() == data);
+        REQUIRE(s.empty());
+        REQUIRE(s.is_inline());
+
+        moved.append(moved);
+
+        REQUIRE(moved == "0123456789abcdefghijklmnopqrstuv!0123456789abcdefghijklmnopqrstuv!");
+        REQUIRE(std::string_view(moved.c_str()).size() == moved.size());
+
+        moved = moved.substr(1, 3);
+
+        REQUIRE(moved == "123");
+        REQUIRE(moved < ajcf::SmallString<>("2"));
+    }
+
+    namespace benchmarks {
+
+        // same as exceptions.cpp's function_which_throws_an_exception_sometime without the exceptions
+        template <typename String>
+        String handle_text(const char* text)
+        {
+            return String(" Everything is ok, we handled this text: ") + text;
+        }
+
+        template <typename String>
+        std::size_t construct_strings()
+        {
+            String short_string = "Hello++";
+            String medium_string = "0123456789012345678";
+            String long_string = "012345678901234567890123456789012345678";
+            return short_string.size() + medium_string.size() + long_string.size();
+        }
+
+        template <typename String>
+        void print_allocations(std::string_view type_name)
+        {
+            ajcf::AllocationCounter construction_counter;
+            const auto sizes = construct_strings<String>();
+            const auto construction_allocations = construction_counter.allocations();
+
+            ajcf::AllocationCounter concatenation_counter;
+            const auto size = handle_text<String>("Hello++").size();
+            const auto concatenation_allocations = concatenation_counter.allocations();
+
+            fmt::print("{}: {} allocations for {} characters in 3 strings, {} allocations for the {} characters "
+                       "concatenation\n",
+                       type_name, construction_allocations, sizes, concatenation_allocations, size);
+        }
+
+        TEST_CASE("inline strings vs std::string: construction and concatenation",
+                  "[strings][allocation][benchmark][!hide]")
+        {
+            print_allocations<std::string>("std::string");
+            print_allocations<ajcf::SmallString<>>("ajcf::SmallString<32>");
+            print_allocations<ajcf::SmallString<64>>("ajcf::SmallString<64>");
+            print_allocations<ajcf::InlineString<64>>("ajcf::InlineString<64>");
+
+            BENCHMARK("construction - std::string")
+            {
+                return construct_strings<std::string>();
+            };
+
+            BENCHMARK("construction - ajcf::SmallString<32>")
+            {
+                return construct_strings<ajcf::SmallString<>>();
+            };
+
+            BENCHMARK("construction - ajcf::SmallString<64>")
+            {
+                return construct_strings<ajcf::SmallString<64>>();
+            };
+
+            BENCHMARK("construction - ajcf::InlineString<64>")
+            {
+                return construct_strings<ajcf::InlineString<64>>();
+            };
+
+            BENCHMARK("concatenation - std::string")
+            {
+                return handle_text<std::string>("Hello++").size();
+            };
+
+            BENCHMARK("concatenation - ajcf::SmallString<32>")
+            {
+                return handle_text<ajcf::SmallString<>>("Hello++").size();
+            };
+
+            BENCHMARK("concatenation - ajcf::SmallString<64>")
+            {
+                return handle_text<ajcf::SmallString<64>>("Hello++").size();
+            };
+
+            BENCHMARK("concatenation - ajcf::InlineString<64>")
+            {
+                return handle_text<ajcf::InlineString<64>>("Hello++").size();
+            };
+        }
+
+    } // namespace benchmarks
+
+} // namespace
@@ -0,0 +1,562 @@
+// https://en.cppreference.com/w/cpp/string/basic_string
+// https://en.cppreference.com/w/cpp/string/basic_string_view
+// https://www.boost.org/doc/libs/release/doc/html/container/non_standard_containers.html#container.non_standard_containers.static_vector
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace ajcf {
+
+    namespace detail {
+
+        // Comparisons of a string class with itself, std::string_view and C-strings (and so std::string),
+        // for a class String convertible to std::string_view
+        template <typename String>
+        class StringComparisons
+        {
+            friend bool operator==(const String& left, const String& right) noexcept
+            {
+                return std::string_view(left) == std::string_view(right);
+            }
+            friend bool operator==(const String& left, std::string_view right) noexcept
+            {
+                return std::string_view(left) == right;
+            }
+            friend bool operator==(std::string_view left, const String& right) noexcept
+            {
+                return left == std::string_view(right);
+            }
+            friend bool operator==(const String& left, const char* right) noexcept
+            {
+                return std::string_view(left) == right;
+            }
+            friend bool operator==(const char* left, const String& right) noexcept
+            {
+                return left == std::string_view(right);
+            }
+            friend bool operator!=(const String& left, const String& right) noexcept
+            {
+                return !(left == right);
+            }
+            friend bool operator!=(const String& left, std::string_view right) noexcept
+            {
+                return !(left == right);
+            }
+            friend bool operator!=(std::string_view left, const String& right) noexcept
+            {
+                return !(left == right);
+            }
+            friend bool operator!=(const String& left, const char* right) noexcept
+            {
+                return !(left == right);
+            }
+            friend bool operator!=(const char* left, const String& right) noexcept
+            {
+                return !(left == right);
+            }
+            friend bool operator<(const String& left, const String& right) noexcept
+            {
+                return std::string_view(left) < std::string_view(right);
+            }
+            friend std::ostream& operator<<(std::ostream& stream, const String& string)
+            {
+                return stream << std::string_view(string);
+            }
+        };
+
+    } // namespace detail
+
+    // String of at most Capacity characters, stored inside the object: it never allocates dynamic memory
+    // Exceeding the capacity throws std::length_error
+    //   ajcf::InlineString<15> s = "Hello";
+    //   s += "++";
+    template <std::size_t Capacity>
+    class InlineString : public detail::StringComparisons<InlineString<Capacity>>
+    {
+    public:
+        using value_type = char;
+        using size_type = std::size_t;
+        using iterator = char*;
+        using const_iterator = const char*;
+
+        static constexpr size_type npos = std::string_view::npos;
+
+        InlineString() noexcept = default;
+
+        InlineString(const char* c_string) : InlineString(std::string_view(c_string))
+        {
+        }
+
+        explicit InlineString(std::string_view text)
+        {
+            append(text);
+        }
+
+        InlineString(size_type count, char c)
+        {
+            check_length(count);
+            std::memset(m_buffer, c, count);
+            set_size(count);
+        }
+
+        InlineString& operator=(std::string_view text)
+        {
+            check_length(text.size());
+            std::memmove(m_buffer, text.data(), text.size());
+            set_size(text.size());
+            return *this;
+        }
+
+        // else s = "text" is ambiguous between the constructor from const char* and operator=(std::string_view)
+        InlineString& operator=(const char* c_string)
+        {
+            return *this = std::string_view(c_string);
+        }
+
+        static constexpr size_type capacity() noexcept
+        {
+            return Capacity;
+        }
+
+        static constexpr size_type max_size() noexcept
+        {
+            return Capacity;
+        }
+
+        size_type size() const noexcept
+        {
+            return m_size;
+        }
+
+        size_type length() const noexcept
+        {
+            return m_size;
+        }
+
+        bool empty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        char* data() noexcept
+        {
+            return m_buffer;
+        }
+
+        const char* data() const noexcept
+        {
+            return m_buffer;
+        }
+
+        const char* c_str() const noexcept
+        {
+            return m_buffer;
+        }
+
+        char& operator[](size_type position) noexcept
+        {
+            return m_buffer[position];
+        }
+
+        const char& operator[](size_type position) const noexcept
+        {
+            return m_buffer[position];
+        }
+
+        iterator begin() noexcept
+        {
+            return m_buffer;
+        }
+
+        iterator end() noexcept
+        {
+            return m_buffer + m_size;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return m_buffer;
+        }
+
+        const_iterator end() const noexcept
+        {
+            return m_buffer + m_size;
+        }
+
+        operator std::string_view() const noexcept
+        {
+            return std::string_view(m_buffer, m_size);
+        }
+
+        void clear() noexcept
+        {
+            set_size(0);
+        }
+
+        void resize(size_type count, char c = '\0')
+        {
+            check_length(count);
+            if (count > m_size)
+                std::memset(m_buffer + m_size, c, count - m_size);
+            set_size(count);
+        }
+
+        void push_back(char c)
+        {
+            check_length(m_size + 1);
+            m_buffer[m_size] = c;
+            set_size(m_size + 1);
+        }
+
+        InlineString& append(std::string_view text)
+        {
+            check_length(m_size + text.size());
+            // memmove: text can be a part of this string
+            std::memmove(m_buffer + m_size, text.data(), text.size());
+            set_size(m_size + text.size());
+            return *this;
+        }
+
+        InlineString& operator+=(std::string_view text)
+        {
+            return append(text);
+        }
+
+        InlineString& operator+=(char c)
+        {
+            push_back(c);
+            return *this;
+        }
+
+        InlineString substr(size_type position = 0, size_type count = npos) const
+        {
+            return InlineString(std::string_view(*this).substr(position, count));
+        }
+
+        friend InlineString operator+(InlineString left, std::string_view right)
+        {
+            left.append(right);
+            return left;
+        }
+
+        friend InlineString operator+(InlineString left, const char* right)
+        {
+            left.append(right);
+            return left;
+        }
+
+        friend InlineString operator+(InlineString left, char right)
+        {
+            left.push_back(right);
+            return left;
+        }
+
+    private:
+        static void check_length(size_type length)
+        {
+            if (length > Capacity)
+                throw std::length_error("ajcf::InlineString capacity exceeded");
+        }
+
+        void set_size(size_type size) noexcept
+        {
+            m_size = size;
+            m_buffer[size] = '\0';
+        }
+
+        char m_buffer[Capacity + 1]{};
+        size_type m_size{0};
+    };
+
+    // String storing up to InlineCapacity characters inside the object (small string optimization),
+    // and longer strings in dynamic memory
+    // std::string's inline buffer is only 15 (libstdc++, MSVC) or 22 (libc++) characters long:
+    // a bigger buffer avoids the dynamic allocations of most identifiers, file names, messages, ...
+    //   ajcf::SmallString<> s = "a text of less than 32 characters";
+    template <std::size_t InlineCapacity = 32>
+    class SmallString : public detail::StringComparisons<SmallString<InlineCapacity>>
+    {
+    public:
+        using value_type = char;
+        using size_type = std::size_t;
+        using iterator = char*;
+        using const_iterator = const char*;
+
+        static constexpr size_type npos = std::string_view::npos;
+
+        SmallString() noexcept = default;
+
+        SmallString(const char* c_string) : SmallString(std::string_view(c_string))
+        {
+        }
+
+        explicit SmallString(std::string_view text)
+        {
+            append(text);
+        }
+
+        SmallString(size_type count, char c)
+        {
+            resize(count, c);
+        }
+
+        SmallString(const SmallString& other) : SmallString(std::string_view(other))
+        {
+        }
+
+        SmallString(SmallString&& other) noexcept
+        {
+            steal(other);
+        }
+
+        ~SmallString()
+        {
+            release();
+        }
+
+        SmallString& operator=(const SmallString& other)
+        {
+            return *this = std::string_view(other);
+        }
+
+        SmallString& operator=(SmallString&& other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                steal(other);
+            }
+            return *this;
+        }
+
+        SmallString& operator=(std::string_view text)
+        {
+            if (text.size() > m_capacity)
+            {
+                // text can be a part of this string: copy it before releasing the buffer
+                SmallString copy(text);
+                return *this = std::move(copy);
+            }
+            std::memmove(m_data, text.data(), text.size());
+            set_size(text.size());
+            return *this;
+        }
+
+        SmallString& operator=(const char* c_string)
+        {
+            return *this = std::string_view(c_string);
+        }
+
+        static constexpr size_type inline_capacity() noexcept
+        {
+            return InlineCapacity;
+        }
+
+        // Whether the characters are stored inside the object
+        bool is_inline() const noexcept
+        {
+            return m_data == m_buffer;
+        }
+
+        size_type capacity() const noexcept
+        {
+            return m_capacity;
+        }
+
+        size_type size() const noexcept
+        {
+            return m_size;
+        }
+
+        size_type length() const noexcept
+        {
+            return m_size;
+        }
+
+        bool empty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        char* data() noexcept
+        {
+            return m_data;
+        }
+
+        const char* data() const noexcept
+        {
+            return m_data;
+        }
+
+        const char* c_str() const noexcept
+        {
+            return m_data;
+        }
+
+        char& operator[](size_type position) noexcept
+        {
+            return m_data[position];
+        }
+
+        const char& operator[](size_type position) const noexcept
+        {
+            return m_data[position];
+        }
+
+        iterator begin() noexcept
+        {
+            return m_data;
+        }
+
+        iterator end() noexcept
+        {
+            return m_data + m_size;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return m_data;
+        }
+
+        const_iterator end() const noexcept
+        {
+            return m_data + m_size;
+        }
+
+        operator std::string_view() const noexcept
+        {
+            return std::string_view(m_data, m_size);
+        }
+
+        void reserve(size_type new_capacity)
+        {
+            if (new_capacity <= m_capacity)
+                return;
+            char* const new_data = new char[new_capacity + 1];
+            std::memcpy(new_data, m_data, m_size + 1);
+            release();
+            m_data = new_data;
+            m_capacity = new_capacity;
+        }
+
+        void clear() noexcept
+        {
+            set_size(0);
+        }
+
+        void resize(size_type count, char c = '\0')
+        {
+            reserve(count);
+            if (count > m_size)
+                std::memset(m_data + m_size, c, count - m_size);
+            set_size(count);
+        }
+
+        void push_back(char c)
+        {
+            if (m_size == m_capacity)
+                grow(m_size + 1);
+            m_data[m_size] = c;
+            set_size(m_size + 1);
+        }
+
+        SmallString& append(std::string_view text)
+        {
+            if (m_size + text.size() > m_capacity)
+            {
+                // text can be a part of this string: keep its offset, the buffer can move
+                const bool text_is_inside = text.data() >= m_data && text.data() <= m_data + m_size;
+                const auto offset = text_is_inside ? static_cast<size_type>(text.data() - m_data) : 0;
+                grow(m_size + text.size());
+                if (text_is_inside)
+                    text = std::string_view(m_data + offset, text.size());
+            }
+            std::memcpy(m_data + m_size, text.data(), text.size());
+            set_size(m_size + text.size());
+            return *this;
+        }
+
+        SmallString& operator+=(std::string_view text)
+        {
+            return append(text);
+        }
+
+        SmallString& operator+=(char c)
+        {
+            push_back(c);
+            return *this;
+        }
+
+        SmallString substr(size_type position = 0, size_type count = npos) const
+        {
+            return SmallString(std::string_view(*this).substr(position, count));
+        }
+
+        friend SmallString operator+(SmallString left, std::string_view right)
+        {
+            left.append(right);
+            return left;
+        }
+
+        friend SmallString operator+(SmallString left, const char* right)
+        {
+            left.append(right);
+            return left;
+        }
+
+        friend SmallString operator+(SmallString left, char right)
+        {
+            left.push_back(right);
+            return left;
+        }
+
+    private:
+        void grow(size_type min_capacity)
+        {
+            reserve(std::max(min_capacity, 2 * m_capacity));
+        }
+
+        void set_size(size_type size) noexcept
+        {
+            m_size = size;
+            m_data[size] = '\0';
+        }
+
+        void release() noexcept
+        {
+            if (!is_inline())
+                delete[] m_data;
+        }
+
+        // leaves other empty, this must own no dynamic buffer
+        void steal(SmallString& other) noexcept
+        {
+            if (other.is_inline())
+            {
+                std::memcpy(m_buffer, other.m_buffer, other.m_size + 1);
+                m_data = m_buffer;
+                m_capacity = InlineCapacity;
+            }
+            else
+            {
+                m_data = std::exchange(other.m_data, other.m_buffer);
+                m_capacity = std::exchange(other.m_capacity, InlineCapacity);
+            }
+            m_size = other.m_size;
+            other.set_size(0);
+        }
+
+        char* m_data{m_buffer};
+        size_type m_size{0};
+        size_type m_capacity{InlineCapacity};
+        char m_buffer[InlineCapacity + 1]{};
+    };
+
+} // namespace ajcf
@@ -5,11 +5,23 @@
 // https://en.cppreference.com/w/cpp/io/cerr
 // https://en.cppreference.com/w/cpp/header/fstream
 
+#include "async_file_io.hpp"
+#include "buffered_io.hpp"
+#include "mapped_file.hpp"
 #include <catch2/catch.hpp>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#if defined(AJCF_ASYNC_FILE_IO_AVAILABLE)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace {
 
@@ -48,6 +60,26 @@ namespace {
 
     } // ofs' destructor automatically closes the file here
 
+    TEST_CASE("to a file, buffered", "[output][buffered_io]")
+    {
+        // The same without locale, sentry object nor virtual call for each <<, then written with write(2)
+
+        std::optional<ajcf::BufferedWriter> writer;
+        try
+        {
+            writer.emplace("some_dir/some_file.txt");
+        }
+        catch (const std::system_error&)
+        {
+            return; // cannot be created
+        }
+
+        *writer << "One line\n";
+        *writer << 1.0 << " other "
+                << "line" << '\n';
+
+    } // writer's destructor automatically writes the buffer and closes the file here
+
     TEST_CASE("from a file", "[input]")
     {
         // Open file "some_dir/some_file.txt" then write data from it
@@ -66,6 +98,89 @@ namespace {
 
     } // ifs' destructor automatically closes the file here
 
+    TEST_CASE("from a file, buffered", "[input][buffered_io]")
+    {
+        // The same with big reads in one buffer: the lines are views on the buffer, no copy into a std::string
+
+        std::optional<ajcf::LineReader> reader;
+        try
+        {
+            reader.emplace("mon_rep/mon_fichier.txt");
+        }
+        catch (const std::system_error&)
+        {
+            return; // cannot be opened
+        }
+
+        std::string_view line1;
+        if (!reader->read_line(line1))
+            return; // Error, reader's destructor automatically closes the file here
+
+        // line1 is valid until the next read_line
+        const std::string first_line{line1};
+
+        std::string_view line2;
+        if (!reader->read_line(line2))
+            return; // Error, reader's destructor automatically closes the file here
+
+    } // reader's destructor automatically closes the file here
+
+    TEST_CASE("from a memory-mapped file", "[input][mapped_file]")
+    {
+        // Map file "some_dir/some_file.txt" in memory then read lines from it, without copying them
+
+        const auto file = ajcf::MappedFile::open("mon_rep/mon_fichier.txt");
+        if (!file)
+            return; // cannot be opened
+
+        // the kernel can read ahead the next pages while reading the lines
+        file->advise(ajcf::AccessPattern::sequential);
+
+        auto lines = file->lines();
+        auto line = lines.begin();
+        if (line == lines.end())
+            return; // Error, file's destructor automatically unmaps the file here
+        const std::string_view line1 = *line;
+
+        if (++line == lines.end())
+            return; // Error, file's destructor automatically unmaps the file here
+        const std::string_view line2 = *line;
+
+        // the lines are views on the mapped file
+        REQUIRE(line2.data() == line1.data() + line1.size() + 1);
+
+    } // file's destructor automatically unmaps the file here
+
+#if defined(AJCF_ASYNC_FILE_IO_AVAILABLE)
+    TEST_CASE("from several files, asynchronously", "[input][async_file_io]")
+    {
+        // Read the beginning of two files at the same time, without blocking this thread while the kernel reads
+        // (io_uring on Linux, else pread on a pool of threads)
+
+        const int file1 = ::open("mon_rep/mon_fichier.txt", O_RDONLY | O_CLOEXEC);
+        const int file2 = ::open("mon_rep/mon_autre_fichier.txt", O_RDONLY | O_CLOEXEC);
+
+        ajcf::AsyncFileIo io;
+        std::vector<char> buffer1(4096);
+        std::vector<char> buffer2(4096);
+        std::size_t size1 = 0;
+        io.read(file1, buffer1, 0, [&](ajcf::AsyncIoResult result) { size1 = result.value_or(0); });
+        io.read(file2, buffer2, 0, [&](ajcf::AsyncIoResult result) {
+            if (!result)
+                return; // Error, for example std::errc::bad_file_descriptor if the file could not be opened
+        });
+        io.submit(); // both reads are started by one system call
+
+        // do something else, then call the callbacks of the completed reads
+        io.wait_all();
+        REQUIRE(size1 <= buffer1.size());
+
+        // the descriptors must stay open until the reads are completed
+        ::close(file1);
+        ::close(file2);
+    }
+#endif
+
     TEST_CASE("to a string stream", "[output]")
     {
         std::stringstream ss;
@@ -0,0 +1,416 @@
+// https://man7.org/linux/man-pages/man2/mmap.2.html
+// https://man7.org/linux/man-pages/man2/madvise.2.html
+// https://en.cppreference.com/w/cpp/io/c/fread
+
+#include "mapped_file.hpp"
+#include "allocation_counter.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(AJCF_MAPPED_FILE_USE_MMAP)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ajcf {
+
+    namespace {
+
+        MappedFile value_or_throw(tl::expected<MappedFile, std::error_code>&& file, const std::filesystem::path& path)
+        {
+            if (!file)
+                throw std::system_error(file.error(), "cannot map the file " + path.string());
+            return std::move(*file);
+        }
+
+#if defined(AJCF_MAPPED_FILE_USE_MMAP)
+        std::error_code last_error() noexcept
+        {
+            return {errno, std::generic_category()};
+        }
+#endif
+
+    } // namespace
+
+    MappedFile::MappedFile(const std::filesystem::path& path, MappingMode mode)
+        : MappedFile(value_or_throw(open(path, mode), path))
+    {
+    }
+
+#if defined(AJCF_MAPPED_FILE_USE_MMAP)
+    tl::expected<MappedFile, std::error_code> MappedFile::open(const std::filesystem::path& path, MappingMode mode)
+    {
+        const auto read_only = mode == MappingMode::read_only;
+        const int descriptor = ::open(path.c_str(), (read_only ? O_RDONLY : O_RDWR) | O_CLOEXEC);
+        if (descriptor == -1)
+            return tl::make_unexpected(last_error());
+
+        // the mapping stays valid once the file is closed
+        struct ::stat status{};
+        if (::fstat(descriptor, &status) == -1)
+        {
+            const auto error = last_error();
+            ::close(descriptor);
+            return tl::make_unexpected(error);
+        }
+
+        MappedFile file;
+        file.m_mode = mode;
+        file.m_size = static_cast<std::size_t>(status.st_size);
+        // an empty file cannot be mapped, and has nothing to map
+        if (file.m_size != 0)
+        {
+            void* const mapping = ::mmap(nullptr, file.m_size, read_only ? PROT_READ : PROT_READ | PROT_WRITE,
+                                         MAP_SHARED, descriptor, 0);
+            if (mapping == MAP_FAILED)
+            {
+                const auto error = last_error();
+                ::close(descriptor);
+                return tl::make_unexpected(error);
+            }
+            file.m_data = static_cast<char*>(mapping);
+        }
+        ::close(descriptor);
+        return file;
+    }
+
+    void MappedFile::advise(AccessPattern pattern) const noexcept
+    {
+        if (m_size == 0)
+            return;
+        switch (pattern)
+        {
+        case AccessPattern::normal:
+            ::madvise(m_data, m_size, MADV_NORMAL);
+            break;
+        case AccessPattern::sequential:
+            ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+            break;
+        case AccessPattern::random:
+            ::madvise(m_data, m_size, MADV_RANDOM);
+            break;
+        case AccessPattern::will_need:
+            ::madvise(m_data, m_size, MADV_WILLNEED);
+            break;
+        }
+    }
+
+    void MappedFile::flush()
+    {
+        if (m_mode == MappingMode::read_write && m_size != 0 && ::msync(m_data, m_size, MS_SYNC) == -1)
+            throw std::system_error(last_error(), "cannot write the mapped file");
+    }
+
+    void MappedFile::release() noexcept
+    {
+        if (m_size != 0)
+            ::munmap(m_data, m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)), m_mode(other.m_mode)
+    {
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_mode = other.m_mode;
+        }
+        return *this;
+    }
+#else
+    tl::expected<MappedFile, std::error_code> MappedFile::open(const std::filesystem::path& path, MappingMode mode)
+    {
+        std::ifstream input{path, std::ios::binary};
+        std::error_code error;
+        const auto size = std::filesystem::file_size(path, error);
+        if (!input || error)
+            return tl::make_unexpected(error ? error : std::make_error_code(std::errc::no_such_file_or_directory));
+
+        MappedFile file;
+        file.m_mode = mode;
+        file.m_path = path;
+        file.m_copy.resize(static_cast<std::size_t>(size));
+        if (!input.read(file.m_copy.data(), static_cast<std::streamsize>(size)))
+            return tl::make_unexpected(std::make_error_code(std::errc::io_error));
+        file.m_data = file.m_copy.data();
+        file.m_size = file.m_copy.size();
+        return file;
+    }
+
+    void MappedFile::advise(AccessPattern) const noexcept
+    {
+    }
+
+    void MappedFile::flush()
+    {
+        if (m_mode != MappingMode::read_write || m_size == 0)
+            return;
+        std::ofstream output{m_path, std::ios::binary | std::ios::in};
+        if (!output.write(m_data, static_cast<std::streamsize>(m_size)).flush())
+            throw std::system_error(std::make_error_code(std::errc::io_error), "cannot write the mapped file");
+    }
+
+    void MappedFile::release() noexcept
+    {
+        try
+        {
+            flush();
+        }
+        catch (const std::exception&)
+        {
+            // like the kernel, the changes are written at best
+        }
+        m_copy.clear();
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)), m_mode(other.m_mode),
+          m_copy(std::move(other.m_copy)), m_path(std::move(other.m_path))
+    {
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_mode = other.m_mode;
+            m_copy = std::move(other.m_copy);
+            m_path = std::move(other.m_path);
+        }
+        return *this;
+    }
+#endif
+
+    MappedFile::~MappedFile()
+    {
+        release();
+    }
+
+    gsl::span<char> MappedFile::writable_bytes()
+    {
+        if (m_mode != MappingMode::read_write)
+            throw std::logic_error("the file is mapped in read-only mode");
+        return {m_data, m_size};
+    }
+
+} // namespace ajcf
+
+namespace {
+
+    std::filesystem::path write_temporary_file(const char* name, const std::string& content)
+    {
+        const auto path = std::filesystem::temp_directory_path() / name;
+        std::ofstream{path, std::ios::binary} << content;
+        return path;
+    }
+
+    std::vector<std::string_view> lines_of(std::string_view text)
+    {
+        const ajcf::Lines lines{text};
+        return {lines.begin(), lines.end()};
+    }
+
+    TEST_CASE("lines of a text", "[input][mapped_file]")
+    {
+        using Lines = std::vector<std::string_view>;
+
+        REQUIRE(lines_of("") == Lines{});
+        REQUIRE(lines_of("\n") == Lines{""});
+        REQUIRE(lines_of("one") == Lines{"one"});
+        REQUIRE(lines_of("one\n") == Lines{"one"});
+        REQUIRE(lines_of("one\n\nthree") == Lines{"one", "", "three"});
+        REQUIRE(lines_of("one\r\ntwo\n") == Lines{"one\r", "two"});
+    }
+
+    TEST_CASE("memory-mapped file", "[input][mapped_file]")
+    {
+        const auto path = write_temporary_file("ajcf_mapped_file.txt", "first line\nsecond line\n");
+
+        {
+            const ajcf::MappedFile file{path};
+            file.advise(ajcf::AccessPattern::sequential);
+
+            REQUIRE(file.size() == 23);
+            REQUIRE(file.bytes()[0] == 'f');
+            REQUIRE_THROWS_AS(ajcf::MappedFile{path}.writable_bytes(), std::logic_error);
+
+            // the lines are views on the mapping
+            ajcf::AllocationCounter counter;
+            std::size_t lines_count = 0;
+            std::string_view last_line;
+            for (const auto line : file.lines())
+            {
+                ++lines_count;
+                last_line = line;
+            }
+
+            REQUIRE(counter.allocations() == 0);
+            REQUIRE(lines_count == 2);
+            REQUIRE(last_line == "second line");
+            REQUIRE(last_line.data() == file.data() + 11);
+        }
+
+        {
+            auto file = ajcf::MappedFile{path, ajcf::MappingMode::read_write};
+            const auto bytes = file.writable_bytes();
+            std::fill(bytes.begin(), bytes.begin() + 5, 'F');
+            file.flush();
+        }
+
+        std::ifstream input{path};
+        std::string first_line;
+        std::getline(input, first_line);
+
+        REQUIRE(first_line == "FFFFF line");
+
+        std::filesystem::remove(path);
+
+        REQUIRE(ajcf::MappedFile::open(path).error() == std::errc::no_such_file_or_directory);
+        REQUIRE_THROWS_AS(ajcf::MappedFile{path}, std::system_error);
+
+        const auto empty_path = write_temporary_file("ajcf_mapped_file_empty.txt", "");
+        const auto empty_file = ajcf::MappedFile::open(empty_path);
+
+        REQUIRE(empty_file->empty());
+        REQUIRE(empty_file->lines().begin() == empty_file->lines().end());
+
+        std::filesystem::remove(empty_path);
+    }
+
+    namespace benchmarks {
+
+        // lines of 1 to 120 characters, like a log or a CSV file
+        void write_lines_file(const std::filesystem::path& path, std::size_t bytes)
+        {
+            std::unique_ptr<std::FILE, int (*)(std::FILE*)> file{std::fopen(path.string().c_str(), "wb"),
+                                                                  &std::fclose};
+            std::vector<char> buffer;
+            std::uint32_t state = 42;
+            std::size_t written_bytes = 0;
+            while (written_bytes < bytes)
+            {
+                buffer.clear();
+                while (buffer.size() < 1024 * 1024)
+                {
+                    state = state * 1664525 + 1013904223;
+                    const auto line_size = 1 + (state >> 8) % 120;
+                    buffer.insert(buffer.end(), line_size, static_cast<char>('a' + (state >> 24) % 26));
+                    buffer.push_back('\n');
+                }
+                written_bytes += std::fwrite(buffer.data(), 1, buffer.size(), file.get());
+            }
+        }
+
+        struct ScanResult
+        {
+            std::size_t lines_count{0};
+            std::size_t characters_count{0}; // without the '\n'
+        };
+
+        TEST_CASE("scan of a 2 GB file: std::fread, std::ifstream and ajcf::MappedFile",
+                  "[input][mapped_file][benchmark][!hide]")
+        {
+            const auto path = std::filesystem::temp_directory_path() / "ajcf_mapped_file_lines.txt";
+            write_lines_file(path, std::size_t{2} << 30);
+            const auto file_size = std::filesystem::file_size(path);
+
+            // the file is in the page cache after the first run: this measures the copies and the system calls,
+            // not the disk
+            const auto print_scan = [&](const char* name, auto&& scan) {
+                ScanResult result;
+                std::chrono::duration<double> best_elapsed{1e9};
+                for (int run = 0; run != 3; ++run)
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    result = scan();
+                    best_elapsed =
+                        std::min<std::chrono::duration<double>>(best_elapsed, std::chrono::steady_clock::now() - start);
+                }
+                fmt::print("{:<46} {:>8.0f} MB/s ({} lines, {} characters)\n", name,
+                           file_size / best_elapsed.count() / 1e6, result.lines_count, result.characters_count);
+            };
+
+            fmt::print("{:.1f} GB file, lines of 1 to 120 characters:\n", file_size / 1e9);
+            print_scan("  std::ifstream + std::getline", [&] {
+                ScanResult result;
+                std::ifstream input{path, std::ios::binary};
+                std::string line;
+                while (std::getline(input, line))
+                {
+                    ++result.lines_count;
+                    result.characters_count += line.size();
+                }
+                return result;
+            });
+            print_scan("  std::fread 1 MB + std::memchr", [&] {
+                ScanResult result;
+                std::unique_ptr<std::FILE, int (*)(std::FILE*)> file{std::fopen(path.string().c_str(), "rb"),
+                                                                      &std::fclose};
+                std::vector<char> buffer(1024 * 1024);
+                std::size_t read_bytes = 0;
+                while ((read_bytes = std::fread(buffer.data(), 1, buffer.size(), file.get())) != 0)
+                {
+                    // the lines cross the buffers: only the '\n' are counted
+                    const char* position = buffer.data();
+                    const char* const end = buffer.data() + read_bytes;
+                    while ((position = static_cast<const char*>(std::memchr(position, '\n', end - position))))
+                    {
+                        ++result.lines_count;
+                        ++position;
+                    }
+                    result.characters_count += read_bytes;
+                }
+                result.characters_count -= result.lines_count;
+                return result;
+            });
+
+            const auto scan_mapped_file = [&](ajcf::AccessPattern pattern) {
+                ScanResult result;
+                const ajcf::MappedFile file{path};
+                file.advise(pattern);
+                for (const auto line : file.lines())
+                {
+                    ++result.lines_count;
+                    result.characters_count += line.size();
+                }
+                return result;
+            };
+            print_scan("  ajcf::MappedFile + ajcf::Lines",
+                       [&] { return scan_mapped_file(ajcf::AccessPattern::normal); });
+            print_scan("  ajcf::MappedFile + ajcf::Lines, sequential",
+                       [&] { return scan_mapped_file(ajcf::AccessPattern::sequential); });
+            print_scan("  ajcf::MappedFile + ajcf::Lines, will need",
+                       [&] { return scan_mapped_file(ajcf::AccessPattern::will_need); });
+
+            std::filesystem::remove(path);
+        }
+
+    } // namespace benchmarks
+
+} // namespace
@@ -0,0 +1,213 @@
+// https://man7.org/linux/man-pages/man2/mmap.2.html
+// https://man7.org/linux/man-pages/man2/madvise.2.html
+// https://man7.org/linux/man-pages/man2/msync.2.html
+
+#pragma once
+
+#include <gsl/span>
+#include <tl/expected.hpp>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define AJCF_MAPPED_FILE_USE_MMAP 1
+#endif
+
+namespace ajcf {
+
+    // Lines of a text, without their '\n', as views on the text: no copy and no allocation
+    // The last line can end without '\n', an empty text has no line
+    //   for (std::string_view line : ajcf::Lines{text})
+    class Lines
+    {
+    public:
+        class Iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const std::string_view*;
+            using reference = const std::string_view&;
+
+            // the end of the lines
+            Iterator() = default;
+
+            Iterator(const char* begin, const char* end) noexcept : m_next(begin), m_end(end)
+            {
+                find_line();
+            }
+
+            reference operator*() const noexcept
+            {
+                return m_line;
+            }
+
+            pointer operator->() const noexcept
+            {
+                return &m_line;
+            }
+
+            Iterator& operator++() noexcept
+            {
+                find_line();
+                return *this;
+            }
+
+            Iterator operator++(int) noexcept
+            {
+                auto previous = *this;
+                find_line();
+                return previous;
+            }
+
+            // the lines start at different addresses, even the empty ones
+            friend bool operator==(const Iterator& left, const Iterator& right) noexcept
+            {
+                return left.m_line.data() == right.m_line.data();
+            }
+
+            friend bool operator!=(const Iterator& left, const Iterator& right) noexcept
+            {
+                return !(left == right);
+            }
+
+        private:
+            void find_line() noexcept
+            {
+                if (m_next == m_end)
+                {
+                    m_line = {};
+                    return;
+                }
+                const auto newline = static_cast<const char*>(std::memchr(m_next, '\n', m_end - m_next));
+                const auto line_end = newline ? newline : m_end;
+                m_line = std::string_view(m_next, line_end - m_next);
+                m_next = newline ? newline + 1 : m_end;
+            }
+
+            std::string_view m_line;
+            const char* m_next{nullptr};
+            const char* m_end{nullptr};
+        };
+
+        explicit Lines(std::string_view text) noexcept : m_text(text)
+        {
+        }
+
+        Iterator begin() const noexcept
+        {
+            return {m_text.data(), m_text.data() + m_text.size()};
+        }
+
+        Iterator end() const noexcept
+        {
+            return {};
+        }
+
+    private:
+        std::string_view m_text;
+    };
+
+    enum class MappingMode
+    {
+        read_only,
+        read_write, // the changes are written to the file, the size of the file does not change
+    };
+
+    // How the mapping will be read, so that the kernel reads ahead, or not (madvise)
+    enum class AccessPattern
+    {
+        normal,
+        sequential, // aggressive read ahead, the pages already read can be dropped
+        random,     // no read ahead
+        will_need,  // read ahead of the whole file now
+    };
+
+    // File mapped in memory (RAII): its bytes are read or written in place, without any copy in a buffer
+    // and without any system call once mapped, the kernel loads the pages on their first access
+    // Where mmap is not available, the whole file is read in memory (and written back in read-write mode)
+    //   const ajcf::MappedFile file{"data.txt"};
+    //   file.advise(ajcf::AccessPattern::sequential);
+    //   for (std::string_view line : file.lines())
+    class MappedFile
+    {
+    public:
+        // Throw std::system_error if the file cannot be opened or mapped
+        explicit MappedFile(const std::filesystem::path& path, MappingMode mode = MappingMode::read_only);
+
+        // The same without exception (except std::bad_alloc)
+        static tl::expected<MappedFile, std::error_code> open(const std::filesystem::path& path,
+                                                              MappingMode mode = MappingMode::read_only);
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile();
+
+        MappingMode mode() const noexcept
+        {
+            return m_mode;
+        }
+
+        const char* data() const noexcept
+        {
+            return m_data;
+        }
+
+        std::size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        bool empty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        gsl::span<const char> bytes() const noexcept
+        {
+            return {m_data, m_size};
+        }
+
+        // Throw std::logic_error if the file is mapped in read-only mode
+        gsl::span<char> writable_bytes();
+
+        std::string_view text() const noexcept
+        {
+            return {m_data, m_size};
+        }
+
+        Lines lines() const noexcept
+        {
+            return Lines{text()};
+        }
+
+        // A hint only: ignored if the system does not support it
+        void advise(AccessPattern pattern) const noexcept;
+
+        // Write the changes to the file now, else they are written by the kernel later
+        // Throw std::system_error on failure
+        void flush();
+
+    private:
+        MappedFile() = default;
+
+        void release() noexcept;
+
+        char* m_data{nullptr};
+        std::size_t m_size{0};
+        MappingMode m_mode{MappingMode::read_only};
+#if !defined(AJCF_MAPPED_FILE_USE_MMAP)
+        std::vector<char> m_copy;
+        std::filesystem::path m_path;
+#endif
+    };
+
+} // namespace ajcf
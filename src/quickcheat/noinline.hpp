@@ -0,0 +1,14 @@
+// https://gcc.gnu.org/onlinedocs/gcc/Common-Function-Attributes.html (noinline, noclone)
+// https://docs.microsoft.com/en-us/cpp/cpp/noinline
+
+#pragma once
+
+// For the benchmarks: the function is not inlined, and not specialized for the arguments known at the call,
+// so that the measured call is a real call (of a callable not known at the call, of a recursive function...)
+#if defined(_MSC_VER)
+#define AJCF_NOINLINE __declspec(noinline)
+#elif defined(__clang__)
+#define AJCF_NOINLINE __attribute__((noinline))
+#else
+#define AJCF_NOINLINE __attribute__((noinline, noclone))
+#endif
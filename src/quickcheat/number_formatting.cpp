@@ -0,0 +1,186 @@
+// https://en.cppreference.com/w/cpp/utility/to_chars
+// https://en.cppreference.com/w/cpp/string/basic_string/to_string
+
+#include "number_formatting.hpp"
+#include "number_parsing.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+
+    template <typename Number>
+    std::string format(Number value)
+    {
+        return ajcf::FormattedNumber<Number>{value}.str();
+    }
+
+    static_assert(ajcf::max_formatted_size<int> == 11);
+    static_assert(ajcf::max_formatted_size<std::uint64_t> == 21);
+    static_assert(ajcf::max_formatted_size<double> == 24);
+    static_assert(ajcf::number_formatting_details::count_digits(1234567u) == 7);
+
+    TEST_CASE("number formatting: integers", "[number_formatting]")
+    {
+        REQUIRE(format(0) == "0");
+        REQUIRE(format(7) == "7");
+        REQUIRE(format(42) == "42");
+        REQUIRE(format(-42) == "-42");
+        REQUIRE(format(100) == "100");
+        REQUIRE(format(std::numeric_limits<int>::min()) == "-2147483648");
+        REQUIRE(format(std::numeric_limits<std::int64_t>::min()) == "-9223372036854775808");
+        REQUIRE(format(std::numeric_limits<std::uint64_t>::max()) == "18446744073709551615");
+        REQUIRE(format(std::int8_t{-128}) == "-128");
+
+        // in a caller-provided buffer
+        char buffer[ajcf::max_formatted_size<long>];
+        const auto end = ajcf::format_number(buffer, -1234567L);
+
+        REQUIRE(std::string_view(buffer, end - buffer) == "-1234567");
+
+        std::mt19937_64 random{42};
+        bool same_as_to_string = true;
+        for (int index = 0; index != 100'000; ++index)
+        {
+            // all the numbers of digits
+            const auto value = static_cast<std::int64_t>(random()) >> (random() % 64);
+            same_as_to_string = same_as_to_string && format(value) == std::to_string(value);
+        }
+
+        REQUIRE(same_as_to_string);
+    }
+
+    TEST_CASE("number formatting: floating point numbers", "[number_formatting]")
+    {
+        // the shortest text which gives back the same number
+        REQUIRE(format(0.1) == "0.1");
+        REQUIRE(format(0.1f) == "0.1");
+        REQUIRE(format(2.5) == "2.5");
+        REQUIRE(format(123456789.0) == "123456789");
+        REQUIRE(format(1e20) == "1e+20");
+        REQUIRE(format(-0.0) == "-0");
+        REQUIRE(format(std::numeric_limits<double>::infinity()) == "inf");
+        REQUIRE(format(std::nan("")) == "nan");
+        REQUIRE(format(std::numeric_limits<double>::lowest()) == "-1.7976931348623157e+308");
+        REQUIRE(format(-std::numeric_limits<double>::denorm_min()) == "-5e-324");
+
+        std::mt19937_64 random{42};
+        bool round_trip = true;
+        for (int index = 0; index != 100'000; ++index)
+        {
+            // any finite bit pattern
+            double value = 0;
+            do
+            {
+                const auto bits = random();
+                std::memcpy(&value, &bits, sizeof(value));
+            } while (!std::isfinite(value));
+            round_trip = round_trip && ajcf::parse_number<double>(format(value)) == value;
+        }
+
+        REQUIRE(round_trip);
+    }
+
+    namespace benchmarks {
+
+        // the same pseudo-random numbers for all the ways of formatting, without storing 100M numbers
+        class NumbersGenerator
+        {
+        public:
+            // ints of all the numbers of digits
+            int next_int() noexcept
+            {
+                const auto bits = next();
+                return static_cast<int>(static_cast<std::int32_t>(bits) >> (bits >> 59));
+            }
+
+            // doubles with all their significant digits, like the results of computations
+            double next_double() noexcept
+            {
+                return static_cast<double>(next() >> 11) * 0x1.0p-53 * 1e6 - 5e5;
+            }
+
+        private:
+            std::uint64_t next() noexcept
+            {
+                m_state ^= m_state << 13;
+                m_state ^= m_state >> 7;
+                m_state ^= m_state << 17;
+                return m_state;
+            }
+
+            std::uint64_t m_state = 0x2545F4914F6CDD1D;
+        };
+
+        TEST_CASE("ajcf::format_number vs std::to_string, std::stringstream and fmt::format",
+                  "[number_formatting][benchmark][!hide]")
+        {
+            constexpr int numbers_count = 100'000'000;
+
+            // the sizes are added so that the formatting is not optimized out
+            const auto print_numbers_per_second = [&](const char* name, auto&& format_next) {
+                NumbersGenerator generator;
+                std::size_t total_size = 0;
+                const auto start = std::chrono::steady_clock::now();
+                for (int index = 0; index != numbers_count; ++index)
+                    total_size += format_next(generator);
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                fmt::print("{:<40} {:>8.1f} M numbers/s ({} characters)\n", name, numbers_count / elapsed.count() / 1e6,
+                           total_size);
+            };
+
+            std::ostringstream stream;
+            char buffer[ajcf::max_formatted_size<double>];
+
+            fmt::print("{}M ints:\n", numbers_count / 1'000'000);
+            print_numbers_per_second("  std::to_string", [](auto& generator) {
+                return std::to_string(generator.next_int()).size();
+            });
+            print_numbers_per_second("  std::stringstream", [&](auto& generator) {
+                stream.str({});
+                stream << generator.next_int();
+                return stream.str().size();
+            });
+            print_numbers_per_second("  fmt::format", [](auto& generator) {
+                return fmt::format("{}", generator.next_int()).size();
+            });
+            print_numbers_per_second("  fmt::format_int", [](auto& generator) {
+                return fmt::format_int(generator.next_int()).size();
+            });
+            print_numbers_per_second("  std::to_chars", [&](auto& generator) {
+                return static_cast<std::size_t>(
+                    std::to_chars(buffer, buffer + sizeof(buffer), generator.next_int()).ptr - buffer);
+            });
+            print_numbers_per_second("  ajcf::format_number", [&](auto& generator) {
+                return static_cast<std::size_t>(ajcf::format_number(buffer, generator.next_int()) - buffer);
+            });
+
+            // only ajcf::format_number gives the shortest text to read back the same number: std::to_string gives
+            // 6 decimals, std::stringstream and fmt::format (version 6) give 6 significant digits
+            fmt::print("{}M doubles:\n", numbers_count / 1'000'000);
+            print_numbers_per_second("  std::to_string (not round-trip)", [](auto& generator) {
+                return std::to_string(generator.next_double()).size();
+            });
+            print_numbers_per_second("  std::stringstream (not round-trip)", [&](auto& generator) {
+                stream.str({});
+                stream << generator.next_double();
+                return stream.str().size();
+            });
+            print_numbers_per_second("  fmt::format (not round-trip)", [](auto& generator) {
+                return fmt::format("{}", generator.next_double()).size();
+            });
+            print_numbers_per_second("  ajcf::format_number", [&](auto& generator) {
+                return static_cast<std::size_t>(ajcf::format_number(buffer, generator.next_double()) - buffer);
+            });
+        }
+
+    } // namespace benchmarks
+
+} // namespace
@@ -0,0 +1,157 @@
+// https://en.cppreference.com/w/cpp/utility/to_chars
+// https://www.zverovich.net/2013/09/07/integer-to-string-conversion-in-cplusplus.html (digit pairs)
+// https://github.com/ulfjack/ryu (shortest round-trip floating point numbers, used by std::to_chars)
+
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ajcf {
+
+    // Number of characters enough to format any value of Number with ajcf::format_number
+    template <typename Number>
+    constexpr std::size_t max_formatted_size =
+        std::is_integral_v<Number>
+            ? std::numeric_limits<Number>::digits10 + 2 // the sign and the last digit
+            // sign, digits, point, 'e', sign of the exponent, digits of the exponent
+            : 1 + std::numeric_limits<Number>::max_digits10 + 1 + 2 +
+                  (std::numeric_limits<Number>::max_exponent10 >= 1000  ? 4
+                   : std::numeric_limits<Number>::max_exponent10 >= 100 ? 3
+                                                                        : 2);
+
+    namespace number_formatting_details {
+
+        // "00" "01" ... "99": the digits are written two at a time, with half the divisions
+        constexpr std::array<char, 200> make_digit_pairs() noexcept
+        {
+            std::array<char, 200> digit_pairs{};
+            for (std::size_t value = 0; value != 100; ++value)
+            {
+                digit_pairs[2 * value] = static_cast<char>('0' + value / 10);
+                digit_pairs[2 * value + 1] = static_cast<char>('0' + value % 10);
+            }
+            return digit_pairs;
+        }
+
+        constexpr auto digit_pairs = make_digit_pairs();
+
+        template <typename Unsigned>
+        constexpr int count_digits(Unsigned value) noexcept
+        {
+            int count = 1;
+            for (;;)
+            {
+                if (value < 10)
+                    return count;
+                if (value < 100)
+                    return count + 1;
+                if (value < 1000)
+                    return count + 2;
+                if (value < 10000)
+                    return count + 3;
+                value /= 10000;
+                count += 4;
+            }
+        }
+
+        // The digits are written from the end, the number of digits is known before
+        template <typename Unsigned>
+        char* write_digits(char* first, Unsigned value) noexcept
+        {
+            char* const last = first + count_digits(value);
+            char* digit = last;
+            while (value >= 100)
+            {
+                const auto pair = static_cast<std::size_t>(value % 100) * 2;
+                value /= 100;
+                digit -= 2;
+                digit[0] = digit_pairs[pair];
+                digit[1] = digit_pairs[pair + 1];
+            }
+            if (value >= 10)
+            {
+                const auto pair = static_cast<std::size_t>(value) * 2;
+                digit[-2] = digit_pairs[pair];
+                digit[-1] = digit_pairs[pair + 1];
+            }
+            else
+                digit[-1] = static_cast<char>('0' + value);
+            return last;
+        }
+
+    } // namespace number_formatting_details
+
+    // Write the number at buffer, which must have room for max_formatted_size<Number> characters,
+    // and return the end of the written characters: no locale, no dynamic allocation, no '\0' written
+    // - the integers are written with a table of digit pairs
+    // - the floating point numbers are written by std::to_chars with the shortest text which gives back the same
+    //   number when parsed ("0.1", not "0.10000000000000001" nor "0.100000"), "inf" and "nan" for the special values
+    //   char buffer[ajcf::max_formatted_size<int>];
+    //   const auto end = ajcf::format_number(buffer, -42); // std::string_view(buffer, end - buffer) == "-42"
+    template <typename Number>
+    char* format_number(char* buffer, Number value) noexcept
+    {
+        static_assert(std::is_arithmetic_v<Number> && !std::is_same_v<Number, bool>, "the type must be a number");
+
+        if constexpr (std::is_integral_v<Number>)
+        {
+            using Unsigned = std::make_unsigned_t<Number>;
+            auto unsigned_value = static_cast<Unsigned>(value);
+            if constexpr (std::is_signed_v<Number>)
+            {
+                if (value < 0)
+                {
+                    *buffer++ = '-';
+                    // computed on the unsigned type, to format the min of the type without overflow
+                    unsigned_value = static_cast<Unsigned>(Unsigned{0} - unsigned_value);
+                }
+            }
+            return number_formatting_details::write_digits(buffer, unsigned_value);
+        }
+        else
+            return std::to_chars(buffer, buffer + max_formatted_size<Number>, value).ptr;
+    }
+
+    // Text of a number, stored inside the object (like fmt::format_int, for all the numbers)
+    //   builder.append(ajcf::FormattedNumber{price}.view());
+    template <typename Number>
+    class FormattedNumber
+    {
+    public:
+        explicit FormattedNumber(Number value) noexcept
+            : m_size(static_cast<std::size_t>(format_number(m_characters.data(), value) - m_characters.data()))
+        {
+        }
+
+        const char* data() const noexcept
+        {
+            return m_characters.data();
+        }
+
+        std::size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        std::string_view view() const noexcept
+        {
+            return std::string_view(m_characters.data(), m_size);
+        }
+
+        std::string str() const
+        {
+            return std::string(m_characters.data(), m_size);
+        }
+
+    private:
+        std::array<char, max_formatted_size<Number>> m_characters;
+        std::size_t m_size;
+    };
+
+} // namespace ajcf
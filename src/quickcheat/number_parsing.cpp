@@ -0,0 +1,282 @@
+// https://en.cppreference.com/w/cpp/utility/from_chars
+// https://en.cppreference.com/w/cpp/string/basic_string/stol
+
+#include "number_parsing.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ajcf {
+
+    const char* to_string(ParseError error) noexcept
+    {
+        switch (error)
+        {
+        case ParseError::not_a_number:
+            return "not a number";
+        case ParseError::out_of_range:
+            return "number out of range";
+        case ParseError::trailing_characters:
+            return "characters after the number";
+        }
+        return "unknown parse error";
+    }
+
+    const ErrorCategory& error_category(ParseError) noexcept
+    {
+        static const EnumErrorCategory<ParseError> category{"parse"};
+        return category;
+    }
+
+} // namespace ajcf
+
+namespace {
+
+    using ajcf::ParseError;
+
+    static_assert(ajcf::number_parsing_details::are_eight_digits(0x3837363534333231)); // "12345678"
+    static_assert(!ajcf::number_parsing_details::are_eight_digits(0x3837363534333A31)); // "1:345678"
+    static_assert(ajcf::number_parsing_details::eight_digits_value(0x3837363534333231) == 12345678);
+
+    TEST_CASE("number parsing: integers", "[number_parsing]")
+    {
+        REQUIRE(ajcf::parse_number<int>("0") == 0);
+        REQUIRE(ajcf::parse_number<int>("42") == 42);
+        REQUIRE(ajcf::parse_number<int>("-42") == -42);
+        REQUIRE(ajcf::parse_number<int>("-0") == 0);
+        REQUIRE(ajcf::parse_number<int>("2147483647") == 2147483647);
+        REQUIRE(ajcf::parse_number<int>("-2147483648") == std::numeric_limits<int>::min());
+        REQUIRE(ajcf::parse_number<std::int64_t>("-9223372036854775808") == std::numeric_limits<std::int64_t>::min());
+        REQUIRE(ajcf::parse_number<std::uint64_t>("18446744073709551615") == std::numeric_limits<std::uint64_t>::max());
+        REQUIRE(ajcf::parse_number<std::uint8_t>("255") == 255);
+        REQUIRE(ajcf::parse_number<std::int64_t>("1234567890123456789") == 1234567890123456789);
+        // more than 19 digits, with the leading zeros
+        REQUIRE(ajcf::parse_number<int>("0000000000000000000000042") == 42);
+
+        REQUIRE(ajcf::parse_number<int>("").error() == ParseError::not_a_number);
+        REQUIRE(ajcf::parse_number<int>("-").error() == ParseError::not_a_number);
+        REQUIRE(ajcf::parse_number<int>("abc").error() == ParseError::not_a_number);
+        REQUIRE(ajcf::parse_number<int>(" 42").error() == ParseError::not_a_number);
+        REQUIRE(ajcf::parse_number<int>("+42").error() == ParseError::not_a_number);
+        REQUIRE(ajcf::parse_number<unsigned>("-42").error() == ParseError::not_a_number);
+        REQUIRE(ajcf::parse_number<int>("42 ").error() == ParseError::trailing_characters);
+        REQUIRE(ajcf::parse_number<int>("12345678x").error() == ParseError::trailing_characters);
+        REQUIRE(ajcf::parse_number<int>("0x10").error() == ParseError::trailing_characters);
+        REQUIRE(ajcf::parse_number<int>("2147483648").error() == ParseError::out_of_range);
+        REQUIRE(ajcf::parse_number<int>("-2147483649").error() == ParseError::out_of_range);
+        REQUIRE(ajcf::parse_number<std::uint8_t>("256").error() == ParseError::out_of_range);
+        REQUIRE(ajcf::parse_number<std::uint64_t>("18446744073709551616").error() == ParseError::out_of_range);
+        REQUIRE(ajcf::parse_number<int>("99999999999999999999999").error() == ParseError::out_of_range);
+
+        REQUIRE(std::string{ajcf::to_string(ParseError::out_of_range)} == "number out of range");
+        REQUIRE(ajcf::Error{ParseError::out_of_range}.to_string() == "parse: number out of range");
+        // 0 is not an error for the error categories
+        REQUIRE(ajcf::Error{ParseError::not_a_number}.code() != 0);
+    }
+
+    TEST_CASE("number parsing: spaces and '+' around the numbers", "[number_parsing]")
+    {
+        static_assert(ajcf::trim_number(" \t+42 \n") == "42");
+        static_assert(ajcf::trim_number("-42") == "-42");
+        static_assert(ajcf::trim_number("   ").empty());
+
+        REQUIRE(ajcf::parse_number<int>(ajcf::trim_number(" 78")) == 78);
+        REQUIRE(ajcf::parse_number<int>(ajcf::trim_number("+5")) == 5);
+        REQUIRE(ajcf::parse_number<int>(ajcf::trim_number(" -5 ")) == -5);
+        // one sign only, and still no trailing characters (accepted by std::stoi)
+        REQUIRE(ajcf::parse_number<int>(ajcf::trim_number("+-5")).error() == ParseError::not_a_number);
+        REQUIRE(ajcf::parse_number<int>(ajcf::trim_number("++5")).error() == ParseError::not_a_number);
+        REQUIRE(ajcf::parse_number<int>(ajcf::trim_number("12abc")).error() == ParseError::trailing_characters);
+        REQUIRE(ajcf::parse_number<int>(ajcf::trim_number("1 2")).error() == ParseError::trailing_characters);
+    }
+
+    TEST_CASE("number parsing: same results as std::from_chars", "[number_parsing]")
+    {
+        const auto same_as_from_chars = [](const std::string& text) {
+            std::int64_t value = 0;
+            const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+            const bool valid = error == std::errc{} && end == text.data() + text.size();
+            const auto result = ajcf::parse_number<std::int64_t>(text);
+            return valid ? result && *result == value : !result;
+        };
+
+        std::mt19937 random{42};
+        std::uniform_int_distribution<std::size_t> length_distribution(0, 24);
+        std::uniform_int_distribution<int> character_distribution(0, 11);
+        bool same_results = true;
+        for (int index = 0; index != 100'000; ++index)
+        {
+            // mostly digits, sometimes a minus or a letter anywhere
+            std::string text(length_distribution(random), '0');
+            for (auto& c : text)
+            {
+                const auto character = character_distribution(random);
+                c = character < 10 ? static_cast<char>('0' + character) : character == 10 ? '-' : 'x';
+            }
+            same_results = same_results && same_as_from_chars(text);
+        }
+
+        REQUIRE(same_results);
+    }
+
+    TEST_CASE("number parsing: floating point numbers", "[number_parsing]")
+    {
+        REQUIRE(ajcf::parse_number<double>("1.5") == 1.5);
+        REQUIRE(ajcf::parse_number<double>("-1e-3") == -0.001);
+        REQUIRE(ajcf::parse_number<double>("1e308") == 1e308);
+        REQUIRE(ajcf::parse_number<float>("0.25") == 0.25f);
+
+        // no locale: the decimal separator is always a point
+        REQUIRE(ajcf::parse_number<double>("1,5").error() == ParseError::trailing_characters);
+        REQUIRE(ajcf::parse_number<double>("1e400").error() == ParseError::out_of_range);
+        REQUIRE(ajcf::parse_number<double>(".").error() == ParseError::not_a_number);
+    }
+
+    namespace benchmarks {
+
+        // like function_which_takes_a_string_and_returns_an_int_or_error in exceptions.cpp, before ajcf::parse_number
+        tl::expected<int, std::exception_ptr> parse_with_istringstream(const std::string& text) noexcept
+        {
+            try
+            {
+                std::istringstream iss(text);
+                int value{};
+                iss >> value;
+                if (iss.fail() || iss.peek() != std::istringstream::traits_type::eof())
+                    throw std::domain_error{"string does not contain a number"};
+                return value;
+            }
+            catch (const std::exception&)
+            {
+                return tl::make_unexpected(std::current_exception());
+            }
+        }
+
+        // like the calculators in function_objects.cpp, before ajcf::parse_number
+        tl::expected<int, std::exception_ptr> parse_with_stoi(const std::string& text) noexcept
+        {
+            try
+            {
+                std::size_t end = 0;
+                const auto value = std::stoi(text, &end);
+                if (end != text.size())
+                    throw std::invalid_argument{"characters after the number"};
+                return value;
+            }
+            catch (const std::exception&)
+            {
+                return tl::make_unexpected(std::current_exception());
+            }
+        }
+
+        tl::expected<double, std::exception_ptr> parse_with_stod(const std::string& text) noexcept
+        {
+            try
+            {
+                std::size_t end = 0;
+                const auto value = std::stod(text, &end);
+                if (end != text.size())
+                    throw std::invalid_argument{"characters after the number"};
+                return value;
+            }
+            catch (const std::exception&)
+            {
+                return tl::make_unexpected(std::current_exception());
+            }
+        }
+
+        TEST_CASE("ajcf::parse_number vs std::istringstream, std::stoi and std::from_chars",
+                  "[number_parsing][benchmark][!hide]")
+        {
+            constexpr std::size_t numbers_count = 1'000'000;
+            std::mt19937 random{42};
+            std::uniform_int_distribution<int> digits_count_distribution(1, 9);
+            std::uniform_real_distribution<double> double_distribution(-1e6, 1e6);
+
+            std::vector<std::string> valid_ints(numbers_count);
+            for (auto& text : valid_ints)
+            {
+                text = std::to_string(random() % 1'000'000'000);
+                text.resize(std::min<std::size_t>(text.size(), digits_count_distribution(random)));
+            }
+            std::vector<std::string> valid_doubles(numbers_count);
+            for (auto& text : valid_doubles)
+                text = fmt::format("{}", double_distribution(random));
+            // not a number, out of range, trailing characters
+            std::vector<std::string> invalid_numbers(numbers_count);
+            for (std::size_t index = 0; index != numbers_count; ++index)
+                invalid_numbers[index] = index % 3 == 0 ? "abc" : index % 3 == 1 ? "99999999999" : "1234x";
+
+            const auto print_numbers_per_second = [&](const char* name, const std::vector<std::string>& texts,
+                                                      auto&& parse) {
+                double best_seconds = 1e9;
+                double total = 0;
+                for (int run = 0; run != 3; ++run)
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    total = 0;
+                    for (const auto& text : texts)
+                    {
+                        const auto value = parse(text);
+                        total += value ? static_cast<double>(*value) : 1;
+                    }
+                    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                    best_seconds = std::min(best_seconds, elapsed.count());
+                }
+                fmt::print("{:<48} {:>8.2f} M numbers/s (total {})\n", name,
+                           static_cast<double>(texts.size()) / best_seconds / 1e6, total);
+            };
+
+            const auto from_chars_int = [](const std::string& text) -> tl::expected<int, std::errc> {
+                int value = 0;
+                const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+                if (error != std::errc{} || end != text.data() + text.size())
+                    return tl::make_unexpected(std::errc::invalid_argument);
+                return value;
+            };
+
+            for (const auto* texts : {&valid_ints, &invalid_numbers})
+            {
+                fmt::print("{} ints:\n", texts == &valid_ints ? "valid" : "invalid");
+                print_numbers_per_second("  std::istringstream and exceptions", *texts, &parse_with_istringstream);
+                print_numbers_per_second("  std::stoi and exceptions", *texts, &parse_with_stoi);
+                print_numbers_per_second("  std::from_chars", *texts, from_chars_int);
+                print_numbers_per_second("  ajcf::parse_number<int>", *texts,
+                                         [](const std::string& text) { return ajcf::parse_number<int>(text); });
+            }
+
+            fmt::print("valid doubles:\n");
+            print_numbers_per_second("  std::stod and exceptions", valid_doubles, &parse_with_stod);
+            print_numbers_per_second("  ajcf::parse_number<double>", valid_doubles,
+                                     [](const std::string& text) { return ajcf::parse_number<double>(text); });
+
+            // long integers, where the 8 digits runs are used
+            std::vector<std::string> long_ints(numbers_count);
+            for (auto& text : long_ints)
+            {
+                const auto value = random() * std::uint64_t{4'294'967'296} + random();
+                text = std::to_string(value % 10'000'000'000'000'000'000U);
+            }
+            const auto from_chars_uint64 = [](const std::string& text) -> tl::expected<std::uint64_t, std::errc> {
+                std::uint64_t value = 0;
+                const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+                if (error != std::errc{} || end != text.data() + text.size())
+                    return tl::make_unexpected(std::errc::invalid_argument);
+                return value;
+            };
+            fmt::print("valid uint64s of up to 19 digits:\n");
+            print_numbers_per_second("  std::from_chars", long_ints, from_chars_uint64);
+            print_numbers_per_second("  ajcf::parse_number<std::uint64_t>", long_ints,
+                                     [](const std::string& text) { return ajcf::parse_number<std::uint64_t>(text); });
+        }
+
+    } // namespace benchmarks
+
+} // namespace
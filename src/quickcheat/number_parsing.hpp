@@ -0,0 +1,169 @@
+// https://en.cppreference.com/w/cpp/utility/from_chars
+// https://lemire.me/blog/2022/01/21/swar-explained-parsing-eight-digits/
+
+#pragma once
+
+#include "error_code.hpp"
+#include <tl/expected.hpp>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+// the 8 digits fast path reads the first character in the lowest byte
+#if defined(_MSC_VER) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define AJCF_LITTLE_ENDIAN 1
+#else
+#define AJCF_LITTLE_ENDIAN 0
+#endif
+
+namespace ajcf {
+
+    enum class ParseError
+    {
+        not_a_number = 1,    // empty, or does not start with a digit (or '-' and a digit for the signed types)
+        out_of_range,        // the number does not fit in the type
+        trailing_characters, // the number is followed by other characters
+    };
+
+    const char* to_string(ParseError error) noexcept;
+    // the parse errors can be converted to ajcf::Error
+    const ErrorCategory& error_category(ParseError) noexcept;
+
+    namespace number_parsing_details {
+
+        inline std::uint64_t load_eight_characters(const char* first) noexcept
+        {
+            std::uint64_t chunk;
+            std::memcpy(&chunk, first, sizeof(chunk));
+            return chunk;
+        }
+
+        // All the bytes are in '0'..'9': the high nibble is 3, and adding 6 does not carry out of the low nibble
+        constexpr bool are_eight_digits(std::uint64_t chunk) noexcept
+        {
+            return ((chunk & 0xF0F0F0F0F0F0F0F0) | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+                   0x3333333333333333;
+        }
+
+        // Value of 8 digits in 3 multiplications instead of 8: the digits are combined by pairs, then by 4
+        constexpr std::uint64_t eight_digits_value(std::uint64_t chunk) noexcept
+        {
+            chunk -= 0x3030303030303030;
+            chunk = chunk * 10 + (chunk >> 8);
+            return (((chunk & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+                    (((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >>
+                   32;
+        }
+
+        // 19 digits always fit in an uint64_t
+        constexpr std::ptrdiff_t max_fast_digits = std::numeric_limits<std::uint64_t>::digits10;
+
+        template <typename Number>
+        tl::expected<Number, ParseError> from_chars(const char* first, const char* last) noexcept
+        {
+            Number value{};
+            const auto [end, error] = std::from_chars(first, last, value);
+            if (error == std::errc::invalid_argument)
+                return tl::make_unexpected(ParseError::not_a_number);
+            if (error == std::errc::result_out_of_range)
+                return tl::make_unexpected(ParseError::out_of_range);
+            if (end != last)
+                return tl::make_unexpected(ParseError::trailing_characters);
+            return value;
+        }
+
+        template <typename Integer>
+        tl::expected<Integer, ParseError> parse_integer(std::string_view text) noexcept
+        {
+            const char* const last = text.data() + text.size();
+            const char* first = text.data();
+            bool negative = false;
+            if constexpr (std::is_signed_v<Integer>)
+            {
+                if (first != last && *first == '-')
+                {
+                    negative = true;
+                    ++first;
+                }
+            }
+
+            std::uint64_t value = 0;
+            const char* digit = first;
+            if constexpr (AJCF_LITTLE_ENDIAN)
+            {
+                // two runs of 8 digits at most, so that the digits which follow cannot overflow
+                for (int run = 0; run != 2 && last - digit >= 8; ++run)
+                {
+                    const auto chunk = load_eight_characters(digit);
+                    if (!are_eight_digits(chunk))
+                        break;
+                    value = value * 100000000 + eight_digits_value(chunk);
+                    digit += 8;
+                }
+            }
+            while (digit != last && digit - first != max_fast_digits)
+            {
+                const auto digit_value = static_cast<unsigned char>(*digit - '0');
+                if (digit_value > 9)
+                    break;
+                value = value * 10 + digit_value;
+                ++digit;
+            }
+
+            if (digit == first)
+                return tl::make_unexpected(ParseError::not_a_number);
+            // more than 19 digits (maybe leading zeros): the general algorithm
+            if (digit != last && static_cast<unsigned char>(*digit - '0') <= 9)
+                return from_chars<Integer>(text.data(), last);
+
+            using Unsigned = std::make_unsigned_t<Integer>;
+            const auto max_value = static_cast<std::uint64_t>(std::numeric_limits<Integer>::max()) + (negative ? 1 : 0);
+            if (value > max_value)
+                return tl::make_unexpected(ParseError::out_of_range);
+            if (digit != last)
+                return tl::make_unexpected(ParseError::trailing_characters);
+            // -value computed on the unsigned type, to get the min of the type without overflow
+            const auto result = static_cast<Unsigned>(value);
+            return static_cast<Integer>(negative ? static_cast<Unsigned>(Unsigned{0} - result) : result);
+        }
+
+    } // namespace number_parsing_details
+
+    // Number of the whole text, like std::from_chars: no exception, no locale, no dynamic allocation,
+    // no leading space nor '+' (and no "0x" prefix)
+    // The integers of up to 19 digits are parsed 8 digits at once (SWAR: SIMD within a register),
+    // the floating point numbers and the longer integers by std::from_chars
+    //   ajcf::parse_number<int>("-42");      // -42
+    //   ajcf::parse_number<int>("42 apples"); // tl::unexpected{ajcf::ParseError::trailing_characters}
+    //   ajcf::parse_number<double>("1e-3");   // 0.001
+    template <typename Number>
+    tl::expected<Number, ParseError> parse_number(std::string_view text) noexcept
+    {
+        static_assert(std::is_arithmetic_v<Number> && !std::is_same_v<Number, bool>, "the type must be a number");
+
+        if constexpr (std::is_integral_v<Number>)
+            return number_parsing_details::parse_integer<Number>(text);
+        else
+            return number_parsing_details::from_chars<Number>(text.data(), text.data() + text.size());
+    }
+
+    // The text of a number in a bigger text, without the spaces around it nor a '+' before its digits, which
+    // std::stoi and the >> of the streams accept, but not ajcf::parse_number
+    //   ajcf::parse_number<int>(ajcf::trim_number(" +42 ")); // 42
+    constexpr std::string_view trim_number(std::string_view text) noexcept
+    {
+        constexpr std::string_view spaces = " \t\n\r\v\f";
+        const auto first = text.find_first_not_of(spaces);
+        if (first == std::string_view::npos)
+            return text.substr(text.size());
+        text = text.substr(first, text.find_last_not_of(spaces) - first + 1);
+        if (text.size() > 1 && text[0] == '+' && text[1] >= '0' && text[1] <= '9')
+            text.remove_prefix(1);
+        return text;
+    }
+
+} // namespace ajcf
@@ -0,0 +1,337 @@
+// https://en.cppreference.com/w/cpp/memory/c/realloc
+// https://man7.org/linux/man-pages/man2/mremap.2.html
+// https://man7.org/linux/man-pages/man3/malloc_usable_size.3.html
+
+#include "relocating_vector.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define AJCF_RELOCATION_USE_MREMAP 1
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace ajcf::relocation {
+
+    namespace {
+
+        Buffer allocate_with_malloc(std::size_t bytes)
+        {
+            void* const data = std::malloc(bytes);
+            if (!data)
+                throw std::bad_alloc();
+#if defined(__GLIBC__)
+            // malloc often returns a bit more than requested: use it as free capacity
+            return Buffer{data, ::malloc_usable_size(data), false};
+#else
+            return Buffer{data, bytes, false};
+#endif
+        }
+
+#if defined(AJCF_RELOCATION_USE_MREMAP)
+        std::size_t round_to_pages(std::size_t bytes) noexcept
+        {
+            static const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            return (bytes + page_size - 1) / page_size * page_size;
+        }
+
+        Buffer allocate_with_mmap(std::size_t bytes)
+        {
+            const auto mapped_bytes = round_to_pages(bytes);
+            void* const data =
+                ::mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (data == MAP_FAILED)
+                throw std::bad_alloc();
+            return Buffer{data, mapped_bytes, true};
+        }
+#endif
+
+    } // namespace
+
+    Buffer allocate(std::size_t bytes)
+    {
+        if (bytes == 0)
+            return Buffer{};
+#if defined(AJCF_RELOCATION_USE_MREMAP)
+        if (bytes >= mmap_threshold)
+            return allocate_with_mmap(bytes);
+#endif
+        return allocate_with_malloc(bytes);
+    }
+
+    Buffer reallocate(Buffer buffer, std::size_t bytes)
+    {
+        if (!buffer.data)
+            return allocate(bytes);
+
+#if defined(AJCF_RELOCATION_USE_MREMAP)
+        if (buffer.mapped)
+        {
+            // the kernel moves the pages if needed: the content is never copied
+            const auto mapped_bytes = round_to_pages(bytes);
+            void* const data = ::mremap(buffer.data, buffer.bytes, mapped_bytes, MREMAP_MAYMOVE);
+            if (data == MAP_FAILED)
+                throw std::bad_alloc();
+            return Buffer{data, mapped_bytes, true};
+        }
+
+        if (bytes >= mmap_threshold)
+        {
+            // copy once from the heap to a mapping, then the buffer will only grow with mremap
+            const auto new_buffer = allocate_with_mmap(bytes);
+            std::memcpy(new_buffer.data, buffer.data, std::min(buffer.bytes, bytes));
+            std::free(buffer.data);
+            return new_buffer;
+        }
+#endif
+
+        void* const data = std::realloc(buffer.data, bytes);
+        if (!data)
+            throw std::bad_alloc();
+#if defined(__GLIBC__)
+        return Buffer{data, ::malloc_usable_size(data), false};
+#else
+        return Buffer{data, bytes, false};
+#endif
+    }
+
+    bool try_expand_in_place(Buffer& buffer, std::size_t bytes) noexcept
+    {
+        if (bytes <= buffer.bytes)
+            return true;
+
+#if defined(AJCF_RELOCATION_USE_MREMAP)
+        if (buffer.mapped)
+        {
+            // without MREMAP_MAYMOVE, the mapping grows only if the following virtual addresses are free
+            const auto mapped_bytes = round_to_pages(bytes);
+            if (::mremap(buffer.data, buffer.bytes, mapped_bytes, 0) == MAP_FAILED)
+                return false;
+            buffer.bytes = mapped_bytes;
+            return true;
+        }
+#endif
+
+        // note: the heap does not offer a portable way to grow a block without moving it
+        // (but the slack returned by malloc_usable_size is already part of the capacity)
+        return false;
+    }
+
+    void deallocate(Buffer buffer) noexcept
+    {
+        if (!buffer.data)
+            return;
+#if defined(AJCF_RELOCATION_USE_MREMAP)
+        if (buffer.mapped)
+        {
+            ::munmap(buffer.data, buffer.bytes);
+            return;
+        }
+#endif
+        std::free(buffer.data);
+    }
+
+} // namespace ajcf::relocation
+
+namespace {
+
+    struct MovableButNotTriviallyRelocatable
+    {
+        std::string text;
+    };
+
+    struct OptedInAsTriviallyRelocatable
+    {
+        std::unique_ptr<int> pointer;
+    };
+
+} // namespace
+
+// std::unique_ptr only holds a pointer: its bytes can be relocated safely
+template <>
+struct ajcf::is_trivially_relocatable<OptedInAsTriviallyRelocatable> : std::true_type
+{
+};
+
+namespace {
+
+    TEST_CASE("relocating vector basics", "[relocation][allocation]")
+    {
+        ajcf::RelocatingVector<int> vec{1, 2, 3};
+
+        REQUIRE(vec.size() == 3);
+        REQUIRE(vec[1] == 2);
+
+        for (int i = 4; i <= 100; ++i)
+            vec.push_back(i);
+
+        REQUIRE(vec.size() == 100);
+        REQUIRE(vec.back() == 100);
+        for (int i = 0; i != 100; ++i)
+            REQUIRE(vec[i] == i + 1);
+
+        // push_back of one of the vector's own elements while the vector grows
+        vec.shrink_to_fit();
+        vec.push_back(vec[0]);
+
+        REQUIRE(vec.back() == 1);
+
+        vec.resize(10);
+
+        REQUIRE(vec == ajcf::RelocatingVector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+
+        vec.resize(12, 42);
+
+        REQUIRE(vec == ajcf::RelocatingVector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 42, 42});
+
+        auto copy = vec;
+        vec.clear();
+
+        REQUIRE(vec.empty());
+        REQUIRE(copy.size() == 12);
+    }
+
+    TEST_CASE("relocating vector growth factor", "[relocation][allocation]")
+    {
+        ajcf::RelocatingVector<int, std::ratio<2, 1>> doubling;
+        ajcf::RelocatingVector<int, std::ratio<3, 2>> one_and_a_half;
+
+        std::size_t doubling_growths = 0;
+        std::size_t one_and_a_half_growths = 0;
+        bool growths_respect_factors = true;
+        for (int i = 0; i != 100'000; ++i)
+        {
+            const auto doubling_capacity = doubling.capacity();
+            const auto one_and_a_half_capacity = one_and_a_half.capacity();
+            doubling.push_back(i);
+            one_and_a_half.push_back(i);
+            if (doubling.capacity() != doubling_capacity)
+            {
+                growths_respect_factors &= doubling.capacity() >= doubling_capacity * 2;
+                ++doubling_growths;
+            }
+            if (one_and_a_half.capacity() != one_and_a_half_capacity)
+            {
+                growths_respect_factors &= one_and_a_half.capacity() >= one_and_a_half_capacity * 3 / 2;
+                ++one_and_a_half_growths;
+            }
+        }
+
+        REQUIRE(growths_respect_factors);
+
+        // a bigger growth factor means less growths but more unused capacity
+        REQUIRE(doubling_growths < one_and_a_half_growths);
+    }
+
+    TEST_CASE("relocating vector with non trivially relocatable elements", "[relocation][allocation]")
+    {
+        REQUIRE(!ajcf::RelocatingVector<MovableButNotTriviallyRelocatable>::relocates_trivially);
+
+        ajcf::RelocatingVector<MovableButNotTriviallyRelocatable> vec;
+        for (int i = 0; i != 1000; ++i)
+            vec.push_back({std::string(50, static_cast<char>('a' + i % 26))});
+
+        REQUIRE(vec.statistics().element_moves > 0);
+        for (int i = 0; i != 1000; ++i)
+            REQUIRE(vec[i].text == std::string(50, static_cast<char>('a' + i % 26)));
+    }
+
+    TEST_CASE("relocating vector with opted-in trivially relocatable elements", "[relocation][allocation]")
+    {
+        REQUIRE(ajcf::RelocatingVector<OptedInAsTriviallyRelocatable>::relocates_trivially);
+
+        ajcf::RelocatingVector<OptedInAsTriviallyRelocatable> vec;
+        for (int i = 0; i != 1000; ++i)
+            vec.push_back({std::make_unique<int>(i)});
+
+        REQUIRE(vec.statistics().element_moves == 0);
+        for (int i = 0; i != 1000; ++i)
+            REQUIRE(*vec[i].pointer == i);
+    }
+
+    TEST_CASE("relocating vector of big buffers", "[relocation][allocation]")
+    {
+        // grows beyond relocation::mmap_threshold
+        ajcf::RelocatingVector<std::array<int, 16>> vec;
+        for (int i = 0; i != 100'000; ++i)
+            vec.push_back({i, i + 1});
+
+        REQUIRE(vec.size() * sizeof(vec[0]) > ajcf::relocation::mmap_threshold);
+        REQUIRE(vec.statistics().element_moves == 0);
+        int i = 0;
+        const auto all_values_kept = std::all_of(vec.begin(), vec.end(), [&i](const auto& element) {
+            const bool kept = element[0] == i && element[1] == i + 1;
+            ++i;
+            return kept;
+        });
+
+        REQUIRE(all_values_kept);
+    }
+
+    namespace benchmarks {
+
+        // big trivially relocatable struct
+        struct Sample
+        {
+            std::array<double, 32> values;
+        };
+
+        template <typename Vector>
+        auto push_back_samples(std::size_t count)
+        {
+            Vector vec;
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                Sample sample{};
+                sample.values[0] = static_cast<double>(i);
+                vec.push_back(sample);
+            }
+            return vec.size();
+        }
+
+        TEST_CASE("relocating vector vs std::vector: push_back of big structs",
+                  "[relocation][allocation][benchmark][!hide]")
+        {
+            constexpr std::size_t count = 1'000'000;
+
+            BENCHMARK("std::vector")
+            {
+                return push_back_samples<std::vector<Sample>>(count);
+            };
+
+            BENCHMARK("RelocatingVector growth 3/2")
+            {
+                return push_back_samples<ajcf::RelocatingVector<Sample, std::ratio<3, 2>>>(count);
+            };
+
+            BENCHMARK("RelocatingVector growth 2")
+            {
+                return push_back_samples<ajcf::RelocatingVector<Sample, std::ratio<2, 1>>>(count);
+            };
+
+            BENCHMARK("RelocatingVector growth 4")
+            {
+                return push_back_samples<ajcf::RelocatingVector<Sample, std::ratio<4, 1>>>(count);
+            };
+
+            ajcf::RelocatingVector<Sample> vec;
+            for (std::size_t i = 0; i != count; ++i)
+                vec.push_back(Sample{});
+            fmt::print("RelocatingVector growth 3/2: {} in-place expansions, {} relocations, {} element moves\n",
+                       vec.statistics().in_place_expansions, vec.statistics().relocations,
+                       vec.statistics().element_moves);
+        }
+
+    } // namespace benchmarks
+
+} // namespace
@@ -0,0 +1,371 @@
+// https://en.cppreference.com/w/cpp/types/is_trivially_copyable
+// https://en.cppreference.com/w/cpp/memory/c/realloc
+// https://man7.org/linux/man-pages/man2/mremap.2.html
+// http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2020/p1144r5.html (trivially relocatable)
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <ratio>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace ajcf {
+
+    // A type is trivially relocatable if moving an object to a new address then destroying the original
+    // is equivalent to copying its bytes (memcpy, realloc, mremap...)
+    // All trivially copyable types are, and one can opt-in other types by specializing this trait:
+    //   template <> struct ajcf::is_trivially_relocatable<MyType> : std::true_type {};
+    template <typename T>
+    struct is_trivially_relocatable : std::is_trivially_copyable<T>
+    {
+    };
+
+    template <typename T>
+    inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+    namespace relocation {
+
+        // Buffers of at least mmap_threshold bytes are mapped directly from the OS (on Linux),
+        // so that they can grow with mremap: the pages are moved by the kernel, the bytes are never copied
+        constexpr std::size_t mmap_threshold = 1024 * 1024;
+
+        struct Buffer
+        {
+            void* data{};
+            std::size_t bytes{}; // usable bytes, can be more than requested
+            bool mapped{};       // mapped directly from the OS instead of allocated with malloc
+        };
+
+        // Allocate a buffer of at least bytes bytes
+        // Throw std::bad_alloc if no memory is available
+        Buffer allocate(std::size_t bytes);
+
+        // Grow or shrink the buffer to at least bytes bytes, possibly moving its content to a new address
+        // Throw std::bad_alloc if no memory is available (the buffer is then left untouched)
+        Buffer reallocate(Buffer buffer, std::size_t bytes);
+
+        // Try to grow the buffer to at least bytes bytes without moving it
+        // Return false if it is not possible (the buffer is then left untouched)
+        bool try_expand_in_place(Buffer& buffer, std::size_t bytes) noexcept;
+
+        void deallocate(Buffer buffer) noexcept;
+
+    } // namespace relocation
+
+    // Statistics about the growths of a RelocatingVector's storage
+    struct RelocationStatistics
+    {
+        std::size_t in_place_expansions{}; // the storage was expanded without changing address
+        std::size_t relocations{};         // the storage changed address
+        std::size_t element_moves{};       // elements moved one by one (only for non trivially relocatable types)
+    };
+
+    // Vector which avoids copying its elements when it grows:
+    // - the capacity grows by a configurable factor (Growth, 3/2 by default)
+    // - the storage first tries to expand in place
+    // - trivially relocatable elements are relocated with realloc/mremap instead of being moved one by one
+    template <typename T, typename Growth = std::ratio<3, 2>>
+    class RelocatingVector
+    {
+        static_assert(Growth::num > Growth::den, "the growth factor must be greater than 1");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        static constexpr bool relocates_trivially = is_trivially_relocatable_v<T>;
+
+        RelocatingVector() = default;
+
+        explicit RelocatingVector(size_type count)
+        {
+            resize(count);
+        }
+
+        RelocatingVector(size_type count, const T& value)
+        {
+            resize(count, value);
+        }
+
+        RelocatingVector(std::initializer_list<T> values)
+        {
+            reserve(values.size());
+            for (const auto& value : values)
+                emplace_back(value);
+        }
+
+        RelocatingVector(const RelocatingVector& other)
+        {
+            reserve(other.size());
+            for (const auto& value : other)
+                emplace_back(value);
+        }
+
+        RelocatingVector(RelocatingVector&& other) noexcept
+            : m_buffer(std::exchange(other.m_buffer, relocation::Buffer{})), m_size(std::exchange(other.m_size, 0))
+        {
+        }
+
+        ~RelocatingVector()
+        {
+            clear();
+            relocation::deallocate(m_buffer);
+        }
+
+        RelocatingVector& operator=(const RelocatingVector& other)
+        {
+            RelocatingVector(other).swap(*this);
+            return *this;
+        }
+
+        RelocatingVector& operator=(RelocatingVector&& other) noexcept
+        {
+            RelocatingVector(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        void swap(RelocatingVector& other) noexcept
+        {
+            std::swap(m_buffer, other.m_buffer);
+            std::swap(m_size, other.m_size);
+            std::swap(m_statistics, other.m_statistics);
+        }
+
+        size_type size() const noexcept
+        {
+            return m_size;
+        }
+
+        size_type capacity() const noexcept
+        {
+            return m_buffer.bytes / sizeof(T);
+        }
+
+        bool empty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        T* data() noexcept
+        {
+            return static_cast<T*>(m_buffer.data);
+        }
+
+        const T* data() const noexcept
+        {
+            return static_cast<const T*>(m_buffer.data);
+        }
+
+        iterator begin() noexcept
+        {
+            return data();
+        }
+
+        iterator end() noexcept
+        {
+            return data() + m_size;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return data();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return data() + m_size;
+        }
+
+        T& operator[](size_type index) noexcept
+        {
+            return data()[index];
+        }
+
+        const T& operator[](size_type index) const noexcept
+        {
+            return data()[index];
+        }
+
+        T& back() noexcept
+        {
+            return data()[m_size - 1];
+        }
+
+        const T& back() const noexcept
+        {
+            return data()[m_size - 1];
+        }
+
+        const RelocationStatistics& statistics() const noexcept
+        {
+            return m_statistics;
+        }
+
+        void reserve(size_type wanted_capacity)
+        {
+            if (wanted_capacity > capacity())
+                change_capacity(wanted_capacity);
+        }
+
+        template <typename... Args>
+        T& emplace_back(Args&&... args)
+        {
+            if (m_size == capacity())
+            {
+                // the arguments may refer to an element of this vector: build the new element before relocating
+                T new_element(std::forward<Args>(args)...);
+                change_capacity(next_capacity(m_size + 1));
+                T* const element = ::new (static_cast<void*>(data() + m_size)) T(std::move(new_element));
+                ++m_size;
+                return *element;
+            }
+            T* const element = ::new (static_cast<void*>(data() + m_size)) T(std::forward<Args>(args)...);
+            ++m_size;
+            return *element;
+        }
+
+        void push_back(const T& value)
+        {
+            emplace_back(value);
+        }
+
+        void push_back(T&& value)
+        {
+            emplace_back(std::move(value));
+        }
+
+        void pop_back() noexcept
+        {
+            --m_size;
+            std::destroy_at(data() + m_size);
+        }
+
+        void resize(size_type new_size)
+        {
+            resize_with(new_size, [](T* element) { ::new (static_cast<void*>(element)) T(); });
+        }
+
+        void resize(size_type new_size, const T& value)
+        {
+            // the value may refer to an element of this vector: copy it before relocating
+            const T copied_value(value);
+            resize_with(new_size, [&copied_value](T* element) { ::new (static_cast<void*>(element)) T(copied_value); });
+        }
+
+        void clear() noexcept
+        {
+            std::destroy(begin(), end());
+            m_size = 0;
+        }
+
+        void shrink_to_fit()
+        {
+            if (m_size == 0)
+            {
+                relocation::deallocate(std::exchange(m_buffer, relocation::Buffer{}));
+                return;
+            }
+            if (m_size < capacity())
+                change_capacity(m_size);
+        }
+
+    private:
+        template <typename Construct>
+        void resize_with(size_type new_size, Construct construct)
+        {
+            if (new_size <= m_size)
+            {
+                std::destroy(begin() + new_size, end());
+                m_size = new_size;
+                return;
+            }
+            if (new_size > capacity())
+                change_capacity(std::max(new_size, next_capacity(new_size)));
+            for (; m_size != new_size; ++m_size)
+                construct(data() + m_size);
+        }
+
+        size_type next_capacity(size_type required_capacity) const noexcept
+        {
+            const auto grown_capacity = capacity() / Growth::den * Growth::num + capacity() % Growth::den;
+            return std::max({required_capacity, grown_capacity, size_type{4}});
+        }
+
+        void change_capacity(size_type new_capacity)
+        {
+            if (new_capacity > static_cast<size_type>(-1) / sizeof(T))
+                throw std::length_error("RelocatingVector is too long");
+
+            const auto new_bytes = new_capacity * sizeof(T);
+            const void* const old_data = m_buffer.data;
+
+            if (m_buffer.data && new_bytes > m_buffer.bytes && relocation::try_expand_in_place(m_buffer, new_bytes))
+            {
+                ++m_statistics.in_place_expansions;
+                return;
+            }
+
+            if constexpr (relocates_trivially)
+            {
+                // the bytes of the elements are moved by realloc/mremap, without calling any constructor
+                m_buffer = relocation::reallocate(m_buffer, new_bytes);
+            }
+            else
+            {
+                auto new_buffer = relocation::allocate(new_bytes);
+                T* const new_data = static_cast<T*>(new_buffer.data);
+                size_type moved_count = 0;
+                try
+                {
+                    for (; moved_count != m_size; ++moved_count)
+                    {
+                        auto& moved_element = data()[moved_count];
+                        ::new (static_cast<void*>(new_data + moved_count)) T(std::move_if_noexcept(moved_element));
+                    }
+                }
+                catch (...)
+                {
+                    std::destroy(new_data, new_data + moved_count);
+                    relocation::deallocate(new_buffer);
+                    throw;
+                }
+                std::destroy(begin(), end());
+                relocation::deallocate(m_buffer);
+                m_buffer = new_buffer;
+                m_statistics.element_moves += moved_count;
+            }
+
+            if (old_data == m_buffer.data)
+                ++m_statistics.in_place_expansions;
+            else if (old_data)
+                ++m_statistics.relocations;
+        }
+
+        relocation::Buffer m_buffer{};
+        size_type m_size{};
+        RelocationStatistics m_statistics{};
+    };
+
+    template <typename T, typename Growth>
+    bool operator==(const RelocatingVector<T, Growth>& left, const RelocatingVector<T, Growth>& right)
+    {
+        return std::equal(left.begin(), left.end(), right.begin(), right.end());
+    }
+
+    template <typename T, typename Growth>
+    bool operator!=(const RelocatingVector<T, Growth>& left, const RelocatingVector<T, Growth>& right)
+    {
+        return !(left == right);
+    }
+
+} // namespace ajcf
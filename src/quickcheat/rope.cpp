@@ -0,0 +1,490 @@
+// https://en.wikipedia.org/wiki/Rope_(data_structure)
+// https://en.wikipedia.org/wiki/AVL_tree (join and split)
+
+#include "rope.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace ajcf {
+
+    namespace {
+
+        using Node = detail::RopeNode;
+        using NodePointer = std::shared_ptr<const Node>;
+
+        int height_of(const NodePointer& node) noexcept
+        {
+            return node ? node->height : -1;
+        }
+
+        NodePointer make_leaf(std::shared_ptr<const std::string> text, std::size_t offset, std::size_t size)
+        {
+            if (size == 0)
+                return nullptr;
+            auto leaf = std::make_shared<Node>();
+            leaf->text = std::move(text);
+            leaf->offset = offset;
+            leaf->size = size;
+            return leaf;
+        }
+
+        NodePointer make_leaf(std::string&& text)
+        {
+            const auto size = text.size();
+            return make_leaf(std::make_shared<const std::string>(std::move(text)), 0, size);
+        }
+
+        // left and right must not be empty
+        NodePointer make_node(NodePointer left, NodePointer right)
+        {
+            auto node = std::make_shared<Node>();
+            node->size = left->size + right->size;
+            node->height = 1 + std::max(left->height, right->height);
+            node->left = std::move(left);
+            node->right = std::move(right);
+            return node;
+        }
+
+        // Concatenation of two trees whose heights differ by at most 2, with an AVL rotation if needed
+        NodePointer balance(const NodePointer& left, const NodePointer& right)
+        {
+            if (height_of(left) > height_of(right) + 1)
+            {
+                if (height_of(left->left) >= height_of(left->right))
+                    return make_node(left->left, make_node(left->right, right));
+                return make_node(make_node(left->left, left->right->left), make_node(left->right->right, right));
+            }
+            if (height_of(right) > height_of(left) + 1)
+            {
+                if (height_of(right->right) >= height_of(right->left))
+                    return make_node(make_node(left, right->left), right->right);
+                return make_node(make_node(left, right->left->left), make_node(right->left->right, right->right));
+            }
+            return make_node(left, right);
+        }
+
+        // Concatenation of two balanced trees, in O(difference of heights)
+        NodePointer join(const NodePointer& left, const NodePointer& right)
+        {
+            if (!left)
+                return right;
+            if (!right)
+                return left;
+
+            if (left->is_leaf() && right->is_leaf() && left->size + right->size <= Rope::small_chunk_size)
+            {
+                // avoid leaves of a few characters after many insertions or erasures
+                std::string text;
+                text.reserve(left->size + right->size);
+                text += left->chunk();
+                text += right->chunk();
+                return make_leaf(std::move(text));
+            }
+
+            // descend along the border of the higher tree until both heights match
+            if (left->height > right->height + 1)
+                return balance(left->left, join(left->right, right));
+            if (right->height > left->height + 1)
+                return balance(join(left, right->left), right->right);
+            return make_node(left, right);
+        }
+
+        // Characters [0, position) and [position, size), in O(log n)
+        std::pair<NodePointer, NodePointer> split(const NodePointer& node, std::size_t position)
+        {
+            if (!node)
+                return {};
+            if (position == 0)
+                return {nullptr, node};
+            if (position >= node->size)
+                return {node, nullptr};
+            if (node->is_leaf())
+            {
+                // both halves view the same text
+                return {make_leaf(node->text, node->offset, position),
+                        make_leaf(node->text, node->offset + position, node->size - position)};
+            }
+            if (position < node->left->size)
+            {
+                auto [left_left, left_right] = split(node->left, position);
+                return {left_left, join(left_right, node->right)};
+            }
+            auto [right_left, right_right] = split(node->right, position - node->left->size);
+            return {join(node->left, right_left), right_right};
+        }
+
+        std::size_t count_leaves(const Node* node) noexcept
+        {
+            if (!node)
+                return 0;
+            if (node->is_leaf())
+                return 1;
+            return count_leaves(node->left.get()) + count_leaves(node->right.get());
+        }
+
+        std::vector<std::string_view> chunks_of(const Rope& rope)
+        {
+            std::vector<std::string_view> chunks;
+            rope.for_each_chunk([&chunks](std::string_view chunk) { chunks.push_back(chunk); });
+            return chunks;
+        }
+
+    } // namespace
+
+    Rope::Rope(std::string_view text) : Rope(std::string(text))
+    {
+    }
+
+    Rope::Rope(std::string&& text) : m_root(make_leaf(std::move(text)))
+    {
+    }
+
+    std::size_t Rope::chunks_count() const noexcept
+    {
+        return count_leaves(m_root.get()) + (m_tail.empty() ? 0 : 1);
+    }
+
+    char Rope::operator[](std::size_t position) const noexcept
+    {
+        const Node* node = m_root.get();
+        if (!node || position >= node->size)
+            return m_tail[position - (node ? node->size : 0)];
+        while (!node->is_leaf())
+        {
+            if (position < node->left->size)
+            {
+                node = node->left.get();
+            }
+            else
+            {
+                position -= node->left->size;
+                node = node->right.get();
+            }
+        }
+        return node->chunk()[position];
+    }
+
+    void Rope::commit_tail()
+    {
+        if (m_tail.empty())
+            return;
+        m_root = join(m_root, make_leaf(std::move(m_tail)));
+        m_tail = std::string();
+    }
+
+    Rope::NodePointer Rope::root_with_tail() const
+    {
+        if (m_tail.empty())
+            return m_root;
+        return join(m_root, make_leaf(std::string(m_tail)));
+    }
+
+    Rope& Rope::append(std::string_view text)
+    {
+        if (text.size() >= chunk_size)
+        {
+            commit_tail();
+            m_root = join(m_root, make_leaf(std::string(text)));
+            return *this;
+        }
+        if (m_tail.size() + text.size() > chunk_size)
+            commit_tail();
+        if (m_tail.capacity() < chunk_size)
+            m_tail.reserve(chunk_size);
+        m_tail += text;
+        return *this;
+    }
+
+    Rope& Rope::append(const Rope& other)
+    {
+        // copy first: other can be this rope
+        auto other_root = other.root_with_tail();
+        commit_tail();
+        m_root = join(m_root, other_root);
+        return *this;
+    }
+
+    Rope& Rope::insert(std::size_t position, const Rope& other)
+    {
+        auto other_root = other.root_with_tail();
+        commit_tail();
+        auto [before, after] = split(m_root, position);
+        m_root = join(join(before, other_root), after);
+        return *this;
+    }
+
+    Rope& Rope::erase(std::size_t position, std::size_t count)
+    {
+        commit_tail();
+        auto [before, rest] = split(m_root, position);
+        auto [erased, after] = split(rest, count);
+        m_root = join(before, after);
+        return *this;
+    }
+
+    Rope Rope::substr(std::size_t position, std::size_t count) const
+    {
+        const auto [before, rest] = split(root_with_tail(), position);
+        return Rope(split(rest, count).first);
+    }
+
+    std::string Rope::str() const
+    {
+        std::string result;
+        result.reserve(size());
+        for_each_chunk([&result](std::string_view chunk) { result += chunk; });
+        return result;
+    }
+
+    void Rope::flatten()
+    {
+        *this = Rope(str());
+    }
+
+    bool operator==(const Rope& left, std::string_view right)
+    {
+        if (left.size() != right.size())
+            return false;
+        bool equal = true;
+        left.for_each_chunk([&equal, &right](std::string_view chunk) {
+            equal = equal && right.substr(0, chunk.size()) == chunk;
+            right.remove_prefix(chunk.size());
+        });
+        return equal;
+    }
+
+    bool operator==(const Rope& left, const Rope& right)
+    {
+        if (left.size() != right.size())
+            return false;
+        if (left.m_root == right.m_root && left.m_tail == right.m_tail)
+            return true;
+
+        // compare the chunks of both ropes, which do not start at the same positions
+        const auto left_chunks = chunks_of(left);
+        const auto right_chunks = chunks_of(right);
+        auto left_chunk = left_chunks.begin();
+        auto right_chunk = right_chunks.begin();
+        std::string_view left_rest;
+        std::string_view right_rest;
+        for (;;)
+        {
+            if (left_rest.empty() && left_chunk != left_chunks.end())
+                left_rest = *left_chunk++;
+            if (right_rest.empty() && right_chunk != right_chunks.end())
+                right_rest = *right_chunk++;
+            if (left_rest.empty() || right_rest.empty())
+                return left_rest.empty() && right_rest.empty();
+            const auto common_size = std::min(left_rest.size(), right_rest.size());
+            if (left_rest.substr(0, common_size) != right_rest.substr(0, common_size))
+                return false;
+            left_rest.remove_prefix(common_size);
+            right_rest.remove_prefix(common_size);
+        }
+    }
+
+    std::ostream& operator<<(std::ostream& stream, const Rope& rope)
+    {
+        rope.for_each_chunk([&stream](std::string_view chunk) { stream << chunk; });
+        return stream;
+    }
+
+} // namespace ajcf
+
+namespace {
+
+    TEST_CASE("rope basics", "[strings][rope]")
+    {
+        ajcf::Rope rope{"Hello"};
+        rope += " ";
+        rope += ajcf::Rope("World");
+
+        REQUIRE(rope.size() == 11);
+        REQUIRE(rope == "Hello World");
+        REQUIRE(rope.str() == "Hello World");
+        REQUIRE(rope[6] == 'W');
+
+        rope.insert(5, ",");
+
+        REQUIRE(rope == "Hello, World");
+
+        rope.erase(0, 7);
+
+        REQUIRE(rope == "World");
+
+        const auto copy = rope;
+        rope += "!";
+
+        REQUIRE(copy == "World");
+        REQUIRE(rope == "World!");
+        REQUIRE(rope.substr(1, 3) == "orl");
+        REQUIRE(rope.substr(2) == "rld!");
+        REQUIRE(rope + rope == ajcf::Rope("World!World!"));
+
+        std::ostringstream stream;
+        stream << rope;
+
+        REQUIRE(stream.str() == "World!");
+    }
+
+    TEST_CASE("rope of big texts", "[strings][rope]")
+    {
+        // same operations on a rope and a string
+        ajcf::Rope rope;
+        std::string expected;
+        for (int i = 0; i != 20'000; ++i)
+        {
+            const auto line = fmt::format("Setting 'name_{}' = 'value_{}'\n", i, i);
+            rope += line;
+            expected += line;
+        }
+
+        REQUIRE(rope == expected);
+
+        // pseudo-random insertions and erasures
+        std::uint32_t state = 42;
+        const auto next_random = [&state](std::size_t max) {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<std::size_t>(state >> 8) % max;
+        };
+        for (int i = 0; i != 2'000; ++i)
+        {
+            const auto position = next_random(expected.size());
+            if (i % 3 == 0)
+            {
+                const auto count = next_random(100);
+                rope.erase(position, count);
+                expected.erase(position, count);
+            }
+            else
+            {
+                const auto text = fmt::format("<inserted {}>", i);
+                rope.insert(position, text);
+                expected.insert(position, text);
+            }
+        }
+
+        REQUIRE(rope.size() == expected.size());
+        REQUIRE(rope == expected);
+        REQUIRE(rope.substr(123'456, 1000) == expected.substr(123'456, 1000));
+        REQUIRE(rope[expected.size() / 2] == expected[expected.size() / 2]);
+
+        // balanced: the height is logarithmic in the number of chunks
+        const auto chunks_count = rope.chunks_count();
+
+        REQUIRE(chunks_count > 100);
+        REQUIRE(rope.height() <= 2 * static_cast<int>(std::log2(chunks_count)) + 2);
+
+        const auto copy = rope;
+        rope.flatten();
+
+        REQUIRE(rope.chunks_count() == 1);
+        REQUIRE(rope == copy);
+    }
+
+    namespace benchmarks {
+
+        // same lines as ConfigurationDatabase::display_all in types_algebraic.cpp
+        std::vector<std::string> setting_lines(std::size_t bytes)
+        {
+            std::vector<std::string> lines;
+            std::size_t total = 0;
+            for (int i = 0; total < bytes; ++i)
+            {
+                lines.push_back(fmt::format("Setting 'window.title_{}' = 'hello world'\n", i));
+                total += lines.back().size();
+            }
+            return lines;
+        }
+
+        TEST_CASE("rope vs std::string and std::stringstream: appending lines", "[strings][rope][benchmark][!hide]")
+        {
+            // about 8 MB of output
+            const auto lines = setting_lines(8 * 1024 * 1024);
+
+            BENCHMARK("append lines - std::string")
+            {
+                std::string result;
+                for (const auto& line : lines)
+                    result += line;
+                return result.size();
+            };
+
+            BENCHMARK("append lines - std::stringstream")
+            {
+                std::stringstream result;
+                for (const auto& line : lines)
+                    result << line;
+                return result.tellp();
+            };
+
+            BENCHMARK("append lines - ajcf::Rope")
+            {
+                ajcf::Rope result;
+                for (const auto& line : lines)
+                    result += line;
+                return result.size();
+            };
+
+            BENCHMARK("append lines and flatten - ajcf::Rope")
+            {
+                ajcf::Rope result;
+                for (const auto& line : lines)
+                    result += line;
+                return result.str().size();
+            };
+        }
+
+        TEST_CASE("rope vs std::string: insertions and sub-strings", "[strings][rope][benchmark][!hide]")
+        {
+            std::string text;
+            for (const auto& line : setting_lines(8 * 1024 * 1024))
+                text += line;
+            const ajcf::Rope rope{std::string_view(text)};
+
+            constexpr std::size_t operations_count = 10'000;
+            const auto position = [&text](std::size_t i) { return i * 7919 % text.size(); };
+
+            BENCHMARK("10k insertions in 8 MB - std::string")
+            {
+                auto result = text;
+                for (std::size_t i = 0; i != operations_count; ++i)
+                    result.insert(position(i), "inserted");
+                return result.size();
+            };
+
+            BENCHMARK("10k insertions in 8 MB - ajcf::Rope")
+            {
+                auto result = rope;
+                for (std::size_t i = 0; i != operations_count; ++i)
+                    result.insert(position(i), "inserted");
+                return result.size();
+            };
+
+            BENCHMARK("10k sub-strings of 64 KB - std::string")
+            {
+                std::size_t size = 0;
+                for (std::size_t i = 0; i != operations_count; ++i)
+                    size += text.substr(position(i), 64 * 1024).size();
+                return size;
+            };
+
+            BENCHMARK("10k sub-strings of 64 KB - ajcf::Rope")
+            {
+                std::size_t size = 0;
+                for (std::size_t i = 0; i != operations_count; ++i)
+                    size += rope.substr(position(i), 64 * 1024).size();
+                return size;
+            };
+        }
+
+    } // namespace benchmarks
+
+} // namespace
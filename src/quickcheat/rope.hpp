@@ -0,0 +1,196 @@
+// https://en.wikipedia.org/wiki/Rope_(data_structure)
+// https://en.wikipedia.org/wiki/AVL_tree (join and split)
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ajcf {
+
+    namespace detail {
+
+        // Immutable node of a rope, shared between ropes
+        // A leaf views [offset, offset + size) of a shared text, an inner node concatenates left and right
+        struct RopeNode
+        {
+            std::shared_ptr<const RopeNode> left;
+            std::shared_ptr<const RopeNode> right;
+            std::shared_ptr<const std::string> text;
+            std::size_t offset{0};
+            std::size_t size{0};
+            int height{0}; // 0 for a leaf
+
+            bool is_leaf() const noexcept
+            {
+                return !left;
+            }
+
+            std::string_view chunk() const noexcept
+            {
+                return std::string_view(*text).substr(offset, size);
+            }
+        };
+
+    } // namespace detail
+
+    // Text stored as a balanced tree of immutable chunks
+    // - concatenation, insertion, erasure and sub-ropes cost O(log n): the chunks are shared, never copied
+    // - appended texts are accumulated in a small buffer which becomes a chunk when it is full,
+    //   so that building a big text piece by piece does not create a tree of tiny chunks
+    // - copying a rope only copies a pointer (and the buffer of the last appended characters)
+    // - the chunks can be iterated without building the whole string, which is done only on demand by str()
+    //   ajcf::Rope output;
+    //   for (...)
+    //       output += "some line\n";
+    //   output.for_each_chunk([&](std::string_view chunk) { file.write(chunk.data(), chunk.size()); });
+    class Rope
+    {
+    public:
+        // Size of the buffer of appended characters
+        static constexpr std::size_t chunk_size = 4096;
+
+        // Adjacent chunks are merged when their total size is less than this (after insertions or erasures)
+        static constexpr std::size_t small_chunk_size = 256;
+
+        Rope() noexcept = default;
+
+        explicit Rope(std::string_view text);
+
+        explicit Rope(std::string&& text);
+
+        explicit Rope(const char* text) : Rope(std::string_view(text))
+        {
+        }
+
+        std::size_t size() const noexcept
+        {
+            return (m_root ? m_root->size : 0) + m_tail.size();
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        // Height of the tree, logarithmic in the number of chunks
+        int height() const noexcept
+        {
+            return m_root ? m_root->height : 0;
+        }
+
+        std::size_t chunks_count() const noexcept;
+
+        // Character at position, in O(log n)
+        char operator[](std::size_t position) const noexcept;
+
+        Rope& append(std::string_view text);
+
+        Rope& append(const Rope& other);
+
+        Rope& operator+=(std::string_view text)
+        {
+            return append(text);
+        }
+
+        Rope& operator+=(const Rope& other)
+        {
+            return append(other);
+        }
+
+        Rope& insert(std::size_t position, const Rope& other);
+
+        Rope& insert(std::size_t position, std::string_view text)
+        {
+            return insert(position, Rope(text));
+        }
+
+        Rope& erase(std::size_t position, std::size_t count = std::string_view::npos);
+
+        // Characters [position, position + count), sharing the chunks of this rope
+        Rope substr(std::size_t position, std::size_t count = std::string_view::npos) const;
+
+        // Call function(std::string_view) on each chunk, in order, without copying any character
+        template <typename Function>
+        void for_each_chunk(Function&& function) const
+        {
+            if (m_root)
+            {
+                // explicit stack: the height is logarithmic, no recursion needed
+                std::vector<const detail::RopeNode*> stack{m_root.get()};
+                while (!stack.empty())
+                {
+                    const auto* const node = stack.back();
+                    stack.pop_back();
+                    if (node->is_leaf())
+                    {
+                        function(node->chunk());
+                    }
+                    else
+                    {
+                        stack.push_back(node->right.get());
+                        stack.push_back(node->left.get());
+                    }
+                }
+            }
+            if (!m_tail.empty())
+                function(std::string_view(m_tail));
+        }
+
+        // The whole text in one string
+        std::string str() const;
+
+        // Replace the chunks by a single one, to speed up the following accesses
+        void flatten();
+
+        friend Rope operator+(Rope left, const Rope& right)
+        {
+            left.append(right);
+            return left;
+        }
+
+        friend Rope operator+(Rope left, std::string_view right)
+        {
+            left.append(right);
+            return left;
+        }
+
+        friend bool operator==(const Rope& left, std::string_view right);
+
+        friend bool operator==(const Rope& left, const Rope& right);
+
+        friend bool operator!=(const Rope& left, std::string_view right)
+        {
+            return !(left == right);
+        }
+
+        friend bool operator!=(const Rope& left, const Rope& right)
+        {
+            return !(left == right);
+        }
+
+        friend std::ostream& operator<<(std::ostream& stream, const Rope& rope);
+
+    private:
+        using NodePointer = std::shared_ptr<const detail::RopeNode>;
+
+        explicit Rope(NodePointer root) noexcept : m_root(std::move(root))
+        {
+        }
+
+        // move the appended characters into the tree
+        void commit_tail();
+
+        // the tree of this rope with the appended characters
+        NodePointer root_with_tail() const;
+
+        NodePointer m_root;
+        std::string m_tail;
+    };
+
+} // namespace ajcf
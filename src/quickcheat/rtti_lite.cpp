@@ -0,0 +1,335 @@
+// https://llvm.org/docs/HowToSetUpLLVMStyleRTTI.html
+
+#include "rtti_lite.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    class Shape;
+    class Polygon;
+    class Triangle;
+    class Square;
+    class Circle;
+
+    using ShapeHierarchy = ajcf::TypeHierarchy<Shape, Polygon, Triangle, Square, Circle>;
+
+    class Shape : public ajcf::TypeTagged<ShapeHierarchy>
+    {
+    public:
+        Shape() : TypeTagged(ShapeHierarchy::id<Shape>)
+        {
+        }
+
+        Shape(const Shape& other) : Shape(other, ShapeHierarchy::id<Shape>)
+        {
+        }
+
+        int color{0};
+
+    protected:
+        explicit Shape(ajcf::TypeId type_id) : TypeTagged(type_id)
+        {
+        }
+
+        Shape(const Shape& other, ajcf::TypeId type_id) : TypeTagged(other, type_id), color(other.color)
+        {
+        }
+    };
+
+    class Polygon : public Shape
+    {
+    public:
+        Polygon() : Shape(ShapeHierarchy::id<Polygon>)
+        {
+        }
+
+        Polygon(const Polygon& other) : Polygon(other, ShapeHierarchy::id<Polygon>)
+        {
+        }
+
+        int sides_count{0};
+
+    protected:
+        Polygon(ajcf::TypeId type_id, int sides) : Shape(type_id), sides_count(sides)
+        {
+        }
+
+        Polygon(const Polygon& other, ajcf::TypeId type_id) : Shape(other, type_id), sides_count(other.sides_count)
+        {
+        }
+    };
+
+    class Triangle : public Polygon
+    {
+    public:
+        Triangle() : Polygon(ShapeHierarchy::id<Triangle>, 3)
+        {
+        }
+
+        Triangle(const Triangle& other) : Polygon(other, ShapeHierarchy::id<Triangle>)
+        {
+        }
+    };
+
+    class Square : public Polygon
+    {
+    public:
+        Square() : Polygon(ShapeHierarchy::id<Square>, 4)
+        {
+        }
+
+        Square(const Square& other) : Polygon(other, ShapeHierarchy::id<Square>), side(other.side)
+        {
+        }
+
+        double side{1};
+    };
+
+    class Circle : public Shape
+    {
+    public:
+        Circle() : Shape(ShapeHierarchy::id<Circle>)
+        {
+        }
+
+        Circle(const Circle& other) : Shape(other, ShapeHierarchy::id<Circle>), radius(other.radius)
+        {
+        }
+
+        double radius{1};
+    };
+
+    static_assert(ShapeHierarchy::range_of<Polygon>().first == 1);
+    static_assert(ShapeHierarchy::range_of<Polygon>().last == 3);
+    static_assert(ShapeHierarchy::range_of<Circle>().last == 4);
+
+    TEST_CASE("RTTI lite: isa, cast and dyn_cast", "[conversions][rtti_lite]")
+    {
+        Square square;
+        Circle circle;
+        Shape& shape = square;
+
+        REQUIRE(ajcf::isa<Square>(shape));
+        REQUIRE(ajcf::isa<Polygon>(shape));
+        REQUIRE(ajcf::isa<Shape>(shape));
+        REQUIRE(!ajcf::isa<Triangle>(shape));
+        REQUIRE(!ajcf::isa<Circle>(shape));
+        REQUIRE(!ajcf::isa<Polygon>(circle));
+        REQUIRE(ajcf::isa<Shape>(&circle));
+
+        REQUIRE(ajcf::dyn_cast<Polygon>(&shape) == &square);
+        REQUIRE(ajcf::dyn_cast<Triangle>(&shape) == nullptr);
+        REQUIRE(ajcf::dyn_cast<Circle>(static_cast<Shape*>(nullptr)) == nullptr);
+        REQUIRE(&ajcf::cast<Square>(shape) == &square);
+
+        // the constness is kept
+        const Shape& const_shape = circle;
+        const Circle* const_circle = ajcf::dyn_cast<Circle>(&const_shape);
+        static_assert(std::is_same_v<decltype(ajcf::cast<Circle>(const_shape)), const Circle&>);
+
+        REQUIRE(const_circle == &circle);
+
+        // assigning a base part does not change the type
+        Triangle triangle;
+        static_cast<Shape&>(triangle) = circle;
+
+        REQUIRE(ajcf::isa<Triangle>(triangle));
+
+        // copying a base part (slicing) gives an object of the base class, like with dynamic_cast
+        square.color = 2;
+        square.side = 3;
+        const Polygon polygon = square;
+
+        REQUIRE(!ajcf::isa<Square>(polygon));
+        REQUIRE(ajcf::dyn_cast<Square>(&polygon) == nullptr);
+        REQUIRE(ajcf::isa<Polygon>(polygon));
+        REQUIRE(polygon.color == 2);
+        REQUIRE(polygon.sides_count == 4);
+
+        // the copies keep their data
+        const Square square_copy = square;
+
+        REQUIRE(ajcf::isa<Square>(square_copy));
+        REQUIRE(square_copy.color == 2);
+        REQUIRE(square_copy.sides_count == 4);
+        REQUIRE(square_copy.side == 3);
+
+        circle.radius = 5;
+        const Circle circle_copy = circle;
+
+        REQUIRE(ajcf::isa<Circle>(circle_copy));
+        REQUIRE(circle_copy.radius == 5);
+    }
+
+    namespace benchmarks {
+
+        // deep hierarchy: Deep<0> <- Deep<1> <- ... <- Deep<deep_count - 1>
+        constexpr int deep_count = 12;
+
+        template <int Depth>
+        class Deep;
+
+        template <typename Sequence>
+        struct MakeDeepHierarchy;
+
+        template <int... Depths>
+        struct MakeDeepHierarchy<std::integer_sequence<int, Depths...>>
+        {
+            using type = ajcf::TypeHierarchy<Deep<Depths>...>;
+        };
+
+        using DeepHierarchy = MakeDeepHierarchy<std::make_integer_sequence<int, deep_count>>::type;
+
+        template <>
+        class Deep<0> : public ajcf::TypeTagged<DeepHierarchy>
+        {
+        public:
+            Deep() : TypeTagged(DeepHierarchy::id<Deep<0>>)
+            {
+            }
+
+            virtual ~Deep() = default;
+
+        protected:
+            explicit Deep(ajcf::TypeId type_id) : TypeTagged(type_id)
+            {
+            }
+        };
+
+        template <int Depth>
+        class Deep : public Deep<Depth - 1>
+        {
+        public:
+            Deep() : Deep<Depth - 1>(DeepHierarchy::id<Deep<Depth>>)
+            {
+            }
+
+        protected:
+            explicit Deep(ajcf::TypeId type_id) : Deep<Depth - 1>(type_id)
+            {
+            }
+        };
+
+        // wide hierarchy: Wide<0> ... Wide<wide_count - 1> all derived from WideRoot
+        constexpr int wide_count = 64;
+
+        class WideRoot;
+
+        template <int Index>
+        class Wide;
+
+        template <typename Sequence>
+        struct MakeWideHierarchy;
+
+        template <int... Indexes>
+        struct MakeWideHierarchy<std::integer_sequence<int, Indexes...>>
+        {
+            using type = ajcf::TypeHierarchy<WideRoot, Wide<Indexes>...>;
+        };
+
+        using WideHierarchy = MakeWideHierarchy<std::make_integer_sequence<int, wide_count>>::type;
+
+        class WideRoot : public ajcf::TypeTagged<WideHierarchy>
+        {
+        public:
+            virtual ~WideRoot() = default;
+
+        protected:
+            explicit WideRoot(ajcf::TypeId type_id) : TypeTagged(type_id)
+            {
+            }
+        };
+
+        template <int Index>
+        class Wide : public WideRoot
+        {
+        public:
+            Wide() : WideRoot(WideHierarchy::id<Wide<Index>>)
+            {
+            }
+        };
+
+        template <typename Root, typename... Types>
+        std::vector<std::unique_ptr<Root>> make_random_objects(std::size_t count)
+        {
+            using Make = std::unique_ptr<Root> (*)();
+            const Make makes[] = {[]() -> std::unique_ptr<Root> { return std::make_unique<Types>(); }...};
+
+            std::mt19937 random{42};
+            std::uniform_int_distribution<std::size_t> distribution{0, sizeof...(Types) - 1};
+            std::vector<std::unique_ptr<Root>> objects(count);
+            std::generate(objects.begin(), objects.end(), [&] { return makes[distribution(random)](); });
+            return objects;
+        }
+
+        template <typename Root, int... Values, template <int> class Class>
+        std::vector<std::unique_ptr<Root>> make_random_objects(std::integer_sequence<int, Values...>,
+                                                               std::size_t count, Class<0>*)
+        {
+            return make_random_objects<Root, Class<Values>...>(count);
+        }
+
+        // the best number of ns per cast of 3 runs, and the number of successful casts of a run
+        template <typename Cast, typename Root>
+        std::pair<double, std::size_t> measure_casts(const std::vector<std::unique_ptr<Root>>& objects, Cast cast)
+        {
+            constexpr int rounds_count = 10'000;
+            std::size_t successes_count = 0;
+            std::chrono::duration<double> best_elapsed{1e9};
+            for (int run = 0; run != 3; ++run)
+            {
+                successes_count = 0;
+                const auto start = std::chrono::steady_clock::now();
+                for (int round = 0; round != rounds_count; ++round)
+                    for (const auto& object : objects)
+                        successes_count += cast(object.get()) != nullptr;
+                best_elapsed =
+                    std::min<std::chrono::duration<double>>(best_elapsed, std::chrono::steady_clock::now() - start);
+            }
+            return {best_elapsed.count() * 1e9 / (rounds_count * objects.size()), successes_count};
+        }
+
+        template <typename Root, typename To>
+        void print_casts(const char* name, const std::vector<std::unique_ptr<Root>>& objects)
+        {
+            const auto [dynamic_ns, dynamic_successes] =
+                measure_casts(objects, [](Root* object) { return dynamic_cast<To*>(object); });
+            const auto [lite_ns, lite_successes] =
+                measure_casts(objects, [](Root* object) { return ajcf::dyn_cast<To>(object); });
+            fmt::print("  {:<34} {:>8.2f} ns {:>8.2f} ns {:>7.1f}x {:>9}\n", name, dynamic_ns, lite_ns,
+                       dynamic_ns / lite_ns, dynamic_successes == lite_successes ? "same" : "DIFFERENT");
+        }
+
+        TEST_CASE("ajcf::dyn_cast vs dynamic_cast: deep and wide hierarchies",
+                  "[conversions][rtti_lite][benchmark][!hide]")
+        {
+            // 1000 objects of random types, cast 10M times
+            constexpr std::size_t objects_count = 1'000;
+
+            fmt::print("{:<36} {:>11} {:>11} {:>8} {:>9}\n", "10M casts of objects of random types", "dynamic_cast",
+                       "dyn_cast", "speedup", "results");
+
+            const auto deep_objects = make_random_objects<Deep<0>>(std::make_integer_sequence<int, deep_count>{},
+                                                                   objects_count, static_cast<Deep<0>*>(nullptr));
+            fmt::print("deep hierarchy ({} levels):\n", deep_count);
+            print_casts<Deep<0>, Deep<1>>("to the second level", deep_objects);
+            print_casts<Deep<0>, Deep<deep_count / 2>>("to the middle level", deep_objects);
+            print_casts<Deep<0>, Deep<deep_count - 1>>("to the deepest level", deep_objects);
+
+            const auto wide_objects = make_random_objects<WideRoot>(std::make_integer_sequence<int, wide_count>{},
+                                                                    objects_count, static_cast<Wide<0>*>(nullptr));
+            fmt::print("wide hierarchy ({} derived classes):\n", wide_count);
+            print_casts<WideRoot, Wide<0>>("to the first derived class", wide_objects);
+            print_casts<WideRoot, Wide<wide_count - 1>>("to the last derived class", wide_objects);
+        }
+
+    } // namespace benchmarks
+
+} // namespace
@@ -0,0 +1,173 @@
+// https://llvm.org/docs/HowToSetUpLLVMStyleRTTI.html
+// https://en.cppreference.com/w/cpp/language/dynamic_cast
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace ajcf {
+
+    using TypeId = std::uint32_t;
+
+    // The classes of a hierarchy, listed in depth-first order: each class is followed by all its derived classes
+    //   using ShapeHierarchy = ajcf::TypeHierarchy<Shape, Polygon, Triangle, Square, Circle>;
+    // The type id of a class is its position in the list, so the ids of a class and of all its derived classes
+    // form a range: "is a T" is a comparison with the range of T, whatever the depth of the hierarchy
+    // Only single, non virtual inheritance is supported (the casts are static_casts)
+    template <typename... Types>
+    class TypeHierarchy
+    {
+    public:
+        static constexpr std::size_t types_count = sizeof...(Types);
+
+        struct Range
+        {
+            TypeId first;
+            TypeId last;
+        };
+
+        // The id of T, usable in the constructors, while the derived classes are still incomplete
+        template <typename T>
+        static constexpr TypeId id_of() noexcept
+        {
+            static_assert((std::is_same_v<T, Types> || ...), "the class is not in the hierarchy");
+
+            constexpr bool same[] = {std::is_same_v<T, Types>...};
+            TypeId id = 0;
+            while (!same[id])
+                ++id;
+            return id;
+        }
+
+        template <typename T>
+        static constexpr TypeId id = id_of<T>();
+
+        // The ids of T and of its derived classes, once all the classes are complete
+        template <typename T>
+        static constexpr Range range_of() noexcept
+        {
+            constexpr bool derived[] = {std::is_base_of_v<T, Types>...};
+            TypeId last = id<T>;
+            while (last + 1 != types_count && derived[last + 1])
+                ++last;
+            return {id<T>, last};
+        }
+
+        template <typename T>
+        static constexpr bool is_a(TypeId type_id) noexcept
+        {
+            constexpr auto range = range_of<T>();
+            static_assert(range.last - range.first + 1 == (std::size_t{std::is_base_of_v<T, Types>} + ...),
+                          "the derived classes must follow their base class (depth-first order)");
+
+            // one unsigned comparison: the ids below first wrap around to big numbers
+            return type_id - range.first <= range.last - range.first;
+        }
+    };
+
+    // Root of a class hierarchy with type ids, replacing the RTTI for ajcf::isa, ajcf::cast and ajcf::dyn_cast
+    // Each constructor gives the id of the class being constructed: the protected constructors of the base
+    // classes take the id from the constructors of the derived classes (like the kinds of LLVM)
+    // The copy constructors too, with the protected copy constructors of the base classes which take the id:
+    // a copy of the base part of a derived object (slicing) is not a derived object
+    //   class Shape : public ajcf::TypeTagged<ShapeHierarchy>
+    //   {
+    //   protected:
+    //       explicit Shape(ajcf::TypeId type_id) : TypeTagged(type_id) {}
+    //       Shape(const Shape& other, ajcf::TypeId type_id) : TypeTagged(other, type_id) {}
+    //   };
+    //   class Circle : public Shape
+    //   {
+    //   public:
+    //       Circle() : Shape(ShapeHierarchy::id<Circle>) {}
+    //       Circle(const Circle& other) : Shape(other, ShapeHierarchy::id<Circle>), m_radius(other.m_radius) {}
+    //   private:
+    //       double m_radius{1};
+    //   };
+    template <typename Hierarchy>
+    class TypeTagged
+    {
+    public:
+        using type_hierarchy = Hierarchy;
+
+        TypeId type_id() const noexcept
+        {
+            return m_type_id;
+        }
+
+    protected:
+        explicit TypeTagged(TypeId type_id) noexcept : m_type_id(type_id)
+        {
+        }
+
+        // copy of the base part of an object of the class type_id
+        TypeTagged(const TypeTagged&, TypeId type_id) noexcept : m_type_id(type_id)
+        {
+        }
+
+        // else the copy of a base part would keep the id of the derived class
+        TypeTagged(const TypeTagged&) = delete;
+
+        // an object keeps its type when a base part is assigned to it
+        TypeTagged& operator=(const TypeTagged&) noexcept
+        {
+            return *this;
+        }
+
+        ~TypeTagged() = default;
+
+    private:
+        TypeId m_type_id;
+    };
+
+    namespace rtti_lite_details {
+
+        template <typename From, typename To>
+        using copy_const_t = std::conditional_t<std::is_const_v<From>, const To, To>;
+
+    } // namespace rtti_lite_details
+
+    // Whether the object is a To (or derived from To), like dynamic_cast<const To*>(&from) != nullptr
+    template <typename To, typename From>
+    bool isa(const From& from) noexcept
+    {
+        if constexpr (std::is_base_of_v<To, From>)
+            return true;
+        else
+            return From::type_hierarchy::template is_a<To>(from.type_id());
+    }
+
+    template <typename To, typename From>
+    bool isa(From* from) noexcept
+    {
+        assert(from != nullptr);
+        return isa<To>(*from);
+    }
+
+    // Cast to To, which must be the type (or a base of the type) of the object: checked only in debug builds
+    template <typename To, typename From>
+    rtti_lite_details::copy_const_t<From, To>* cast(From* from) noexcept
+    {
+        assert(isa<To>(from));
+        return static_cast<rtti_lite_details::copy_const_t<From, To>*>(from);
+    }
+
+    template <typename To, typename From>
+    rtti_lite_details::copy_const_t<From, To>& cast(From& from) noexcept
+    {
+        return *cast<To>(&from);
+    }
+
+    // Cast to To if the object is a To, else nullptr, like dynamic_cast<To*>(from)
+    template <typename To, typename From>
+    rtti_lite_details::copy_const_t<From, To>* dyn_cast(From* from) noexcept
+    {
+        if (from != nullptr && isa<To>(*from))
+            return static_cast<rtti_lite_details::copy_const_t<From, To>*>(from);
+        return nullptr;
+    }
+
+} // namespace ajcf
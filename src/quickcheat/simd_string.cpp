@@ -0,0 +1,604 @@
+// https://www.intel.com/content/www/us/en/docs/intrinsics-guide/index.html
+// https://gcc.gnu.org/onlinedocs/gcc/x86-Built-in-Functions.html (__builtin_cpu_supports)
+// https://docs.microsoft.com/en-us/cpp/intrinsics/cpuid-cpuidex
+
+#include "simd_string.hpp"
+#include "simd_target.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace ajcf::simd {
+
+    namespace {
+
+        namespace scalar {
+
+            std::size_t length(const char* c_string) noexcept
+            {
+                const char* end = c_string;
+                while (*end != 0)
+                    ++end;
+                return static_cast<std::size_t>(end - c_string);
+            }
+
+            const char* find_char(const char* first, const char* last, char c) noexcept
+            {
+                for (; first != last; ++first)
+                {
+                    if (*first == c)
+                        return first;
+                }
+                return last;
+            }
+
+            const char* find_any_of(const char* first, const char* last, const char* chars_first,
+                                    const char* chars_last) noexcept
+            {
+                // one bit per possible character value
+                std::bitset<256> is_searched{};
+                for (; chars_first != chars_last; ++chars_first)
+                    is_searched.set(static_cast<unsigned char>(*chars_first));
+
+                for (; first != last; ++first)
+                {
+                    if (is_searched.test(static_cast<unsigned char>(*first)))
+                        return first;
+                }
+                return last;
+            }
+
+            std::size_t count_char(const char* first, const char* last, char c) noexcept
+            {
+                std::size_t count = 0;
+                for (; first != last; ++first)
+                    count += (*first == c) ? 1 : 0;
+                return count;
+            }
+
+            constexpr StringKernels kernels{&length, &find_char, &find_any_of, &count_char};
+
+        } // namespace scalar
+
+#if defined(AJCF_SIMD_X86)
+
+        unsigned count_trailing_zeros(std::uint32_t mask) noexcept
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long index{};
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+
+        // Maximum number of searched characters handled by the vectorized find_any_of
+        constexpr std::size_t max_vectorized_chars_count = 16;
+
+        namespace sse2 {
+
+            // Aligned loads never cross a page boundary: reading the whole aligned block which contains
+            // the terminating '\0' is safe, even if the bytes after it do not belong to the string
+            // (but the address sanitizer cannot know that)
+            AJCF_SIMD_NO_SANITIZE_ADDRESS
+            std::size_t length(const char* c_string) noexcept
+            {
+                const auto zero = _mm_setzero_si128();
+                const auto misalignment = reinterpret_cast<std::uintptr_t>(c_string) % 16;
+                const char* block = c_string - misalignment;
+
+                auto mask = static_cast<std::uint32_t>(
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(block)), zero)));
+                mask >>= misalignment; // ignore the bytes before the beginning of the string
+                if (mask != 0)
+                    return count_trailing_zeros(mask);
+
+                for (;;)
+                {
+                    block += 16;
+                    mask = static_cast<std::uint32_t>(_mm_movemask_epi8(
+                        _mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(block)), zero)));
+                    if (mask != 0)
+                        return static_cast<std::size_t>(block - c_string) + count_trailing_zeros(mask);
+                }
+            }
+
+            const char* find_char(const char* first, const char* last, char c) noexcept
+            {
+                const auto needle = _mm_set1_epi8(c);
+                for (; last - first >= 16; first += 16)
+                {
+                    const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                    const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+                    if (mask != 0)
+                        return first + count_trailing_zeros(mask);
+                }
+                return scalar::find_char(first, last, c);
+            }
+
+            const char* find_any_of(const char* first, const char* last, const char* chars_first,
+                                    const char* chars_last) noexcept
+            {
+                const auto chars_count = static_cast<std::size_t>(chars_last - chars_first);
+                if (chars_count == 1)
+                    return find_char(first, last, *chars_first);
+                if (chars_count == 0 || chars_count > max_vectorized_chars_count || last - first < 16)
+                    return scalar::find_any_of(first, last, chars_first, chars_last);
+
+                __m128i needles[max_vectorized_chars_count];
+                for (std::size_t index = 0; index != chars_count; ++index)
+                    needles[index] = _mm_set1_epi8(chars_first[index]);
+
+                for (; last - first >= 16; first += 16)
+                {
+                    const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                    auto matches = _mm_cmpeq_epi8(block, needles[0]);
+                    for (std::size_t index = 1; index != chars_count; ++index)
+                        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, needles[index]));
+                    const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(matches));
+                    if (mask != 0)
+                        return first + count_trailing_zeros(mask);
+                }
+                return scalar::find_any_of(first, last, chars_first, chars_last);
+            }
+
+            std::size_t count_char(const char* first, const char* last, char c) noexcept
+            {
+                const auto needle = _mm_set1_epi8(c);
+                const auto zero = _mm_setzero_si128();
+                std::size_t count = 0;
+                while (last - first >= 16)
+                {
+                    // each byte counter can be incremented at most 255 times before overflowing
+                    const auto blocks_count = std::min<std::ptrdiff_t>((last - first) / 16, 255);
+                    auto counters = _mm_setzero_si128();
+                    for (std::ptrdiff_t index = 0; index != blocks_count; ++index, first += 16)
+                    {
+                        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                        // a match is 0xFF, i.e. -1: subtracting it increments the counter
+                        counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(block, needle));
+                    }
+                    // horizontal sum of the 16 byte counters into two 64-bit integers
+                    const auto sums = _mm_sad_epu8(counters, zero);
+                    count += static_cast<std::size_t>(_mm_cvtsi128_si32(sums)) +
+                             static_cast<std::size_t>(_mm_extract_epi16(sums, 4));
+                }
+                return count + scalar::count_char(first, last, c);
+            }
+
+            constexpr StringKernels kernels{&length, &find_char, &find_any_of, &count_char};
+
+        } // namespace sse2
+
+        namespace avx2 {
+
+            AJCF_SIMD_TARGET_AVX2 AJCF_SIMD_NO_SANITIZE_ADDRESS
+            std::size_t length(const char* c_string) noexcept
+            {
+                const auto zero = _mm256_setzero_si256();
+                const auto misalignment = reinterpret_cast<std::uintptr_t>(c_string) % 32;
+                const char* block = c_string - misalignment;
+
+                auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                    _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(block)), zero)));
+                mask >>= misalignment; // ignore the bytes before the beginning of the string
+                if (mask != 0)
+                    return count_trailing_zeros(mask);
+
+                for (;;)
+                {
+                    block += 32;
+                    mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                        _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(block)), zero)));
+                    if (mask != 0)
+                        return static_cast<std::size_t>(block - c_string) + count_trailing_zeros(mask);
+                }
+            }
+
+            AJCF_SIMD_TARGET_AVX2
+            const char* find_char(const char* first, const char* last, char c) noexcept
+            {
+                const auto needle = _mm256_set1_epi8(c);
+                for (; last - first >= 32; first += 32)
+                {
+                    const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+                    const auto mask =
+                        static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+                    if (mask != 0)
+                        return first + count_trailing_zeros(mask);
+                }
+                // the compiler does not always clear the upper halves of the AVX registers before a tail call:
+                // the SSE2 code which follows would then pay the AVX-SSE transition penalty on each instruction
+                _mm256_zeroupper();
+                return sse2::find_char(first, last, c);
+            }
+
+            AJCF_SIMD_TARGET_AVX2
+            const char* find_any_of(const char* first, const char* last, const char* chars_first,
+                                    const char* chars_last) noexcept
+            {
+                const auto chars_count = static_cast<std::size_t>(chars_last - chars_first);
+                if (chars_count == 1)
+                    return find_char(first, last, *chars_first);
+                if (chars_count == 0 || chars_count > max_vectorized_chars_count)
+                    return scalar::find_any_of(first, last, chars_first, chars_last);
+                // too short to broadcast the searched characters into vectors
+                if (last - first < 32)
+                    return sse2::find_any_of(first, last, chars_first, chars_last);
+
+                __m256i needles[max_vectorized_chars_count];
+                for (std::size_t index = 0; index != chars_count; ++index)
+                    needles[index] = _mm256_set1_epi8(chars_first[index]);
+
+                for (; last - first >= 32; first += 32)
+                {
+                    const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+                    auto matches = _mm256_cmpeq_epi8(block, needles[0]);
+                    for (std::size_t index = 1; index != chars_count; ++index)
+                        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(block, needles[index]));
+                    const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(matches));
+                    if (mask != 0)
+                        return first + count_trailing_zeros(mask);
+                }
+                // the compiler does not always clear the upper halves of the AVX registers before a tail call:
+                // the SSE2 code which follows would then pay the AVX-SSE transition penalty on each instruction
+                _mm256_zeroupper();
+                return sse2::find_any_of(first, last, chars_first, chars_last);
+            }
+
+            AJCF_SIMD_TARGET_AVX2
+            std::size_t count_char(const char* first, const char* last, char c) noexcept
+            {
+                const auto needle = _mm256_set1_epi8(c);
+                const auto zero = _mm256_setzero_si256();
+                std::size_t count = 0;
+                while (last - first >= 32)
+                {
+                    // each byte counter can be incremented at most 255 times before overflowing
+                    const auto blocks_count = std::min<std::ptrdiff_t>((last - first) / 32, 255);
+                    auto counters = _mm256_setzero_si256();
+                    for (std::ptrdiff_t index = 0; index != blocks_count; ++index, first += 32)
+                    {
+                        const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+                        counters = _mm256_sub_epi8(counters, _mm256_cmpeq_epi8(block, needle));
+                    }
+                    // horizontal sum of the 32 byte counters into four 64-bit integers
+                    const auto sums = _mm256_sad_epu8(counters, zero);
+                    count += static_cast<std::size_t>(_mm256_extract_epi64(sums, 0)) +
+                             static_cast<std::size_t>(_mm256_extract_epi64(sums, 1)) +
+                             static_cast<std::size_t>(_mm256_extract_epi64(sums, 2)) +
+                             static_cast<std::size_t>(_mm256_extract_epi64(sums, 3));
+                }
+                return count + sse2::count_char(first, last, c);
+            }
+
+            constexpr StringKernels kernels{&length, &find_char, &find_any_of, &count_char};
+
+        } // namespace avx2
+
+        bool cpu_supports_avx2() noexcept
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int registers[4]{};
+            __cpuid(registers, 1);
+            const bool os_saves_ymm_registers =
+                (registers[2] & (1 << 27)) != 0 && (_xgetbv(_XCR_XFEATURE_ENABLED_MASK) & 0x6) == 0x6;
+            __cpuidex(registers, 7, 0);
+            return os_saves_ymm_registers && (registers[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+
+#endif
+
+    } // namespace
+
+    const char* to_string(InstructionSet instruction_set) noexcept
+    {
+        switch (instruction_set)
+        {
+        case InstructionSet::scalar:
+            return "scalar";
+        case InstructionSet::sse2:
+            return "sse2";
+        case InstructionSet::avx2:
+            return "avx2";
+        }
+        return "unknown";
+    }
+
+    bool is_supported(InstructionSet instruction_set) noexcept
+    {
+        switch (instruction_set)
+        {
+        case InstructionSet::scalar:
+            return true;
+#if defined(AJCF_SIMD_X86)
+        case InstructionSet::sse2:
+            return true; // part of x86-64
+        case InstructionSet::avx2: {
+            static const bool supported = cpu_supports_avx2();
+            return supported;
+        }
+#endif
+        default:
+            return false;
+        }
+    }
+
+    InstructionSet best_instruction_set() noexcept
+    {
+        for (const auto instruction_set : {InstructionSet::avx2, InstructionSet::sse2})
+        {
+            if (is_supported(instruction_set))
+                return instruction_set;
+        }
+        return InstructionSet::scalar;
+    }
+
+    const StringKernels& string_kernels(InstructionSet instruction_set) noexcept
+    {
+        switch (instruction_set)
+        {
+#if defined(AJCF_SIMD_X86)
+        case InstructionSet::sse2:
+            return sse2::kernels;
+        case InstructionSet::avx2:
+            return avx2::kernels;
+#endif
+        default:
+            return scalar::kernels;
+        }
+    }
+
+    const StringKernels& best_string_kernels() noexcept
+    {
+        static const StringKernels& kernels = string_kernels(best_instruction_set());
+        return kernels;
+    }
+
+} // namespace ajcf::simd
+
+namespace {
+
+    std::vector<ajcf::simd::InstructionSet> supported_instruction_sets()
+    {
+        std::vector<ajcf::simd::InstructionSet> result;
+        for (const auto instruction_set :
+             {ajcf::simd::InstructionSet::scalar, ajcf::simd::InstructionSet::sse2, ajcf::simd::InstructionSet::avx2})
+        {
+            if (ajcf::simd::is_supported(instruction_set))
+                result.push_back(instruction_set);
+        }
+        return result;
+    }
+
+    TEST_CASE("simd string kernels", "[simd][strings]")
+    {
+        REQUIRE(ajcf::simd::string_length("") == 0);
+        REQUIRE(ajcf::simd::string_length("Hello") == 5);
+
+        REQUIRE(ajcf::simd::find_char("Hello", 'l') == 2);
+        REQUIRE(ajcf::simd::find_char("Hello", 'z') == std::string_view::npos);
+        REQUIRE(ajcf::simd::find_char("", 'z') == std::string_view::npos);
+
+        REQUIRE(ajcf::simd::find_any_of("Hello, world", ",!") == 5);
+        REQUIRE(ajcf::simd::find_any_of("Hello, world", "xyz") == std::string_view::npos);
+
+        REQUIRE(ajcf::simd::count_char("Hello, world", 'o') == 2);
+        REQUIRE(ajcf::simd::count_char("", 'o') == 0);
+    }
+
+    TEST_CASE("simd string kernels give the same results as the scalar ones", "[simd][strings]")
+    {
+        const auto& reference = ajcf::simd::string_kernels(ajcf::simd::InstructionSet::scalar);
+
+        std::minstd_rand random_engine{42};
+        std::uniform_int_distribution<int> char_distribution{'a', 'h'};
+
+        // lengths and alignments exercise the vector loops and the scalar tails
+        std::vector<char> buffer(1200);
+        for (std::size_t length = 0; length != 1100; length += (length < 130 ? 1 : 97))
+        {
+            for (std::size_t offset = 0; offset != 33; offset += 3)
+            {
+                char* const first = buffer.data() + offset;
+                char* const last = first + length;
+                std::generate(first, last, [&] { return static_cast<char>(char_distribution(random_engine)); });
+                *last = 0;
+
+                for (const auto instruction_set : supported_instruction_sets())
+                {
+                    INFO("instruction set " << ajcf::simd::to_string(instruction_set) << ", length " << length
+                                            << ", offset " << offset);
+                    const auto& kernels = ajcf::simd::string_kernels(instruction_set);
+
+                    REQUIRE(kernels.length(first) == reference.length(first));
+                    for (const char c : {'a', 'h', 'z'})
+                    {
+                        REQUIRE(kernels.find_char(first, last, c) == reference.find_char(first, last, c));
+                        REQUIRE(kernels.count_char(first, last, c) == reference.count_char(first, last, c));
+                    }
+                    for (const std::string_view chars : {"", "z", "gh", "xyzh", "ponmlkjihx", "ABCDEFGHIJKLMNOPQh"})
+                    {
+                        REQUIRE(kernels.find_any_of(first, last, chars.data(), chars.data() + chars.size()) ==
+                                reference.find_any_of(first, last, chars.data(), chars.data() + chars.size()));
+                    }
+                }
+            }
+        }
+    }
+
+#if defined(__linux__)
+    TEST_CASE("simd string kernels do not read beyond a page boundary", "[simd][strings]")
+    {
+        // map two pages, then forbid any access to the second one
+        const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        void* const mapping =
+            ::mmap(nullptr, 2 * page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        REQUIRE(mapping != MAP_FAILED);
+        char* const protected_page = static_cast<char*>(mapping) + page_size;
+        REQUIRE(::mprotect(protected_page, page_size, PROT_NONE) == 0);
+
+        // strings ending just before the protected page: any overread would crash
+        for (std::size_t length = 0; length != 100; ++length)
+        {
+            char* const last = protected_page - 1;
+            char* const first = last - length;
+            std::fill(first, last, 'a');
+            *last = 0;
+
+            for (const auto instruction_set : supported_instruction_sets())
+            {
+                const auto& kernels = ajcf::simd::string_kernels(instruction_set);
+                const std::string_view chars = "xyz";
+
+                REQUIRE(kernels.length(first) == length);
+                REQUIRE(kernels.find_char(first, protected_page, 'b') == protected_page);
+                REQUIRE(kernels.find_any_of(first, protected_page, chars.data(), chars.data() + chars.size()) ==
+                        protected_page);
+                REQUIRE(kernels.count_char(first, protected_page, 'a') == length);
+            }
+        }
+
+        ::munmap(mapping, 2 * page_size);
+    }
+#endif
+
+    namespace benchmarks {
+
+        constexpr std::size_t lengths[] = {1, 16, 256, 4096, 65536, 1024 * 1024};
+
+        std::string make_text(std::size_t length)
+        {
+            // the searched characters are absent, so that the whole text is scanned
+            std::string text(length, 'a');
+            for (std::size_t index = 0; index < length; index += 7)
+                text[index] = static_cast<char>('a' + index % 13);
+            return text;
+        }
+
+        std::size_t scalar_loop_length(const char* c_string)
+        {
+            const char* end = c_string;
+            while (*end != 0)
+                ++end;
+            return static_cast<std::size_t>(end - c_string);
+        }
+
+        TEST_CASE("simd string length vs scalar loop and libc", "[simd][strings][benchmark][!hide]")
+        {
+            for (const auto length : lengths)
+            {
+                const auto text = make_text(length);
+                const char* const c_string = text.c_str();
+
+                BENCHMARK(fmt::format("length {} - scalar loop", length))
+                {
+                    return scalar_loop_length(c_string);
+                };
+                BENCHMARK(fmt::format("length {} - std::strlen", length))
+                {
+                    return std::strlen(c_string);
+                };
+                for (const auto instruction_set : supported_instruction_sets())
+                {
+                    const auto& kernels = ajcf::simd::string_kernels(instruction_set);
+                    BENCHMARK(fmt::format("length {} - {}", length, ajcf::simd::to_string(instruction_set)))
+                    {
+                        return kernels.length(c_string);
+                    };
+                }
+            }
+        }
+
+        TEST_CASE("simd find char vs scalar loop and libc", "[simd][strings][benchmark][!hide]")
+        {
+            for (const auto length : lengths)
+            {
+                const auto text = make_text(length);
+                const char* const first = text.data();
+                const char* const last = text.data() + text.size();
+
+                BENCHMARK(fmt::format("find char {} - std::memchr", length))
+                {
+                    return std::memchr(first, 'z', length);
+                };
+                for (const auto instruction_set : supported_instruction_sets())
+                {
+                    const auto& kernels = ajcf::simd::string_kernels(instruction_set);
+                    BENCHMARK(fmt::format("find char {} - {}", length, ajcf::simd::to_string(instruction_set)))
+                    {
+                        return kernels.find_char(first, last, 'z');
+                    };
+                }
+            }
+        }
+
+        TEST_CASE("simd find any of vs scalar loop and libc", "[simd][strings][benchmark][!hide]")
+        {
+            const std::string_view chars = ",;:!?";
+            for (const auto length : lengths)
+            {
+                const auto text = make_text(length);
+                const char* const first = text.data();
+                const char* const last = text.data() + text.size();
+
+                BENCHMARK(fmt::format("find any of {} - std::strpbrk", length))
+                {
+                    return std::strpbrk(text.c_str(), ",;:!?");
+                };
+                BENCHMARK(fmt::format("find any of {} - std::string_view::find_first_of", length))
+                {
+                    return std::string_view{text}.find_first_of(chars);
+                };
+                for (const auto instruction_set : supported_instruction_sets())
+                {
+                    const auto& kernels = ajcf::simd::string_kernels(instruction_set);
+                    BENCHMARK(fmt::format("find any of {} - {}", length, ajcf::simd::to_string(instruction_set)))
+                    {
+                        return kernels.find_any_of(first, last, chars.data(), chars.data() + chars.size());
+                    };
+                }
+            }
+        }
+
+        TEST_CASE("simd count char vs scalar loop and libc", "[simd][strings][benchmark][!hide]")
+        {
+            for (const auto length : lengths)
+            {
+                const auto text = make_text(length);
+                const char* const first = text.data();
+                const char* const last = text.data() + text.size();
+
+                BENCHMARK(fmt::format("count char {} - std::count", length))
+                {
+                    return std::count(first, last, 'b');
+                };
+                for (const auto instruction_set : supported_instruction_sets())
+                {
+                    const auto& kernels = ajcf::simd::string_kernels(instruction_set);
+                    BENCHMARK(fmt::format("count char {} - {}", length, ajcf::simd::to_string(instruction_set)))
+                    {
+                        return kernels.count_char(first, last, 'b');
+                    };
+                }
+            }
+        }
+
+    } // namespace benchmarks
+
+} // namespace
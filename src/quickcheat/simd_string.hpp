@@ -0,0 +1,82 @@
+// https://www.intel.com/content/www/us/en/docs/intrinsics-guide/index.html
+// https://gcc.gnu.org/onlinedocs/gcc/x86-Function-Attributes.html
+// https://en.cppreference.com/w/cpp/string/basic_string_view
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace ajcf {
+
+    // Vectorized kernels for searching characters in strings
+    // - the best instruction set supported by the CPU is detected at runtime (AVX2, else SSE2, else scalar code)
+    // - the kernels never read a byte which could be on a page not belonging to the string,
+    //   so they cannot crash on a page boundary
+    namespace simd {
+
+        enum class InstructionSet
+        {
+            scalar,
+            sse2,
+            avx2,
+        };
+
+        const char* to_string(InstructionSet instruction_set) noexcept;
+
+        bool is_supported(InstructionSet instruction_set) noexcept;
+
+        // Best instruction set supported by the CPU running the program
+        InstructionSet best_instruction_set() noexcept;
+
+        // Implementations of the kernels for one instruction set
+        struct StringKernels
+        {
+            // Number of characters before the terminating '\0'
+            std::size_t (*length)(const char* c_string) noexcept;
+
+            // Position of the first character equal to c in [first, last), or last
+            const char* (*find_char)(const char* first, const char* last, char c) noexcept;
+
+            // Position of the first character of [first, last) which is one of [chars_first, chars_last), or last
+            const char* (*find_any_of)(const char* first, const char* last, const char* chars_first,
+                                       const char* chars_last) noexcept;
+
+            // Number of characters equal to c in [first, last)
+            std::size_t (*count_char)(const char* first, const char* last, char c) noexcept;
+        };
+
+        // Kernels for the given instruction set (which must be supported by the CPU)
+        const StringKernels& string_kernels(InstructionSet instruction_set) noexcept;
+
+        // Kernels for the best instruction set, selected once
+        const StringKernels& best_string_kernels() noexcept;
+
+        inline std::size_t string_length(const char* c_string) noexcept
+        {
+            return best_string_kernels().length(c_string);
+        }
+
+        inline std::size_t find_char(std::string_view text, char c) noexcept
+        {
+            const char* const found = best_string_kernels().find_char(text.data(), text.data() + text.size(), c);
+            return found == text.data() + text.size() ? std::string_view::npos
+                                                      : static_cast<std::size_t>(found - text.data());
+        }
+
+        inline std::size_t find_any_of(std::string_view text, std::string_view chars) noexcept
+        {
+            const char* const found = best_string_kernels().find_any_of(
+                text.data(), text.data() + text.size(), chars.data(), chars.data() + chars.size());
+            return found == text.data() + text.size() ? std::string_view::npos
+                                                      : static_cast<std::size_t>(found - text.data());
+        }
+
+        inline std::size_t count_char(std::string_view text, char c) noexcept
+        {
+            return best_string_kernels().count_char(text.data(), text.data() + text.size(), c);
+        }
+
+    } // namespace simd
+
+} // namespace ajcf
@@ -0,0 +1,23 @@
+// https://gcc.gnu.org/onlinedocs/gcc/x86-Function-Attributes.html
+// https://docs.microsoft.com/en-us/cpp/intrinsics/x64-amd64-intrinsics-list
+
+#pragma once
+
+// Intrinsics and function attributes for the vectorized kernels (ajcf::simd, ajcf::utf8)
+// - AJCF_SIMD_X86: x86-64 intrinsics are available (SSE2 is always supported there)
+// - AJCF_SIMD_TARGET_AVX2: compile a function with AVX2 enabled, whatever the flags of the translation unit
+//   (the function must then only be called if ajcf::simd::is_supported(InstructionSet::avx2))
+// - AJCF_SIMD_NO_SANITIZE_ADDRESS: for kernels reading aligned blocks beyond the end of a buffer on purpose
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define AJCF_SIMD_X86 1
+#define AJCF_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#define AJCF_SIMD_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#elif defined(_M_X64)
+#include <immintrin.h>
+#include <intrin.h>
+#define AJCF_SIMD_X86 1
+#define AJCF_SIMD_TARGET_AVX2
+#define AJCF_SIMD_NO_SANITIZE_ADDRESS
+#endif
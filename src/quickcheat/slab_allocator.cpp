@@ -0,0 +1,666 @@
+// https://en.cppreference.com/w/cpp/memory/new/operator_new
+// https://en.cppreference.com/w/cpp/language/storage_duration (thread_local)
+// https://man7.org/linux/man-pages/man2/mmap.2.html
+
+#include "slab_allocator.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define AJCF_SLAB_USE_MMAP 1
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace ajcf::slab {
+
+    namespace {
+
+        constexpr std::size_t block_sizes[] = {16,  32,  48,  64,  80,  96,  112, 128, 160, 192,
+                                               224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+
+        constexpr std::size_t classes_count = std::size(block_sizes);
+
+        static_assert(block_sizes[classes_count - 1] == max_small_size);
+
+        // For each granule of min_block_size bytes, the index of the smallest size class which can hold it
+        struct SizeClassTable
+        {
+            std::uint8_t index_by_granule[max_small_size / min_block_size + 1]{};
+        };
+
+        constexpr SizeClassTable make_size_class_table()
+        {
+            SizeClassTable table{};
+            std::size_t index = 0;
+            for (std::size_t granule = 0; granule <= max_small_size / min_block_size; ++granule)
+            {
+                while (block_sizes[index] < granule * min_block_size)
+                    ++index;
+                table.index_by_granule[granule] = static_cast<std::uint8_t>(index);
+            }
+            return table;
+        }
+
+        constexpr SizeClassTable size_class_table = make_size_class_table();
+
+        char* map_slab()
+        {
+#if defined(AJCF_SLAB_USE_MMAP)
+            // Map twice the size, then unmap the unaligned head and tail,
+            // so that the slab of a block can be found by masking the block's address
+            void* const mapping =
+                ::mmap(nullptr, 2 * slab_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping == MAP_FAILED)
+                throw std::bad_alloc();
+            const auto address = reinterpret_cast<std::uintptr_t>(mapping);
+            const auto aligned_address = (address + slab_size - 1) & ~(std::uintptr_t{slab_size} - 1);
+            const auto head_size = aligned_address - address;
+            if (head_size != 0)
+                ::munmap(mapping, head_size);
+            ::munmap(reinterpret_cast<char*>(aligned_address) + slab_size, slab_size - head_size);
+            return reinterpret_cast<char*>(aligned_address);
+#else
+            return static_cast<char*>(::operator new(slab_size, std::align_val_t{slab_size}));
+#endif
+        }
+
+        void unmap_slab(char* slab) noexcept
+        {
+#if defined(AJCF_SLAB_USE_MMAP)
+            ::munmap(slab, slab_size);
+#else
+            ::operator delete(slab, std::align_val_t{slab_size});
+#endif
+        }
+
+        char* slab_of(void* block) noexcept
+        {
+            return reinterpret_cast<char*>(reinterpret_cast<std::uintptr_t>(block) & ~(std::uintptr_t{slab_size} - 1));
+        }
+
+        // Shared state of one size class, protected by its own mutex
+        struct alignas(64) Depot
+        {
+            std::mutex mutex;
+            std::vector<void*> free_blocks;
+            std::vector<char*> slabs;
+            char* carving_slab{};
+            char* carving_cursor{};
+            char* carving_end{};
+        };
+
+        struct CentralDepot
+        {
+            std::array<Depot, classes_count> depots;
+            std::atomic<std::size_t> mapped_bytes{0};
+            std::atomic<std::size_t> slabs_count{0};
+        };
+
+        // Never destroyed: blocks may still be deallocated by the destructors of other static objects
+        CentralDepot& central_depot()
+        {
+            static CentralDepot* const depot = new CentralDepot{};
+            return *depot;
+        }
+
+        struct Magazine
+        {
+            std::array<void*, magazine_capacity> blocks;
+            std::size_t count{};
+        };
+
+        // Fill the magazine with half its capacity, taking blocks from the depot or carving new ones from a slab
+        void refill_from_depot(Magazine& magazine, std::size_t class_index)
+        {
+            auto& central = central_depot();
+            auto& depot = central.depots[class_index];
+            const auto block_size = block_sizes[class_index];
+            const auto wanted_count = magazine_capacity / 2;
+
+            std::lock_guard lock{depot.mutex};
+
+            const auto taken_count = std::min(wanted_count, depot.free_blocks.size());
+            const auto taken_begin = depot.free_blocks.end() - static_cast<std::ptrdiff_t>(taken_count);
+            std::copy(taken_begin, depot.free_blocks.end(), magazine.blocks.begin() + magazine.count);
+            depot.free_blocks.erase(taken_begin, depot.free_blocks.end());
+            magazine.count += taken_count;
+
+            while (magazine.count < wanted_count)
+            {
+                if (static_cast<std::size_t>(depot.carving_end - depot.carving_cursor) < block_size)
+                {
+                    depot.slabs.reserve(depot.slabs.size() + 1);
+                    char* const slab = map_slab();
+                    depot.slabs.push_back(slab);
+                    depot.carving_slab = slab;
+                    depot.carving_cursor = slab;
+                    depot.carving_end = slab + (slab_size / block_size) * block_size;
+                    central.mapped_bytes += slab_size;
+                    ++central.slabs_count;
+                }
+                magazine.blocks[magazine.count++] = depot.carving_cursor;
+                depot.carving_cursor += block_size;
+            }
+        }
+
+        // Give the magazine's blocks back to the depot, except the first kept_count ones
+        void drain_to_depot(Magazine& magazine, std::size_t class_index, std::size_t kept_count) noexcept
+        {
+            if (magazine.count <= kept_count)
+                return;
+
+            auto& depot = central_depot().depots[class_index];
+
+            std::lock_guard lock{depot.mutex};
+
+            try
+            {
+                depot.free_blocks.insert(depot.free_blocks.end(), magazine.blocks.begin() + kept_count,
+                                         magazine.blocks.begin() + magazine.count);
+                magazine.count = kept_count;
+            }
+            catch (const std::bad_alloc&)
+            {
+                // keep the blocks in the magazine: they are not lost, only not shared
+            }
+        }
+
+        // Set when the calling thread's cache has been destroyed (i.e. during thread exit),
+        // so that late deallocations go directly to the depot.
+        // Being trivially destructible, this flag stays usable until the very end of the thread
+        thread_local bool thread_cache_destroyed = false;
+
+        struct ThreadCache
+        {
+            std::array<Magazine, classes_count> magazines{};
+
+            ThreadCache() = default;
+
+            ThreadCache(const ThreadCache&) = delete;
+
+            ThreadCache& operator=(const ThreadCache&) = delete;
+
+            ~ThreadCache()
+            {
+                flush();
+                thread_cache_destroyed = true;
+            }
+
+            void flush() noexcept
+            {
+                for (std::size_t class_index = 0; class_index != classes_count; ++class_index)
+                    drain_to_depot(magazines[class_index], class_index, 0);
+            }
+        };
+
+        thread_local ThreadCache thread_cache;
+
+    } // namespace
+
+    std::size_t size_classes_count() noexcept
+    {
+        return classes_count;
+    }
+
+    std::size_t size_class_index(std::size_t size) noexcept
+    {
+        return size_class_table.index_by_granule[(size + min_block_size - 1) / min_block_size];
+    }
+
+    std::size_t size_class_block_size(std::size_t index) noexcept
+    {
+        return block_sizes[index];
+    }
+
+    void* allocate(std::size_t size)
+    {
+        if (size > max_small_size)
+            return ::operator new(size);
+
+        const auto class_index = size_class_index(size);
+
+        if (thread_cache_destroyed)
+        {
+            Magazine magazine{};
+            refill_from_depot(magazine, class_index);
+            void* const block = magazine.blocks[--magazine.count];
+            drain_to_depot(magazine, class_index, 0);
+            return block;
+        }
+
+        auto& magazine = thread_cache.magazines[class_index];
+        if (magazine.count == 0)
+            refill_from_depot(magazine, class_index);
+        return magazine.blocks[--magazine.count];
+    }
+
+    void deallocate(void* pointer, std::size_t size) noexcept
+    {
+        if (!pointer)
+            return;
+
+        if (size > max_small_size)
+        {
+            ::operator delete(pointer);
+            return;
+        }
+
+        const auto class_index = size_class_index(size);
+
+        if (thread_cache_destroyed)
+        {
+            auto& depot = central_depot().depots[class_index];
+            std::lock_guard lock{depot.mutex};
+            try
+            {
+                depot.free_blocks.push_back(pointer);
+            }
+            catch (const std::bad_alloc&)
+            {
+                // the block is leaked, but the thread is exiting anyway
+            }
+            return;
+        }
+
+        auto& magazine = thread_cache.magazines[class_index];
+        if (magazine.count == magazine_capacity)
+            drain_to_depot(magazine, class_index, magazine_capacity / 2);
+        magazine.blocks[magazine.count++] = pointer;
+    }
+
+    void flush_thread_cache() noexcept
+    {
+        if (!thread_cache_destroyed)
+            thread_cache.flush();
+    }
+
+    std::size_t release_unused_memory() noexcept
+    {
+        auto& central = central_depot();
+        std::size_t released_bytes = 0;
+
+        for (std::size_t class_index = 0; class_index != classes_count; ++class_index)
+        {
+            auto& depot = central.depots[class_index];
+            const auto blocks_per_slab = slab_size / block_sizes[class_index];
+
+            std::lock_guard lock{depot.mutex};
+
+            if (depot.free_blocks.size() < blocks_per_slab)
+                continue;
+
+            try
+            {
+                // A slab is completely free when all its blocks are in the depot
+                std::unordered_map<char*, std::size_t> free_blocks_count_by_slab;
+                for (void* block : depot.free_blocks)
+                    ++free_blocks_count_by_slab[slab_of(block)];
+
+                std::unordered_set<char*> free_slabs;
+                for (const auto& [slab, free_blocks_count] : free_blocks_count_by_slab)
+                {
+                    if (free_blocks_count == blocks_per_slab)
+                        free_slabs.insert(slab);
+                }
+
+                if (free_slabs.empty())
+                    continue;
+
+                const auto is_in_free_slab = [&](void* block) { return free_slabs.count(slab_of(block)) != 0; };
+                depot.free_blocks.erase(
+                    std::remove_if(depot.free_blocks.begin(), depot.free_blocks.end(), is_in_free_slab),
+                    depot.free_blocks.end());
+
+                const auto is_free_slab = [&](char* slab) { return free_slabs.count(slab) != 0; };
+                depot.slabs.erase(std::remove_if(depot.slabs.begin(), depot.slabs.end(), is_free_slab),
+                                  depot.slabs.end());
+
+                if (free_slabs.count(depot.carving_slab) != 0)
+                    depot.carving_slab = depot.carving_cursor = depot.carving_end = nullptr;
+
+                for (char* slab : free_slabs)
+                    unmap_slab(slab);
+
+                released_bytes += free_slabs.size() * slab_size;
+                central.mapped_bytes -= free_slabs.size() * slab_size;
+                central.slabs_count -= free_slabs.size();
+            }
+            catch (const std::bad_alloc&)
+            {
+                // not enough memory to sort the blocks: try again later
+            }
+        }
+
+        return released_bytes;
+    }
+
+    Statistics statistics() noexcept
+    {
+        auto& central = central_depot();
+
+        Statistics result{};
+        result.mapped_bytes = central.mapped_bytes;
+        result.slabs_count = central.slabs_count;
+        for (auto& depot : central.depots)
+        {
+            std::lock_guard lock{depot.mutex};
+            result.depot_free_blocks_count += depot.free_blocks.size();
+        }
+        return result;
+    }
+
+} // namespace ajcf::slab
+
+namespace {
+
+    TEST_CASE("slab size classes", "[slab][allocation]")
+    {
+        REQUIRE(ajcf::slab::size_class_block_size(ajcf::slab::size_class_index(0)) == 16);
+        REQUIRE(ajcf::slab::size_class_block_size(ajcf::slab::size_class_index(1)) == 16);
+        REQUIRE(ajcf::slab::size_class_block_size(ajcf::slab::size_class_index(16)) == 16);
+        REQUIRE(ajcf::slab::size_class_block_size(ajcf::slab::size_class_index(17)) == 32);
+        REQUIRE(ajcf::slab::size_class_block_size(ajcf::slab::size_class_index(129)) == 160);
+        REQUIRE(ajcf::slab::size_class_block_size(ajcf::slab::size_class_index(1000)) == 1024);
+        REQUIRE(ajcf::slab::size_class_block_size(ajcf::slab::size_class_index(1024)) == 1024);
+
+        // every size is served by the smallest block which can hold it
+        for (std::size_t size = 1; size <= ajcf::slab::max_small_size; ++size)
+        {
+            const auto index = ajcf::slab::size_class_index(size);
+            REQUIRE(ajcf::slab::size_class_block_size(index) >= size);
+            if (index != 0)
+                REQUIRE(ajcf::slab::size_class_block_size(index - 1) < size);
+        }
+    }
+
+    TEST_CASE("slab allocation and deallocation", "[slab][allocation]")
+    {
+        // a deallocated block is reused by the next allocation of the same size class on the same thread
+        void* const p1 = ajcf::slab::allocate(40);
+        REQUIRE(p1 != nullptr);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(p1) % ajcf::slab::max_small_alignment == 0);
+        ajcf::slab::deallocate(p1, 40);
+        void* const p2 = ajcf::slab::allocate(33);
+        REQUIRE(p2 == p1);
+        ajcf::slab::deallocate(p2, 33);
+
+        // big sizes are forwarded to operator new
+        void* const big = ajcf::slab::allocate(100'000);
+        REQUIRE(big != nullptr);
+        ajcf::slab::deallocate(big, 100'000);
+
+        // distinct live blocks never overlap
+        std::vector<char*> blocks;
+        for (int i = 0; i != 1000; ++i)
+        {
+            blocks.push_back(static_cast<char*>(ajcf::slab::allocate(48)));
+            std::fill_n(blocks.back(), 48, static_cast<char>(i));
+        }
+        for (int i = 0; i != 1000; ++i)
+        {
+            REQUIRE(std::all_of(blocks[i], blocks[i] + 48, [i](char c) { return c == static_cast<char>(i); }));
+            ajcf::slab::deallocate(blocks[i], 48);
+        }
+    }
+
+    TEST_CASE("slab blocks deallocated by another thread", "[slab][allocation][threads]")
+    {
+        constexpr std::size_t blocks_count = 10'000;
+        constexpr std::size_t block_size = 200;
+
+        std::vector<void*> blocks(blocks_count);
+
+        std::thread producer{[&] {
+            for (auto& block : blocks)
+                block = ajcf::slab::allocate(block_size);
+        }};
+        producer.join(); // the producer's cache is flushed to the depot when the thread exits
+
+        std::thread consumer{[&] {
+            for (auto block : blocks)
+                ajcf::slab::deallocate(block, block_size);
+        }};
+        consumer.join();
+
+        // all the blocks are back in the depot, so the slabs of this size class can be given back to the OS
+        const auto statistics_before = ajcf::slab::statistics();
+        const auto released_bytes = ajcf::slab::release_unused_memory();
+        const auto statistics_after = ajcf::slab::statistics();
+
+        REQUIRE(released_bytes >= (blocks_count * block_size) / ajcf::slab::slab_size * ajcf::slab::slab_size);
+        REQUIRE(statistics_after.mapped_bytes == statistics_before.mapped_bytes - released_bytes);
+    }
+
+    namespace benchmarks {
+
+        std::size_t current_resident_set_size()
+        {
+#if defined(__linux__)
+            std::ifstream statm{"/proc/self/statm"};
+            std::size_t total_pages{};
+            std::size_t resident_pages{};
+            if (statm >> total_pages >> resident_pages)
+                return resident_pages * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+            return 0;
+        }
+
+        struct MallocPolicy
+        {
+            static constexpr const char* name = "glibc malloc";
+
+            static void* allocate(std::size_t size)
+            {
+                return std::malloc(size);
+            }
+
+            static void deallocate(void* pointer, std::size_t)
+            {
+                std::free(pointer);
+            }
+
+            static void release_unused_memory()
+            {
+#if defined(__GLIBC__)
+                ::malloc_trim(0);
+#endif
+            }
+        };
+
+        struct SlabPolicy
+        {
+            static constexpr const char* name = "slab allocator";
+
+            static void* allocate(std::size_t size)
+            {
+                return ajcf::slab::allocate(size);
+            }
+
+            static void deallocate(void* pointer, std::size_t size)
+            {
+                ajcf::slab::deallocate(pointer, size);
+            }
+
+            static void release_unused_memory()
+            {
+                ajcf::slab::release_unused_memory();
+            }
+        };
+
+        struct Slot
+        {
+            void* pointer{};
+            std::size_t size{};
+        };
+
+        // Each thread keeps a ring of live objects of random small sizes,
+        // and replaces the oldest one at each iteration
+        template <typename Policy>
+        void churn_on_several_threads(std::size_t threads_count, std::size_t iterations_per_thread)
+        {
+            std::vector<std::thread> threads;
+            for (std::size_t thread_index = 0; thread_index != threads_count; ++thread_index)
+            {
+                threads.emplace_back([=] {
+                    std::minstd_rand random_engine{static_cast<unsigned>(thread_index + 1)};
+                    std::uniform_int_distribution<std::size_t> size_distribution{8, 512};
+                    std::vector<Slot> ring(1024);
+                    for (std::size_t iteration = 0; iteration != iterations_per_thread; ++iteration)
+                    {
+                        auto& slot = ring[iteration % ring.size()];
+                        Policy::deallocate(slot.pointer, slot.size);
+                        slot.size = size_distribution(random_engine);
+                        slot.pointer = Policy::allocate(slot.size);
+                        *static_cast<char*>(slot.pointer) = 1;
+                    }
+                    for (auto& slot : ring)
+                        Policy::deallocate(slot.pointer, slot.size);
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+        }
+
+        // Each thread allocates a batch of objects, then the batches are deallocated by the neighbour threads
+        template <typename Policy>
+        void hand_off_between_threads(std::size_t threads_count, std::size_t objects_per_thread)
+        {
+            std::vector<std::vector<Slot>> batches(threads_count, std::vector<Slot>(objects_per_thread));
+
+            std::vector<std::thread> threads;
+            for (std::size_t thread_index = 0; thread_index != threads_count; ++thread_index)
+            {
+                threads.emplace_back([&, thread_index] {
+                    std::size_t size = 8;
+                    for (auto& slot : batches[thread_index])
+                    {
+                        size = size % 512 + 24;
+                        slot = Slot{Policy::allocate(size), size};
+                    }
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+
+            threads.clear();
+            for (std::size_t thread_index = 0; thread_index != threads_count; ++thread_index)
+            {
+                threads.emplace_back([&, thread_index] {
+                    for (auto& slot : batches[(thread_index + 1) % threads_count])
+                        Policy::deallocate(slot.pointer, slot.size);
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+        }
+
+        template <typename Policy>
+        void flush_and_release()
+        {
+            ajcf::slab::flush_thread_cache();
+            Policy::release_unused_memory();
+        }
+
+        // Allocate lots of small objects, free 90% of them, then try to give the memory back to the OS
+        template <typename Policy>
+        void report_resident_set_size(std::size_t threads_count, std::size_t objects_per_thread)
+        {
+            const auto rss_at_start = current_resident_set_size();
+
+            std::vector<std::vector<Slot>> objects(threads_count);
+            std::vector<std::thread> threads;
+            for (std::size_t thread_index = 0; thread_index != threads_count; ++thread_index)
+            {
+                threads.emplace_back([&, thread_index] {
+                    std::minstd_rand random_engine{static_cast<unsigned>(thread_index + 1)};
+                    std::uniform_int_distribution<std::size_t> size_distribution{8, 256};
+                    auto& thread_objects = objects[thread_index];
+                    thread_objects.resize(objects_per_thread);
+                    for (auto& slot : thread_objects)
+                    {
+                        slot.size = size_distribution(random_engine);
+                        slot.pointer = Policy::allocate(slot.size);
+                        *static_cast<char*>(slot.pointer) = 1;
+                    }
+                    for (std::size_t index = 0; index != thread_objects.size(); ++index)
+                    {
+                        if (index % 10 != 0)
+                        {
+                            Policy::deallocate(thread_objects[index].pointer, thread_objects[index].size);
+                            thread_objects[index] = Slot{};
+                        }
+                    }
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+
+            const auto rss_with_10_percent_live = current_resident_set_size();
+
+            for (auto& thread_objects : objects)
+            {
+                for (auto& slot : thread_objects)
+                    Policy::deallocate(slot.pointer, slot.size);
+            }
+            flush_and_release<Policy>();
+
+            const auto rss_after_release = current_resident_set_size();
+
+            fmt::print("{:>16}: RSS at start {:>8} KiB, with 10% live objects {:>8} KiB, after release {:>8} KiB\n",
+                       Policy::name, rss_at_start / 1024, rss_with_10_percent_live / 1024, rss_after_release / 1024);
+        }
+
+        TEST_CASE("slab allocator vs malloc: multi-threaded churn", "[slab][allocation][benchmark][!hide]")
+        {
+            const auto threads_count = std::max(2U, std::thread::hardware_concurrency());
+
+            BENCHMARK("churn - glibc malloc")
+            {
+                churn_on_several_threads<MallocPolicy>(threads_count, 200'000);
+            };
+
+            BENCHMARK("churn - slab allocator")
+            {
+                churn_on_several_threads<SlabPolicy>(threads_count, 200'000);
+            };
+
+            BENCHMARK("hand-off - glibc malloc")
+            {
+                hand_off_between_threads<MallocPolicy>(threads_count, 100'000);
+            };
+
+            BENCHMARK("hand-off - slab allocator")
+            {
+                hand_off_between_threads<SlabPolicy>(threads_count, 100'000);
+            };
+        }
+
+        TEST_CASE("slab allocator vs malloc: resident set size", "[slab][allocation][benchmark][!hide]")
+        {
+            const auto threads_count = std::max(2U, std::thread::hardware_concurrency());
+
+            report_resident_set_size<SlabPolicy>(threads_count, 500'000);
+            report_resident_set_size<MallocPolicy>(threads_count, 500'000);
+        }
+
+    } // namespace benchmarks
+
+} // namespace
@@ -0,0 +1,107 @@
+// https://en.cppreference.com/w/cpp/named_req/Allocator
+// https://en.cppreference.com/w/cpp/language/storage_duration (thread_local)
+// https://www.usenix.org/legacy/event/usenix01/full_papers/bonwick/bonwick.pdf (magazines and depot)
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace ajcf {
+
+    // Size-class slab allocator for small objects (up to slab::max_small_size bytes)
+    // - memory is obtained from the OS by slabs of slab::slab_size bytes
+    // - each slab is cut in blocks of the same size class
+    // - each thread keeps a magazine (a small stack of free blocks) per size class,
+    //   so that most allocations and deallocations do not take any lock
+    // - when a magazine is empty or full, blocks are exchanged in bulk with a central depot (one mutex per size class)
+    // - when the program is idle, it can call release_unused_memory() to give completely free slabs back to the OS
+    namespace slab {
+
+        constexpr std::size_t min_block_size = 16;
+        constexpr std::size_t max_small_size = 1024;
+        constexpr std::size_t max_small_alignment = 16;
+        constexpr std::size_t slab_size = 64 * 1024;
+        constexpr std::size_t magazine_capacity = 64;
+
+        // Number of size classes and mapping between a requested size and its size class
+        std::size_t size_classes_count() noexcept;
+        std::size_t size_class_index(std::size_t size) noexcept;
+        std::size_t size_class_block_size(std::size_t index) noexcept;
+
+        // Allocate a block of at least size bytes, aligned on max_small_alignment
+        // Sizes bigger than max_small_size are forwarded to ::operator new
+        // Throw std::bad_alloc if no memory is available
+        void* allocate(std::size_t size);
+
+        // Deallocate a block previously returned by allocate(size), with the same size
+        // The block can be deallocated by any thread, not only the one which allocated it
+        void deallocate(void* pointer, std::size_t size) noexcept;
+
+        // Give all the blocks cached by the calling thread back to the central depot
+        // (this is done automatically when a thread exits)
+        void flush_thread_cache() noexcept;
+
+        // Give the completely free slabs back to the OS
+        // Return the number of bytes released
+        std::size_t release_unused_memory() noexcept;
+
+        struct Statistics
+        {
+            std::size_t mapped_bytes{};
+            std::size_t slabs_count{};
+            std::size_t depot_free_blocks_count{};
+        };
+
+        Statistics statistics() noexcept;
+
+    } // namespace slab
+
+    // Standard allocator that can be plugged in any standard container:
+    //   std::vector<int, ajcf::SlabAllocator<int>>
+    //   std::map<int, double, std::less<>, ajcf::SlabAllocator<std::pair<const int, double>>>
+    template <typename T>
+    class SlabAllocator
+    {
+    public:
+        using value_type = T;
+
+        SlabAllocator() = default;
+
+        template <typename U>
+        SlabAllocator(const SlabAllocator<U>&) noexcept
+        {
+        }
+
+        T* allocate(std::size_t n)
+        {
+            if (n > static_cast<std::size_t>(-1) / sizeof(T))
+                throw std::bad_array_new_length();
+            if constexpr (alignof(T) > slab::max_small_alignment)
+                return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+            else
+                return static_cast<T*>(slab::allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* pointer, std::size_t n) noexcept
+        {
+            if constexpr (alignof(T) > slab::max_small_alignment)
+                ::operator delete(pointer, std::align_val_t{alignof(T)});
+            else
+                slab::deallocate(pointer, n * sizeof(T));
+        }
+
+        template <typename U>
+        bool operator==(const SlabAllocator<U>&) const noexcept
+        {
+            return true;
+        }
+
+        template <typename U>
+        bool operator!=(const SlabAllocator<U>&) const noexcept
+        {
+            return false;
+        }
+    };
+
+} // namespace ajcf
@@ -0,0 +1,133 @@
+// https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2023/p3019r0.pdf (indirect and polymorphic)
+
+#include "small_value.hpp"
+#include "allocation_counter.hpp"
+#include <catch2/catch.hpp>
+#include <array>
+#include <memory>
+#include <string>
+
+namespace {
+
+    class Shape
+    {
+    public:
+        virtual ~Shape() = default;
+
+        virtual double area() const = 0;
+
+    protected:
+        Shape() = default;
+        Shape(const Shape&) = default;
+        Shape& operator=(const Shape&) = default;
+    };
+
+    class Square : public Shape
+    {
+    public:
+        explicit Square(double side) : m_side(side)
+        {
+        }
+
+        double area() const override
+        {
+            return m_side * m_side;
+        }
+
+    private:
+        double m_side;
+    };
+
+    // too big to be stored inline
+    class Polygon : public Shape
+    {
+    public:
+        explicit Polygon(double area) : m_area(area)
+        {
+        }
+
+        double area() const override
+        {
+            return m_area;
+        }
+
+    private:
+        std::array<double, 8> m_points{};
+        double m_area;
+    };
+
+    static_assert(ajcf::SmallValue<Shape>::fits_inline<Square>);
+    static_assert(!ajcf::SmallValue<Shape>::fits_inline<Polygon>);
+    // an int needs room only for itself
+    static_assert(sizeof(ajcf::SmallValue<int>) <= 3 * sizeof(void*));
+
+    TEST_CASE("small values", "[classes][small_value]")
+    {
+        ajcf::AllocationCounter counter;
+
+        ajcf::SmallValue<int> number{std::in_place, 42};
+        auto copy = number;
+        *copy += 1;
+
+        REQUIRE(*number == 42);
+        REQUIRE(*copy == 43);
+        REQUIRE(number.is_inline());
+        REQUIRE(*ajcf::SmallValue<int>{} == 0);
+
+        ajcf::SmallValue<Shape> square{std::in_place_type<Square>, 3.0};
+        auto square_copy = square;
+
+        // the copy is a Square, not a sliced Shape
+        REQUIRE(square_copy->area() == 9.0);
+        REQUIRE(square_copy.is_inline());
+        REQUIRE(counter.allocations() == 0);
+
+        ajcf::SmallValue<Shape> polygon{std::in_place_type<Polygon>, 12.5};
+
+        REQUIRE(!polygon.is_inline());
+        REQUIRE(counter.allocations() == 1);
+
+        // the allocated value is moved without allocation, the moved from value is empty
+        auto moved = std::move(polygon);
+
+        REQUIRE(counter.allocations() == 1);
+        REQUIRE(moved->area() == 12.5);
+        REQUIRE(polygon.valueless_after_move());
+
+        // swap between inline and allocated values
+        swap(square, moved);
+
+        REQUIRE(square->area() == 12.5);
+        REQUIRE(!square.is_inline());
+        REQUIRE(moved->area() == 9.0);
+        REQUIRE(moved.is_inline());
+
+        polygon = square;
+
+        REQUIRE(polygon->area() == 12.5);
+        REQUIRE(counter.allocations() == 2);
+    }
+
+    TEST_CASE("small values destroy their values", "[classes][small_value]")
+    {
+        const auto counter = std::make_shared<int>(0);
+        {
+            using Value = ajcf::SmallValue<std::shared_ptr<int>>;
+            Value value{std::in_place, counter};
+            auto copy = value;
+
+            REQUIRE(counter.use_count() == 3);
+
+            auto moved = std::move(copy);
+
+            REQUIRE(counter.use_count() == 3);
+
+            moved = Value{};
+
+            REQUIRE(counter.use_count() == 2);
+        }
+
+        REQUIRE(counter.use_count() == 1);
+    }
+
+} // namespace
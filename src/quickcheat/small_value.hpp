@@ -0,0 +1,241 @@
+// https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2023/p3019r0.pdf (indirect and polymorphic)
+// https://en.cppreference.com/w/cpp/language/new (placement new)
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ajcf {
+
+    // Value stored in the object when it is small, else in dynamic memory: a replacement of std::unique_ptr<T>
+    // for the members which are values, with the copy of a value (a deep copy) instead of no copy at all
+    // - SmallValue<T> holds a T, or any type derived from T which is copied as itself (like polymorphic_value)
+    // - a value of at most InlineSize bytes, not over-aligned and nothrow movable is stored inside the object,
+    //   the bigger ones are allocated
+    // - when T cannot have derived types (not a class, or a final class), everything is decided at compile time,
+    //   else the copy, the move and the destruction go through a table of functions of the stored type
+    // - like a moved from std::unique_ptr, a moved from SmallValue is empty (valueless_after_move)
+    //   ajcf::SmallValue<int> number{std::in_place, 42};       // no allocation
+    //   ajcf::SmallValue<Shape> shape{std::in_place_type<Circle>, 2.5}; // no allocation if Circle is small
+    //   auto copy = shape;                                       // a copy of the Circle
+    template <typename T, std::size_t InlineSize = 2 * sizeof(void*)>
+    class SmallValue
+    {
+    public:
+        static constexpr std::size_t inline_size = InlineSize;
+
+        // Whether a value of type U is stored inside the object
+        template <typename U>
+        static constexpr bool fits_inline = sizeof(U) <= InlineSize && alignof(U) <= alignof(std::max_align_t) &&
+                                            std::is_nothrow_move_constructible_v<U>;
+
+        SmallValue() : SmallValue(std::in_place_type<T>)
+        {
+        }
+
+        template <typename... Args>
+        explicit SmallValue(std::in_place_t, Args&&... args)
+            : SmallValue(std::in_place_type<T>, std::forward<Args>(args)...)
+        {
+        }
+
+        template <typename U, typename... Args>
+        explicit SmallValue(std::in_place_type_t<U>, Args&&... args)
+        {
+            static_assert(std::is_same_v<U, T> || std::is_base_of_v<T, U>, "the type must be T or derived from T");
+            static_assert(std::is_same_v<U, T> || !is_closed, "T cannot have derived types");
+            static_assert(std::is_copy_constructible_v<U>, "the values are copied");
+
+            if constexpr (fits_inline<U>)
+                m_pointer = ::new (static_cast<void*>(&m_storage)) U(std::forward<Args>(args)...);
+            else
+                m_pointer = new U(std::forward<Args>(args)...);
+            if constexpr (!is_closed)
+                m_operations = &operations_of<U>;
+        }
+
+        SmallValue(const SmallValue& other)
+        {
+            if (other.m_pointer)
+                copy_from(other);
+        }
+
+        SmallValue(SmallValue&& other) noexcept
+        {
+            if (other.m_pointer)
+                move_from(other);
+        }
+
+        SmallValue& operator=(const SmallValue& other)
+        {
+            if (this != &other)
+            {
+                SmallValue copy{other};
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        SmallValue& operator=(SmallValue&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                if (other.m_pointer)
+                    move_from(other);
+            }
+            return *this;
+        }
+
+        ~SmallValue()
+        {
+            reset();
+        }
+
+        void swap(SmallValue& other) noexcept
+        {
+            SmallValue moved{std::move(other)};
+            other = std::move(*this);
+            *this = std::move(moved);
+        }
+
+        friend void swap(SmallValue& left, SmallValue& right) noexcept
+        {
+            left.swap(right);
+        }
+
+        T& operator*() noexcept
+        {
+            return *m_pointer;
+        }
+
+        const T& operator*() const noexcept
+        {
+            return *m_pointer;
+        }
+
+        T* operator->() noexcept
+        {
+            return m_pointer;
+        }
+
+        const T* operator->() const noexcept
+        {
+            return m_pointer;
+        }
+
+        bool valueless_after_move() const noexcept
+        {
+            return m_pointer == nullptr;
+        }
+
+        // Whether the value is stored inside the object (no dynamic allocation)
+        bool is_inline() const noexcept
+        {
+            return m_pointer && static_cast<const void*>(m_pointer) >= static_cast<const void*>(&m_storage) &&
+                   static_cast<const void*>(m_pointer) < static_cast<const void*>(&m_storage + 1);
+        }
+
+    private:
+        static constexpr bool is_closed = !std::is_class_v<T> || std::is_final_v<T>;
+
+        // The functions of the stored type U, for the types T which can have derived types
+        // (the derived types are found from a T* by static_cast: T must not be a virtual base)
+        struct Operations
+        {
+            T* (*copy)(void* storage, const T* source);
+            T* (*move)(void* storage, T* source) noexcept; // the source is left empty
+            void (*destroy)(T* value) noexcept;
+        };
+
+        template <typename U>
+        static constexpr Operations operations_of{
+            [](void* storage, const T* source) -> T* {
+                if constexpr (fits_inline<U>)
+                    return ::new (storage) U(*static_cast<const U*>(source));
+                else
+                    return new U(*static_cast<const U*>(source));
+            },
+            [](void* storage, T* source) noexcept -> T* {
+                if constexpr (fits_inline<U>)
+                {
+                    U* const moved = ::new (storage) U(std::move(*static_cast<U*>(source)));
+                    static_cast<U*>(source)->~U();
+                    return moved;
+                }
+                else
+                    return source; // the allocated value changes of owner
+            },
+            [](T* value) noexcept {
+                if constexpr (fits_inline<U>)
+                    static_cast<U*>(value)->~U();
+                else
+                    delete static_cast<U*>(value);
+            },
+        };
+
+        void copy_from(const SmallValue& other)
+        {
+            if constexpr (is_closed)
+            {
+                if constexpr (fits_inline<T>)
+                    m_pointer = ::new (static_cast<void*>(&m_storage)) T(*other.m_pointer);
+                else
+                    m_pointer = new T(*other.m_pointer);
+            }
+            else
+            {
+                m_pointer = other.m_operations->copy(&m_storage, other.m_pointer);
+                m_operations = other.m_operations;
+            }
+        }
+
+        void move_from(SmallValue& other) noexcept
+        {
+            if constexpr (is_closed)
+            {
+                if constexpr (fits_inline<T>)
+                {
+                    m_pointer = ::new (static_cast<void*>(&m_storage)) T(std::move(*other.m_pointer));
+                    other.m_pointer->~T();
+                }
+                else
+                    m_pointer = other.m_pointer;
+            }
+            else
+            {
+                m_pointer = other.m_operations->move(&m_storage, other.m_pointer);
+                m_operations = std::exchange(other.m_operations, nullptr);
+            }
+            other.m_pointer = nullptr;
+        }
+
+        void reset() noexcept
+        {
+            if (!m_pointer)
+                return;
+            if constexpr (is_closed)
+            {
+                if constexpr (fits_inline<T>)
+                    m_pointer->~T();
+                else
+                    delete m_pointer;
+            }
+            else
+                m_operations->destroy(m_pointer);
+            m_pointer = nullptr;
+        }
+
+        // a closed type needs room only for itself
+        static constexpr std::size_t storage_size = !is_closed ? InlineSize : fits_inline<T> ? sizeof(T) : 1;
+        static constexpr std::size_t storage_alignment = !is_closed ? alignof(std::max_align_t) : alignof(T);
+
+        std::aligned_storage_t<storage_size, storage_alignment> m_storage;
+        T* m_pointer{nullptr}; // to the storage or to the allocated value, nullptr when valueless
+        const Operations* m_operations{nullptr};
+    };
+
+} // namespace ajcf
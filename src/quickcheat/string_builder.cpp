@@ -0,0 +1,108 @@
+// https://fmt.dev/latest/api.html#output-iterator-support (fmt::memory_buffer)
+// https://en.cppreference.com/w/cpp/io/basic_stringstream
+
+#include "string_builder.hpp"
+#include "allocation_counter.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+    TEST_CASE("string builder", "[strings][string_builder]")
+    {
+        ajcf::AllocationCounter counter;
+
+        ajcf::StringBuilder builder;
+        builder << "There are " << 3 << " parameters: " << 'A' << ", " << std::string_view("view") << ", " << -12L;
+
+        REQUIRE(builder.view() == "There are 3 parameters: A, view, -12");
+        REQUIRE(builder.is_inline());
+        REQUIRE(counter.allocations() == 0);
+
+        builder.clear();
+        builder.append(3, '-').append("format: ").format("{}+{}={:>4}", 1, 2, 3);
+
+        REQUIRE(builder.view() == "---format: 1+2=   3");
+
+        // the characters which do not fit inside the builder are moved to a dynamic storage
+        ajcf::BasicStringBuilder<16> small_builder;
+        small_builder << "0123456789" << "abcdefghij";
+
+        REQUIRE(!small_builder.is_inline());
+        REQUIRE(small_builder.str() == "0123456789abcdefghij");
+    }
+
+    TEST_CASE("string builder vs std::stringstream: same texts", "[strings][string_builder]")
+    {
+        std::stringstream stream;
+        ajcf::StringBuilder builder;
+
+        const std::string text = "text";
+        stream << 12 << ' ' << 23.45 << ' ' << 1e20 << ' ' << 0.1f << ' ' << true << ' ' << text << ' ' << -7LL << ' '
+               << 42u;
+        builder << 12 << ' ' << 23.45 << ' ' << 1e20 << ' ' << 0.1f << ' ' << true << ' ' << text << ' ' << -7LL << ' '
+                << 42u;
+
+        REQUIRE(builder.str() == stream.str());
+
+        // the types of characters are characters, not numbers
+        std::stringstream characters_stream;
+        ajcf::StringBuilder characters_builder;
+        characters_stream << std::uint8_t{65} << static_cast<signed char>('B') << static_cast<unsigned char>('C')
+                          << std::int8_t{68} << std::uint16_t{69};
+        characters_builder << std::uint8_t{65} << static_cast<signed char>('B') << static_cast<unsigned char>('C')
+                           << std::int8_t{68} << std::uint16_t{69};
+
+        REQUIRE(characters_builder.str() == characters_stream.str());
+        REQUIRE(characters_builder.str() == "ABCD69");
+    }
+
+    namespace benchmarks {
+
+        TEST_CASE("string builder vs std::stringstream: building a line", "[strings][string_builder][benchmark][!hide]")
+        {
+            const std::string name = "quantity";
+
+            BENCHMARK("std::stringstream")
+            {
+                std::stringstream stream;
+                stream << "line " << 1234 << ": " << name << " = " << 56.78 << ", valid = " << true;
+                return stream.str();
+            };
+
+            BENCHMARK("fmt::format")
+            {
+                return fmt::format("line {}: {} = {}, valid = {}", 1234, name, 56.78, true);
+            };
+
+            BENCHMARK("ajcf::StringBuilder")
+            {
+                ajcf::StringBuilder builder;
+                builder << "line " << 1234 << ": " << name << " = " << 56.78 << ", valid = " << true;
+                return builder.str();
+            };
+
+            const auto count_allocations = [](auto&& function) {
+                ajcf::AllocationCounter counter;
+                function();
+                return counter.allocations();
+            };
+            fmt::print("allocations: std::stringstream {}, ajcf::StringBuilder {}\n", count_allocations([&] {
+                           std::stringstream stream;
+                           stream << "line " << 1234 << ": " << name << " = " << 56.78 << ", valid = " << true;
+                           return stream.str();
+                       }),
+                       count_allocations([&] {
+                           ajcf::StringBuilder builder;
+                           builder << "line " << 1234 << ": " << name << " = " << 56.78 << ", valid = " << true;
+                           return builder.str();
+                       }));
+        }
+
+    } // namespace benchmarks
+
+} // namespace
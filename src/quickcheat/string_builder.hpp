@@ -0,0 +1,164 @@
+// https://fmt.dev/latest/api.html#output-iterator-support (fmt::memory_buffer)
+// https://en.cppreference.com/w/cpp/io/basic_stringstream
+
+#pragma once
+
+#include "number_formatting.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ajcf {
+
+    // Builder of strings, a replacement of std::stringstream when it is only used to build a string:
+    // - no locale, no virtual call, no sentry object for each operator<<
+    // - the first InlineCapacity characters are stored inside the object (on the stack), so building a short
+    //   string does not allocate any dynamic memory, only the final str() does (if it does not fit in the SSO)
+    // - the texts are the same as with a default std::stringstream (bool as 0/1, floating-point like %g)
+    //   ajcf::StringBuilder builder;
+    //   builder << "color = " << 12 << " (" << name << ")";
+    //   builder.format(" at {}:{}", line, column);
+    //   return builder.str();
+    template <std::size_t InlineCapacity>
+    class BasicStringBuilder
+    {
+    public:
+        static constexpr std::size_t inline_capacity = InlineCapacity;
+
+        BasicStringBuilder() = default;
+
+        // fmt::basic_memory_buffer can only be moved
+        BasicStringBuilder(const BasicStringBuilder&) = delete;
+        BasicStringBuilder& operator=(const BasicStringBuilder&) = delete;
+        BasicStringBuilder(BasicStringBuilder&&) = default;
+        BasicStringBuilder& operator=(BasicStringBuilder&&) = default;
+
+        std::size_t size() const noexcept
+        {
+            return m_buffer.size();
+        }
+
+        bool empty() const noexcept
+        {
+            return m_buffer.size() == 0;
+        }
+
+        // Whether the characters are still inside the object
+        bool is_inline() const noexcept
+        {
+            return m_buffer.capacity() <= InlineCapacity;
+        }
+
+        void reserve(std::size_t capacity)
+        {
+            m_buffer.reserve(capacity);
+        }
+
+        void clear() noexcept
+        {
+            m_buffer.clear();
+        }
+
+        BasicStringBuilder& append(std::string_view text)
+        {
+            m_buffer.append(text.data(), text.data() + text.size());
+            return *this;
+        }
+
+        BasicStringBuilder& append(std::size_t count, char character)
+        {
+            const auto size = m_buffer.size();
+            m_buffer.resize(size + count);
+            std::fill_n(m_buffer.data() + size, count, character);
+            return *this;
+        }
+
+        BasicStringBuilder& append(char character)
+        {
+            m_buffer.push_back(character);
+            return *this;
+        }
+
+        // Append the text formatted like fmt::format does
+        template <typename... Args>
+        BasicStringBuilder& format(fmt::string_view format_text, const Args&... args)
+        {
+            fmt::format_to(m_buffer, format_text, args...);
+            return *this;
+        }
+
+        BasicStringBuilder& operator<<(std::string_view text)
+        {
+            return append(text);
+        }
+
+        BasicStringBuilder& operator<<(const char* text)
+        {
+            return append(std::string_view(text));
+        }
+
+        BasicStringBuilder& operator<<(const std::string& text)
+        {
+            return append(std::string_view(text));
+        }
+
+        BasicStringBuilder& operator<<(char character)
+        {
+            return append(character);
+        }
+
+        // like std::stringstream: the other types of characters (std::int8_t and std::uint8_t too) are characters
+        BasicStringBuilder& operator<<(signed char character)
+        {
+            return append(static_cast<char>(character));
+        }
+
+        BasicStringBuilder& operator<<(unsigned char character)
+        {
+            return append(static_cast<char>(character));
+        }
+
+        // like std::stringstream without std::boolalpha
+        BasicStringBuilder& operator<<(bool value)
+        {
+            return append(value ? '1' : '0');
+        }
+
+        template <typename Integer, std::enable_if_t<std::is_integral_v<Integer>, int> = 0>
+        BasicStringBuilder& operator<<(Integer value)
+        {
+            return append(FormattedNumber<Integer>{value}.view());
+        }
+
+        // like std::stringstream with the default precision of 6 significant digits
+        template <typename Float, std::enable_if_t<std::is_floating_point_v<Float>, int> = 0>
+        BasicStringBuilder& operator<<(Float value)
+        {
+            return format("{:g}", value);
+        }
+
+        std::string_view view() const noexcept
+        {
+            return std::string_view(m_buffer.data(), m_buffer.size());
+        }
+
+        operator std::string_view() const noexcept
+        {
+            return view();
+        }
+
+        std::string str() const
+        {
+            return std::string(m_buffer.data(), m_buffer.size());
+        }
+
+    private:
+        fmt::basic_memory_buffer<char, InlineCapacity> m_buffer;
+    };
+
+    using StringBuilder = BasicStringBuilder<256>;
+
+} // namespace ajcf
@@ -0,0 +1,435 @@
+// https://en.wikipedia.org/wiki/String_interning
+// https://en.wikipedia.org/wiki/Region-based_memory_management
+// https://en.cppreference.com/w/cpp/thread/shared_mutex
+
+#include "string_pool.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ajcf {
+
+    namespace {
+
+        constexpr std::size_t shards_count = 16;
+
+        // Strings are copied into blocks of this size; longer strings get a block of their own
+        constexpr std::size_t block_size = 64 * 1024;
+        constexpr std::size_t max_shared_block_string_size = block_size / 8;
+
+        using Header = InternedString::Header;
+
+        struct EmptyEntry
+        {
+            Header header;
+            char chars[1];
+        };
+
+        // the empty string of all the pools
+        const EmptyEntry empty_entry{{0, 0}, {'\0'}};
+
+        static_assert(offsetof(EmptyEntry, chars) == sizeof(Header), "characters must follow the header");
+
+        // A string in a shard, with its hash computed once
+        struct Key
+        {
+            std::string_view text;
+            std::size_t hash;
+        };
+
+        struct KeyHash
+        {
+            std::size_t operator()(const Key& key) const noexcept
+            {
+                return key.hash;
+            }
+        };
+
+        struct KeyEqual
+        {
+            bool operator()(const Key& left, const Key& right) const noexcept
+            {
+                return left.hash == right.hash && left.text == right.text;
+            }
+        };
+
+        std::size_t entry_size(std::size_t text_size) noexcept
+        {
+            // header, characters and '\0', rounded up so that the next header is aligned
+            const auto size = sizeof(Header) + text_size + 1;
+            return (size + alignof(Header) - 1) / alignof(Header) * alignof(Header);
+        }
+
+    } // namespace
+
+    InternedString::InternedString() noexcept : m_chars(empty_entry.chars)
+    {
+    }
+
+    struct alignas(64) StringPool::Shard
+    {
+        // store a copy of text (and its header) in the arena
+        const char* store(std::string_view text, std::size_t hash)
+        {
+            const auto size = entry_size(text.size());
+            char* entry = nullptr;
+            if (text.size() > max_shared_block_string_size)
+            {
+                blocks.push_back(std::make_unique<char[]>(size));
+                allocated_bytes += size;
+                entry = blocks.back().get();
+            }
+            else
+            {
+                if (static_cast<std::size_t>(free_end - free_begin) < size)
+                {
+                    blocks.push_back(std::make_unique<char[]>(block_size));
+                    allocated_bytes += block_size;
+                    free_begin = blocks.back().get();
+                    free_end = free_begin + block_size;
+                }
+                entry = free_begin;
+                free_begin += size;
+            }
+
+            ::new (static_cast<void*>(entry)) Header{hash, text.size()};
+            char* const chars = entry + sizeof(Header);
+            std::memcpy(chars, text.data(), text.size());
+            chars[text.size()] = '\0';
+            return chars;
+        }
+
+        mutable std::shared_mutex mutex;
+        std::unordered_set<Key, KeyHash, KeyEqual> strings;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char* free_begin{nullptr};
+        char* free_end{nullptr};
+        std::size_t allocated_bytes{0};
+    };
+
+    StringPool::StringPool() : m_shards(std::make_unique<Shard[]>(shards_count))
+    {
+    }
+
+    StringPool::~StringPool() = default;
+
+    StringPool::Shard& StringPool::shard(std::size_t hash) const noexcept
+    {
+        // the high bits: the low ones select the buckets inside the shard
+        return m_shards[(hash >> 24) % shards_count];
+    }
+
+    InternedString StringPool::intern(std::string_view text)
+    {
+        if (text.empty())
+            return InternedString();
+
+        const Key key{text, std::hash<std::string_view>{}(text)};
+        auto& text_shard = shard(key.hash);
+
+        {
+            // fast path: the string is already interned
+            std::shared_lock lock{text_shard.mutex};
+            const auto found = text_shard.strings.find(key);
+            if (found != text_shard.strings.end())
+                return InternedString(found->text.data());
+        }
+
+        std::unique_lock lock{text_shard.mutex};
+        // another thread may have interned the same string between the two locks
+        const auto found = text_shard.strings.find(key);
+        if (found != text_shard.strings.end())
+            return InternedString(found->text.data());
+
+        const char* const chars = text_shard.store(text, key.hash);
+        text_shard.strings.insert(Key{std::string_view(chars, text.size()), key.hash});
+        return InternedString(chars);
+    }
+
+    InternedString StringPool::find(std::string_view text) const
+    {
+        if (text.empty())
+            return InternedString();
+
+        const Key key{text, std::hash<std::string_view>{}(text)};
+        auto& text_shard = shard(key.hash);
+        std::shared_lock lock{text_shard.mutex};
+        const auto found = text_shard.strings.find(key);
+        return found != text_shard.strings.end() ? InternedString(found->text.data()) : InternedString();
+    }
+
+    std::size_t StringPool::size() const
+    {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i != shards_count; ++i)
+        {
+            std::shared_lock lock{m_shards[i].mutex};
+            count += m_shards[i].strings.size();
+        }
+        return count;
+    }
+
+    std::size_t StringPool::allocated_bytes() const
+    {
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; i != shards_count; ++i)
+        {
+            std::shared_lock lock{m_shards[i].mutex};
+            bytes += m_shards[i].allocated_bytes;
+        }
+        return bytes;
+    }
+
+    StringPool& global_string_pool()
+    {
+        static StringPool pool;
+        return pool;
+    }
+
+} // namespace ajcf
+
+namespace {
+
+    TEST_CASE("interned strings", "[strings][interning]")
+    {
+        ajcf::StringPool pool;
+
+        const auto title = pool.intern("window.title");
+        const auto same_title = pool.intern(std::string("window.") + "title");
+        const auto width = pool.intern("window.width");
+
+        // one copy of each string: equality only compares the handles
+        REQUIRE(title == same_title);
+        REQUIRE(title.c_str() == same_title.c_str());
+        REQUIRE(title != width);
+        REQUIRE(title.view() == "window.title");
+        REQUIRE(std::string_view(width.c_str()) == "window.width");
+        REQUIRE(title.hash() == std::hash<std::string_view>{}("window.title"));
+        REQUIRE(pool.size() == 2);
+
+        // look up without adding
+        REQUIRE(pool.find("window.width") == width);
+        REQUIRE(pool.find("window.height").empty());
+        REQUIRE(pool.size() == 2);
+
+        // the empty string is the same for all the pools
+        REQUIRE(pool.intern("") == ajcf::InternedString());
+        REQUIRE(ajcf::intern("") == ajcf::InternedString());
+        REQUIRE(ajcf::InternedString().view().empty());
+        REQUIRE(pool.size() == 2);
+
+        std::unordered_map<ajcf::InternedString, int> sizes;
+        sizes[title] = 1;
+        sizes[width] = 640;
+        sizes[same_title] += 1;
+
+        REQUIRE(sizes.size() == 2);
+        REQUIRE(sizes[pool.intern("window.title")] == 2);
+    }
+
+    TEST_CASE("interned strings arena", "[strings][interning]")
+    {
+        ajcf::StringPool pool;
+
+        std::vector<ajcf::InternedString> handles;
+        for (int i = 0; i != 10'000; ++i)
+            handles.push_back(pool.intern(fmt::format("identifier_{}", i)));
+        const auto long_string = std::string(100'000, 'x');
+        handles.push_back(pool.intern(long_string));
+
+        REQUIRE(pool.size() == 10'001);
+        // a few blocks of 64 KiB per shard, and one block for the long string
+        REQUIRE(pool.allocated_bytes() < 2 * 1024 * 1024);
+
+        bool all_strings_kept = true;
+        for (int i = 0; i != 10'000; ++i)
+        {
+            const auto text = fmt::format("identifier_{}", i);
+            all_strings_kept &= handles[i].view() == text && pool.intern(text) == handles[i];
+        }
+
+        REQUIRE(all_strings_kept);
+        REQUIRE(handles.back().view() == long_string);
+    }
+
+    TEST_CASE("interned strings from several threads", "[strings][interning][threads]")
+    {
+        ajcf::StringPool pool;
+        constexpr int threads_count = 8;
+        constexpr int strings_count = 2'000;
+
+        std::vector<std::vector<ajcf::InternedString>> handles(threads_count);
+        std::vector<std::thread> threads;
+        for (int t = 0; t != threads_count; ++t)
+        {
+            threads.emplace_back([&pool, &handles, t] {
+                // all the threads intern the same strings, starting at different positions
+                for (int i = 0; i != strings_count; ++i)
+                {
+                    const auto index = (i + t * 97) % strings_count;
+                    handles[t].push_back(pool.intern(fmt::format("name_{}", index)));
+                }
+                std::sort(handles[t].begin(), handles[t].end(),
+                          [](auto left, auto right) { return left.view() < right.view(); });
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        const auto all_threads_got_the_same_handles = std::all_of(
+            handles.begin(), handles.end(), [&handles](const auto& thread_handles) {
+                return std::set<ajcf::InternedString>(thread_handles.begin(), thread_handles.end()) ==
+                       std::set<ajcf::InternedString>(handles[0].begin(), handles[0].end());
+            });
+
+        REQUIRE(all_threads_got_the_same_handles);
+    }
+
+    namespace benchmarks {
+
+        // same settings as ConfigurationDatabase in types_algebraic.cpp
+        const std::vector<std::pair<std::string, std::string>> settings = {
+            {"window.title", "hello world"},
+            {"window.width", "640"},
+            {"window.height", "480"},
+            {"backup.date_time", "2019/12/09 09:30:00"},
+            {"backup.file", "c:\\hello\\world.cpp"},
+            {"compiler", "msvc"},
+        };
+
+        TEST_CASE("interned strings vs std::string: settings lookups", "[strings][interning][benchmark][!hide]")
+        {
+            std::map<std::string, std::string> map_settings;
+            std::unordered_map<std::string, std::string> unordered_map_settings;
+            std::unordered_map<ajcf::InternedString, ajcf::InternedString> interned_settings;
+            std::vector<std::string> names;
+            std::vector<ajcf::InternedString> interned_names;
+            for (const auto& [name, value] : settings)
+            {
+                map_settings[name] = value;
+                unordered_map_settings[name] = value;
+                interned_settings[ajcf::intern(name)] = ajcf::intern(value);
+                names.push_back(name);
+                interned_names.push_back(ajcf::intern(name));
+            }
+
+            constexpr int lookups_count = 1'000'000;
+
+            BENCHMARK("1M lookups - std::map<std::string, std::string>")
+            {
+                std::size_t found = 0;
+                for (int i = 0; i != lookups_count; ++i)
+                    found += map_settings.find(names[i % names.size()])->second.size();
+                return found;
+            };
+
+            BENCHMARK("1M lookups - std::unordered_map<std::string, std::string>")
+            {
+                std::size_t found = 0;
+                for (int i = 0; i != lookups_count; ++i)
+                    found += unordered_map_settings.find(names[i % names.size()])->second.size();
+                return found;
+            };
+
+            BENCHMARK("1M lookups - std::unordered_map<InternedString, InternedString>")
+            {
+                std::size_t found = 0;
+                for (int i = 0; i != lookups_count; ++i)
+                    found += interned_settings.find(interned_names[i % interned_names.size()])->second.size();
+                return found;
+            };
+        }
+
+        // same comparisons as example_if in conditions_and_loops.cpp
+        int classify(const std::string& sound)
+        {
+            if (sound == "miaou" || sound == "ouaf")
+                return 1;
+            if (sound == "cuicui")
+                return 2;
+            return 3;
+        }
+
+        int classify(ajcf::InternedString sound)
+        {
+            static const auto miaou = ajcf::intern("miaou");
+            static const auto ouaf = ajcf::intern("ouaf");
+            static const auto cuicui = ajcf::intern("cuicui");
+            if (sound == miaou || sound == ouaf)
+                return 1;
+            if (sound == cuicui)
+                return 2;
+            return 3;
+        }
+
+        TEST_CASE("interned strings vs std::string: comparisons", "[strings][interning][benchmark][!hide]")
+        {
+            const std::vector<std::string> sounds = {"miaou", "ouaf", "cuicui", "meuh", "cuicuicui"};
+            std::vector<ajcf::InternedString> interned_sounds;
+            for (const auto& sound : sounds)
+                interned_sounds.push_back(ajcf::intern(sound));
+
+            constexpr int comparisons_count = 1'000'000;
+
+            BENCHMARK("1M classifications - std::string")
+            {
+                int sum = 0;
+                for (int i = 0; i != comparisons_count; ++i)
+                    sum += classify(sounds[i % sounds.size()]);
+                return sum;
+            };
+
+            BENCHMARK("1M classifications - InternedString")
+            {
+                int sum = 0;
+                for (int i = 0; i != comparisons_count; ++i)
+                    sum += classify(interned_sounds[i % interned_sounds.size()]);
+                return sum;
+            };
+        }
+
+        TEST_CASE("interned strings: interning from several threads", "[strings][interning][benchmark][!hide]")
+        {
+            std::vector<std::string> names;
+            for (int i = 0; i != 10'000; ++i)
+                names.push_back(fmt::format("identifier_{}", i));
+
+            for (const int threads_count : {1, 2, 4, 8})
+            {
+                BENCHMARK(fmt::format("intern 10k strings x 10 in {} threads", threads_count))
+                {
+                    ajcf::StringPool pool;
+                    std::atomic<std::size_t> sizes{0};
+                    std::vector<std::thread> threads;
+                    for (int t = 0; t != threads_count; ++t)
+                    {
+                        threads.emplace_back([&] {
+                            std::size_t size = 0;
+                            for (int round = 0; round != 10; ++round)
+                                for (const auto& name : names)
+                                    size += pool.intern(name).size();
+                            sizes += size;
+                        });
+                    }
+                    for (auto& thread : threads)
+                        thread.join();
+                    return sizes.load();
+                };
+            }
+        }
+
+    } // namespace benchmarks
+
+} // namespace
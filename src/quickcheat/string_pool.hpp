@@ -0,0 +1,156 @@
+// https://en.wikipedia.org/wiki/String_interning
+// https://en.cppreference.com/w/cpp/thread/shared_mutex
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string_view>
+
+namespace ajcf {
+
+    class StringPool;
+
+    // Handle on a string stored once in a StringPool
+    // It is only a pointer: copies, equality and hashing are O(1), whatever the length of the string
+    // Two handles from the same pool are equal if and only if their strings are equal
+    // (the empty string is shared by all the pools)
+    // The characters live as long as the pool which interned them
+    class InternedString
+    {
+    public:
+        // Empty string
+        InternedString() noexcept;
+
+        std::string_view view() const noexcept
+        {
+            return std::string_view(m_chars, header().size);
+        }
+
+        const char* c_str() const noexcept
+        {
+            return m_chars;
+        }
+
+        std::size_t size() const noexcept
+        {
+            return header().size;
+        }
+
+        bool empty() const noexcept
+        {
+            return header().size == 0;
+        }
+
+        // Hash of the characters (0 for the empty string), computed once when the string was interned
+        std::size_t hash() const noexcept
+        {
+            return header().hash;
+        }
+
+        operator std::string_view() const noexcept
+        {
+            return view();
+        }
+
+        friend bool operator==(InternedString left, InternedString right) noexcept
+        {
+            return left.m_chars == right.m_chars;
+        }
+
+        friend bool operator!=(InternedString left, InternedString right) noexcept
+        {
+            return !(left == right);
+        }
+
+        // Arbitrary but consistent order, cheaper than comparing the characters
+        friend bool operator<(InternedString left, InternedString right) noexcept
+        {
+            return std::less<const char*>{}(left.m_chars, right.m_chars);
+        }
+
+        friend std::ostream& operator<<(std::ostream& stream, InternedString string)
+        {
+            return stream << string.view();
+        }
+
+        // Stored just before the characters
+        struct Header
+        {
+            std::size_t hash;
+            std::size_t size;
+        };
+
+    private:
+        friend class StringPool;
+
+        explicit InternedString(const char* chars) noexcept : m_chars(chars)
+        {
+        }
+
+        const Header& header() const noexcept
+        {
+            return *reinterpret_cast<const Header*>(m_chars - sizeof(Header));
+        }
+
+        const char* m_chars;
+    };
+
+    // Thread-safe set of unique strings
+    // - the characters are copied into big blocks of memory (arena): one string never needs its own allocation
+    // - the pool is split into shards selected by hash, each one with its own lock, so that threads
+    //   interning different strings rarely wait for each other; looking up an existing string takes a shared lock
+    // - strings are never removed: a pool is meant for a bounded vocabulary (names, keywords, identifiers, ...)
+    class StringPool
+    {
+    public:
+        StringPool();
+        ~StringPool();
+
+        StringPool(const StringPool&) = delete;
+        StringPool& operator=(const StringPool&) = delete;
+
+        // Handle on the unique copy of text, added to the pool if needed
+        InternedString intern(std::string_view text);
+
+        // Handle on the unique copy of text if it is already in the pool, else the empty string
+        InternedString find(std::string_view text) const;
+
+        // Number of unique strings
+        std::size_t size() const;
+
+        // Number of bytes allocated for the characters
+        std::size_t allocated_bytes() const;
+
+    private:
+        struct Shard;
+
+        Shard& shard(std::size_t hash) const noexcept;
+
+        std::unique_ptr<Shard[]> m_shards;
+    };
+
+    // Pool of the whole program, for strings interned with ajcf::intern
+    StringPool& global_string_pool();
+
+    inline InternedString intern(std::string_view text)
+    {
+        return global_string_pool().intern(text);
+    }
+
+} // namespace ajcf
+
+namespace std {
+
+    template <>
+    struct hash<ajcf::InternedString>
+    {
+        std::size_t operator()(ajcf::InternedString string) const noexcept
+        {
+            return string.hash();
+        }
+    };
+
+} // namespace std
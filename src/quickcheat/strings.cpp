@@ -4,6 +4,10 @@
 // https://en.cppreference.com/w/cpp/header/string_view
 // https://en.cppreference.com/w/cpp/header/cstring
 
+#include "allocation_counter.hpp"
+#include "inline_string.hpp"
+#include "simd_string.hpp"
+#include "utf8.hpp"
 #include <string_view>
 #include <catch2/catch.hpp>
 #include <cstring>
@@ -28,6 +32,7 @@ namespace {
         // The string literal "Hello++" is allocated in the static storage.
         // The object cpp_string is allocated in the automatic storage.
         // But class std::string copies the litteral characters into a dyanmic storage.
+        // (except short strings like this one, copied inside the object: small string optimization)
         std::string cpp_string = "Hello++";
 
         REQUIRE(cpp_string == "Hello++");
@@ -94,6 +99,55 @@ namespace {
             compute_length_by_searching_for_zero_terminator(c_string_which_max_size_is_not_known_anymore);
 
         REQUIRE(computed_length == 5);
+
+        // same computation, but comparing 16 or 32 characters at once with SIMD instructions
+        // (like std::strlen does behind the scene)
+        const auto vectorized_length = ajcf::simd::string_length(c_string_which_max_size_is_not_known_anymore);
+
+        REQUIRE(vectorized_length == 5);
+    }
+
+    TEST_CASE("strings without dynamic storage", "[strings]")
+    {
+        ajcf::AllocationCounter counter;
+
+        // std::string stores only 15 characters inside the object (with libstdc++ and MSVC)
+        std::string cpp_string = "Hello++ Hello++ Hello++";
+
+        REQUIRE(counter.allocations() == 1);
+
+        // fixed capacity string, all the characters are inside the object
+        ajcf::InlineString<31> inline_string = "Hello++ Hello++ Hello++";
+
+        // up to 32 characters inside the object, more in a dynamic storage
+        ajcf::SmallString<32> small_string = "Hello++ Hello++ Hello++";
+
+        REQUIRE(inline_string == cpp_string);
+        REQUIRE(small_string == cpp_string);
+        REQUIRE(counter.allocations() == 1);
+
+        // both are usable through a view
+        std::string_view view_on_a_string = inline_string;
+
+        REQUIRE(view_on_a_string.length() == 23);
+    }
+
+    TEST_CASE("UTF-8 strings", "[strings]")
+    {
+        // std::string stores bytes: a character which is not ASCII takes 2 to 4 of them in UTF-8
+        const std::string text = "\xC3\xA9t\xC3\xA9 \xE2\x82\xAC"; // "été €"
+
+        REQUIRE(text.size() == 9);
+        REQUIRE(ajcf::utf8::is_valid(text));
+        REQUIRE(ajcf::utf8::count_code_points(text) == 5);
+
+        // a substring can cut a character, the result is not valid anymore
+        REQUIRE_FALSE(ajcf::utf8::is_valid(text.substr(0, 1)));
+
+        // std::u16string and std::u32string store code units of UTF-16 and UTF-32
+        REQUIRE(ajcf::utf8::to_utf16(text) == u"\u00E9t\u00E9 \u20AC");
+        REQUIRE(ajcf::utf8::to_utf32(text).size() == 5);
+        REQUIRE(ajcf::utf8::from_utf32(U"\u00E9t\u00E9 \u20AC") == text);
     }
 
 } // namespace
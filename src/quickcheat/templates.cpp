@@ -4,6 +4,7 @@
 // https://en.cppreference.com/w/cpp/language/static_assert
 // https://en.cppreference.com/w/cpp/header/type_traits
 
+#include "string_builder.hpp"
 #include <type_traits>
 #include <catch2/catch.hpp>
 #include <fmt/format.h>
@@ -192,26 +193,28 @@ namespace {
         REQUIRE(!is_enum<int>);
     }
 
-    void print_impl([[maybe_unused]] std::ostream& out, [[maybe_unused]] std::size_t index)
+    // Output is a std::ostream or an ajcf::StringBuilder
+    template <typename Output>
+    void print_impl([[maybe_unused]] Output& out, [[maybe_unused]] std::size_t index)
     {
     }
 
-    template <typename Param>
-    void print_impl(std::ostream& out, std::size_t index, Param param)
+    template <typename Output, typename Param>
+    void print_impl(Output& out, std::size_t index, Param param)
     {
         out << "[" << index << "]=" << param;
     }
 
-    template <typename FirstParam, typename SecondParam, typename... Params>
-    void print_impl(std::ostream& out, std::size_t index, FirstParam first, SecondParam second, Params... params)
+    template <typename Output, typename FirstParam, typename SecondParam, typename... Params>
+    void print_impl(Output& out, std::size_t index, FirstParam first, SecondParam second, Params... params)
     {
         print_impl(out, index, first);
         out << ", ";
         print_impl(out, index + 1, second, params...);
     }
 
-    template <typename... Params>
-    void count_and_print(std::ostream& out, Params... params)
+    template <typename Output, typename... Params>
+    void count_and_print(Output& out, Params... params)
     {
         out << "There are " << sizeof...(params) << " parameters: ";
         print_impl(out, 0, params...);
@@ -239,6 +242,12 @@ namespace {
             count_and_print(out, 12, 23.45, 'A', "hello", true);
             REQUIRE(out.str() == "There are 5 parameters: [0]=12, [1]=23.45, [2]=A, [3]=hello, [4]=1");
         }
+        {
+            // same text without std::ostream
+            ajcf::StringBuilder out{};
+            count_and_print(out, 12, 23.45, 'A', "hello", true);
+            REQUIRE(out.view() == "There are 5 parameters: [0]=12, [1]=23.45, [2]=A, [3]=hello, [4]=1");
+        }
     }
 
     template <typename... Params>
@@ -273,4 +282,26 @@ namespace {
         REQUIRE(sum_with_init(1, 21, 87, 32, 1) == 142);
     }
 
+    namespace benchmarks {
+
+        TEST_CASE("count_and_print: std::stringstream vs ajcf::StringBuilder",
+                  "[templates][string_builder][benchmark][!hide]")
+        {
+            BENCHMARK("count_and_print - std::stringstream")
+            {
+                std::stringstream out{};
+                count_and_print(out, 12, 23.45, 'A', "hello", true);
+                return out.str();
+            };
+
+            BENCHMARK("count_and_print - ajcf::StringBuilder")
+            {
+                ajcf::StringBuilder out{};
+                count_and_print(out, 12, 23.45, 'A', "hello", true);
+                return out.str();
+            };
+        }
+
+    } // namespace benchmarks
+
 } // namespace
@@ -0,0 +1,206 @@
+// https://en.cppreference.com/w/cpp/string/basic_string_view
+// https://en.cppreference.com/w/cpp/utility/from_chars
+
+#include "tokenizer.hpp"
+#include "allocation_counter.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+    std::vector<std::string> pieces(ajcf::SplitRange range)
+    {
+        return std::vector<std::string>(range.begin(), range.end());
+    }
+
+    TEST_CASE("splitting strings without copies", "[strings][tokenizer]")
+    {
+        using Pieces = std::vector<std::string>;
+
+        REQUIRE(pieces(ajcf::split("hello big world", " ")) == Pieces{"hello", "big", "world"});
+        REQUIRE(pieces(ajcf::split("a,,b,", ",")) == Pieces{"a", "", "b", ""});
+        REQUIRE(pieces(ajcf::split("a,,b,", ",", ajcf::EmptyPieces::skip)) == Pieces{"a", "b"});
+        REQUIRE(pieces(ajcf::split("", ",")) == Pieces{""});
+        REQUIRE(pieces(ajcf::split("", ",", ajcf::EmptyPieces::skip)).empty());
+        REQUIRE(pieces(ajcf::split("no delimiter", ",")) == Pieces{"no delimiter"});
+
+        // several delimiters
+        REQUIRE(pieces(ajcf::split("12+34*5-6", "+-*/")) == Pieces{"12", "34", "5", "6"});
+
+        // the pieces are views on the text
+        const std::string text = "window.title=hello world;window.width=640";
+        ajcf::AllocationCounter counter;
+        std::size_t pieces_count = 0;
+        bool pieces_are_views = true;
+        std::string delimiters;
+        const auto text_pieces = ajcf::split(text, "=;");
+        for (auto iter = text_pieces.begin(); iter != text_pieces.end(); ++iter)
+        {
+            pieces_are_views &= iter->data() >= text.data() && iter->data() + iter->size() <= text.data() + text.size();
+            if (iter.delimiter())
+                delimiters += iter.delimiter();
+            ++pieces_count;
+        }
+
+        REQUIRE(pieces_are_views);
+        REQUIRE(counter.allocations() == 0);
+        REQUIRE(pieces_count == 4);
+        REQUIRE(delimiters == "=;=");
+
+        // the iterators can outlive their range
+        auto piece = ajcf::split(text, "=;", ajcf::EmptyPieces::skip).begin();
+        ++piece;
+
+        REQUIRE(*piece == "hello world");
+        REQUIRE(*++piece == "window.width");
+
+        // long texts cross the vectorized kernels' blocks
+        std::string long_text;
+        for (int i = 0; i != 1000; ++i)
+            long_text += fmt::format("{}{}", i, i % 3 == 0 ? ',' : ';');
+        const auto range = ajcf::split(long_text, ",;", ajcf::EmptyPieces::skip);
+        int expected = 0;
+        const auto all_numbers_found = std::all_of(range.begin(), range.end(), [&expected](std::string_view piece) {
+            return piece == std::to_string(expected++);
+        });
+
+        REQUIRE(all_numbers_found);
+        REQUIRE(expected == 1000);
+    }
+
+    TEST_CASE("splitting strings once", "[strings][tokenizer]")
+    {
+        const auto [first_operand, operator_char, second_operand] = ajcf::split_once("12*78", "+-*/");
+
+        REQUIRE(first_operand == "12");
+        REQUIRE(operator_char == '*');
+        REQUIRE(second_operand == "78");
+
+        const auto not_split = ajcf::split_once("1278", "+-*/");
+
+        REQUIRE(not_split.before == "1278");
+        REQUIRE(not_split.delimiter == '\0');
+        REQUIRE(not_split.after.empty());
+    }
+
+    namespace benchmarks {
+
+        // same parsing as demo_function_objects in function_objects.cpp
+        int evaluate_with_substr(const std::string& expression)
+        {
+            const auto iter_operator = std::find_if(expression.begin(), expression.end(), [](char c) {
+                return c == '+' || c == '-' || c == '*' || c == '/';
+            });
+            if (iter_operator == expression.end())
+                throw std::invalid_argument("No arithmetic operator in expression");
+
+            const auto first_operand = std::stoi(expression.substr(0, iter_operator - expression.begin()));
+            const auto second_operand = std::stoi(expression.substr(iter_operator - expression.begin() + 1));
+
+            switch (*iter_operator)
+            {
+            case '+':
+                return first_operand + second_operand;
+            case '-':
+                return first_operand - second_operand;
+            case '*':
+                return first_operand * second_operand;
+            default:
+                return first_operand / second_operand;
+            }
+        }
+
+        int to_int(std::string_view text)
+        {
+            int value = 0;
+            const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+            if (error != std::errc() || end != text.data() + text.size())
+                throw std::invalid_argument("Invalid operand");
+            return value;
+        }
+
+        int evaluate_with_string_views(std::string_view expression)
+        {
+            const auto [text_first_operand, operator_char, text_second_operand] =
+                ajcf::split_once(expression, "+-*/");
+            if (operator_char == '\0')
+                throw std::invalid_argument("No arithmetic operator in expression");
+
+            const auto first_operand = to_int(text_first_operand);
+            const auto second_operand = to_int(text_second_operand);
+
+            switch (operator_char)
+            {
+            case '+':
+                return first_operand + second_operand;
+            case '-':
+                return first_operand - second_operand;
+            case '*':
+                return first_operand * second_operand;
+            default:
+                return first_operand / second_operand;
+            }
+        }
+
+        TEST_CASE("string_view tokenizer vs substr: parsing expressions", "[strings][tokenizer][benchmark][!hide]")
+        {
+            // 1M expressions "a+b" with operands of 1 to 6 digits, parsed 10 times
+            std::vector<std::string> expressions;
+            std::string text;
+            constexpr char operators[] = "+-*/";
+            for (int i = 0; i != 1'000'000; ++i)
+            {
+                expressions.push_back(fmt::format("{}{}{}", i % 1'000'000, operators[i % 4], i % 1000 + 1));
+                text += expressions.back();
+                text += '\n';
+            }
+
+            constexpr int rounds_count = 10;
+
+            {
+                ajcf::AllocationCounter counter;
+                const auto result = evaluate_with_substr(expressions[123'456]);
+                fmt::print("substr: {} allocations per expression\n", counter.allocations());
+            }
+            {
+                ajcf::AllocationCounter counter;
+                const auto result = evaluate_with_string_views(expressions[123'456]);
+                fmt::print("string_view: {} allocations per expression\n", counter.allocations());
+            }
+
+            BENCHMARK("10M expressions - substr and std::stoi")
+            {
+                long long sum = 0;
+                for (int round = 0; round != rounds_count; ++round)
+                    for (const auto& expression : expressions)
+                        sum += evaluate_with_substr(expression);
+                return sum;
+            };
+
+            BENCHMARK("10M expressions - string_view and std::from_chars")
+            {
+                long long sum = 0;
+                for (int round = 0; round != rounds_count; ++round)
+                    for (const auto& expression : expressions)
+                        sum += evaluate_with_string_views(expression);
+                return sum;
+            };
+
+            BENCHMARK("10M expressions - split lines of one text, string_view and std::from_chars")
+            {
+                long long sum = 0;
+                for (int round = 0; round != rounds_count; ++round)
+                    for (const auto line : ajcf::split(text, "\n", ajcf::EmptyPieces::skip))
+                        sum += evaluate_with_string_views(line);
+                return sum;
+            };
+        }
+
+    } // namespace benchmarks
+
+} // namespace
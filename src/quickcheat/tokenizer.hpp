@@ -0,0 +1,177 @@
+// https://en.cppreference.com/w/cpp/string/basic_string_view
+// https://en.cppreference.com/w/cpp/ranges/lazy_split_view (same idea, for C++17)
+
+#pragma once
+
+#include "simd_string.hpp"
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+
+namespace ajcf {
+
+    enum class EmptyPieces
+    {
+        keep, // "a,,b" gives "a", "", "b"
+        skip, // "a,,b" gives "a", "b"
+    };
+
+    // Lazy range of the pieces of a text separated by any of some delimiter characters
+    // The pieces are views on the text: splitting never copies nor allocates, the text must outlive the range
+    // The iterators keep their own views on the text and on the delimiters: they can outlive the range
+    // The delimiters are searched with the vectorized kernels of ajcf::simd
+    //   for (std::string_view word : ajcf::split("hello big world", " "))
+    //       ...
+    class SplitRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const std::string_view*;
+            using reference = const std::string_view&;
+
+            // end of any range
+            iterator() noexcept = default;
+
+            reference operator*() const noexcept
+            {
+                return m_piece;
+            }
+
+            pointer operator->() const noexcept
+            {
+                return &m_piece;
+            }
+
+            // Delimiter found just after the current piece, '\0' for the last piece
+            char delimiter() const noexcept
+            {
+                return m_delimiter;
+            }
+
+            // Rest of the text, after the delimiter which follows the current piece
+            std::string_view rest() const noexcept
+            {
+                return m_rest;
+            }
+
+            iterator& operator++() noexcept
+            {
+                do
+                    next();
+                while (!m_at_end && m_empty_pieces == EmptyPieces::skip && m_piece.empty());
+                return *this;
+            }
+
+            iterator operator++(int) noexcept
+            {
+                auto copy = *this;
+                ++*this;
+                return copy;
+            }
+
+            friend bool operator==(const iterator& left, const iterator& right) noexcept
+            {
+                return left.m_at_end == right.m_at_end && left.m_piece.data() == right.m_piece.data();
+            }
+
+            friend bool operator!=(const iterator& left, const iterator& right) noexcept
+            {
+                return !(left == right);
+            }
+
+        private:
+            friend class SplitRange;
+
+            explicit iterator(const SplitRange& range) noexcept
+                : m_rest(range.m_text),
+                  m_delimiters(range.m_delimiters),
+                  m_empty_pieces(range.m_empty_pieces),
+                  m_at_end(false)
+            {
+                ++*this;
+            }
+
+            void next() noexcept
+            {
+                if (!m_has_rest)
+                {
+                    *this = iterator();
+                    return;
+                }
+                const auto position = m_delimiters.size() == 1 ? simd::find_char(m_rest, m_delimiters[0])
+                                                               : simd::find_any_of(m_rest, m_delimiters);
+                if (position == std::string_view::npos)
+                {
+                    m_piece = m_rest;
+                    m_delimiter = '\0';
+                    m_rest = std::string_view(m_rest.data() + m_rest.size(), 0);
+                    m_has_rest = false;
+                    return;
+                }
+                m_piece = m_rest.substr(0, position);
+                m_delimiter = m_rest[position];
+                m_rest.remove_prefix(position + 1);
+            }
+
+            std::string_view m_piece{};
+            std::string_view m_rest{};
+            std::string_view m_delimiters{};
+            EmptyPieces m_empty_pieces{EmptyPieces::keep};
+            char m_delimiter{'\0'};
+            bool m_has_rest{true};
+            bool m_at_end{true};
+        };
+
+        using const_iterator = iterator;
+
+        SplitRange(std::string_view text, std::string_view delimiters,
+                   EmptyPieces empty_pieces = EmptyPieces::keep) noexcept
+            : m_text(text), m_delimiters(delimiters), m_empty_pieces(empty_pieces)
+        {
+        }
+
+        iterator begin() const noexcept
+        {
+            return iterator(*this);
+        }
+
+        iterator end() const noexcept
+        {
+            return iterator();
+        }
+
+    private:
+        std::string_view m_text;
+        std::string_view m_delimiters;
+        EmptyPieces m_empty_pieces;
+    };
+
+    inline SplitRange split(std::string_view text, std::string_view delimiters,
+                            EmptyPieces empty_pieces = EmptyPieces::keep) noexcept
+    {
+        return SplitRange(text, delimiters, empty_pieces);
+    }
+
+    // Text split in two around its first delimiter
+    struct SplitOnce
+    {
+        std::string_view before;
+        char delimiter; // '\0' if the text contains no delimiter
+        std::string_view after;
+    };
+
+    // "12+34" split on "+-*/" gives {"12", '+', "34"}, "1234" gives {"1234", '\0', ""}
+    inline SplitOnce split_once(std::string_view text, std::string_view delimiters) noexcept
+    {
+        const auto position = simd::find_any_of(text, delimiters);
+        if (position == std::string_view::npos)
+            return {text, '\0', std::string_view(text.data() + text.size(), 0)};
+        return {text.substr(0, position), text[position], text.substr(position + 1)};
+    }
+
+} // namespace ajcf
@@ -1,4 +1,6 @@
 
+#include "rope.hpp"
+#include "string_pool.hpp"
 #include <catch2/catch.hpp>
 #include <fmt/format.h>
 #include <chrono>
@@ -7,6 +9,7 @@
 #include <sstream>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <variant>
 
 namespace {
@@ -112,6 +115,22 @@ namespace {
             return ss.str();
         }
 
+        // same text, built without copying the whole text each time the buffer grows:
+        // the lines are appended in chunks, flattened only if the caller needs one string
+        ajcf::Rope display_all_as_rope() const
+        {
+            ajcf::Rope result;
+            for (const auto& [name, value] : m_settings)
+            {
+                result += "Setting '";
+                result += name;
+                result += "' = '";
+                result += value;
+                result += "'\n";
+            }
+            return result;
+        }
+
     private:
         std::map<std::string, std::string> m_settings;
     };
@@ -130,6 +149,7 @@ namespace {
         const auto settings = cdb.display_all();
 
         REQUIRE(!settings.empty());
+        REQUIRE(cdb.display_all_as_rope() == settings);
 
         const auto title = cdb.get("window.title");
 
@@ -141,6 +161,42 @@ namespace {
         REQUIRE(!unknown.has_value());
     }
 
+    // same database, but the setting names are interned once:
+    // looking up a setting only hashes and compares a pointer instead of the characters of the name
+    class InternedConfigurationDatabase
+    {
+    public:
+        void set(ajcf::InternedString name, const std::string& value)
+        {
+            m_settings[name] = value;
+        }
+
+        std::optional<std::string> get(ajcf::InternedString name) const
+        {
+            const auto iter_setting = m_settings.find(name);
+            if (iter_setting == m_settings.end())
+                return std::nullopt;
+            return iter_setting->second;
+        }
+
+    private:
+        std::unordered_map<ajcf::InternedString, std::string> m_settings;
+    };
+
+    TEST_CASE("usage of std::optional with interned names", "[optional][functional]")
+    {
+        const auto window_title = ajcf::intern("window.title");
+        const auto compiler = ajcf::intern("compiler");
+
+        InternedConfigurationDatabase cdb;
+
+        cdb.set(window_title, "hello world");
+        cdb.set(compiler, "msvc");
+
+        REQUIRE(cdb.get(ajcf::intern("window.title")) == "hello world");
+        REQUIRE(!cdb.get(ajcf::intern("unknown")).has_value());
+    }
+
 } // namespace
 
 class SameAsTuple
@@ -0,0 +1,961 @@
+// https://en.wikipedia.org/wiki/UTF-8
+// https://en.wikipedia.org/wiki/UTF-16
+// https://arxiv.org/abs/2010.03090 (Keiser, Lemire: Validating UTF-8 in less than one instruction per byte)
+
+#include "utf8.hpp"
+#include "simd_target.hpp"
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ajcf::utf8 {
+
+    namespace {
+
+        // Decode the code point at the beginning of [first, last) (which must not be empty)
+        // Return its length in bytes, or 0 if it is not well-formed
+        inline std::size_t decode(const unsigned char* first, const unsigned char* last, char32_t& code_point) noexcept
+        {
+            const auto available = last - first;
+            const unsigned lead = first[0];
+            if (lead < 0x80)
+            {
+                code_point = lead;
+                return 1;
+            }
+            if (lead < 0xC2) // continuation byte or overlong 2-byte sequence
+                return 0;
+            if (lead < 0xE0)
+            {
+                if (available < 2 || (first[1] & 0xC0) != 0x80)
+                    return 0;
+                code_point = ((lead & 0x1F) << 6) | (first[1] & 0x3F);
+                return 2;
+            }
+            if (lead < 0xF0)
+            {
+                // E0: no overlong encoding, ED: no surrogate
+                const unsigned min_second = lead == 0xE0 ? 0xA0 : 0x80;
+                const unsigned max_second = lead == 0xED ? 0x9F : 0xBF;
+                if (available < 3 || first[1] < min_second || first[1] > max_second || (first[2] & 0xC0) != 0x80)
+                    return 0;
+                code_point = ((lead & 0x0F) << 12) | ((first[1] & 0x3F) << 6) | (first[2] & 0x3F);
+                return 3;
+            }
+            if (lead < 0xF5)
+            {
+                // F0: no overlong encoding, F4: nothing above U+10FFFF
+                const unsigned min_second = lead == 0xF0 ? 0x90 : 0x80;
+                const unsigned max_second = lead == 0xF4 ? 0x8F : 0xBF;
+                if (available < 4 || first[1] < min_second || first[1] > max_second || (first[2] & 0xC0) != 0x80 ||
+                    (first[3] & 0xC0) != 0x80)
+                    return 0;
+                code_point = ((lead & 0x07) << 18) | ((first[1] & 0x3F) << 12) | ((first[2] & 0x3F) << 6) |
+                             (first[3] & 0x3F);
+                return 4;
+            }
+            return 0;
+        }
+
+        // Encode a valid code point, return its length in bytes
+        inline std::size_t encode(char32_t code_point, char* output) noexcept
+        {
+            if (code_point < 0x80)
+            {
+                output[0] = static_cast<char>(code_point);
+                return 1;
+            }
+            if (code_point < 0x800)
+            {
+                output[0] = static_cast<char>(0xC0 | (code_point >> 6));
+                output[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+                return 2;
+            }
+            if (code_point < 0x10000)
+            {
+                output[0] = static_cast<char>(0xE0 | (code_point >> 12));
+                output[1] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+                output[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+                return 3;
+            }
+            output[0] = static_cast<char>(0xF0 | (code_point >> 18));
+            output[1] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+            output[2] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            output[3] = static_cast<char>(0x80 | (code_point & 0x3F));
+            return 4;
+        }
+
+        inline std::size_t write_utf16(char32_t code_point, char16_t* output) noexcept
+        {
+            if (code_point < 0x10000)
+            {
+                output[0] = static_cast<char16_t>(code_point);
+                return 1;
+            }
+            code_point -= 0x10000;
+            output[0] = static_cast<char16_t>(0xD800 + (code_point >> 10));
+            output[1] = static_cast<char16_t>(0xDC00 + (code_point & 0x3FF));
+            return 2;
+        }
+
+        const unsigned char* bytes(const char* pointer) noexcept
+        {
+            return reinterpret_cast<const unsigned char*>(pointer);
+        }
+
+        // The scalar kernels also process the characters which the vectorized kernels cannot handle in blocks:
+        // they stop at the first code point starting at or after stop
+        namespace scalar {
+
+            // Return the position after the last validated code point, or nullptr if the text is not valid
+            const char* validate_until(const char* first, const char* last, const char* stop) noexcept
+            {
+                char32_t code_point{};
+                while (first < stop)
+                {
+                    const auto length = decode(bytes(first), bytes(last), code_point);
+                    if (length == 0)
+                        return nullptr;
+                    first += length;
+                }
+                return first;
+            }
+
+            const char* to_utf16_until(const char* first, const char* last, const char* stop,
+                                       char16_t*& output) noexcept
+            {
+                char32_t code_point{};
+                while (first < stop)
+                {
+                    const auto length = decode(bytes(first), bytes(last), code_point);
+                    if (length == 0)
+                        return nullptr;
+                    first += length;
+                    output += write_utf16(code_point, output);
+                }
+                return first;
+            }
+
+            const char* to_utf32_until(const char* first, const char* last, const char* stop,
+                                       char32_t*& output) noexcept
+            {
+                char32_t code_point{};
+                while (first < stop)
+                {
+                    const auto length = decode(bytes(first), bytes(last), code_point);
+                    if (length == 0)
+                        return nullptr;
+                    first += length;
+                    *output++ = code_point;
+                }
+                return first;
+            }
+
+            const char16_t* from_utf16_until(const char16_t* first, const char16_t* last, const char16_t* stop,
+                                             char*& output) noexcept
+            {
+                while (first < stop)
+                {
+                    char32_t code_point = *first++;
+                    if (code_point >= 0xD800 && code_point <= 0xDFFF)
+                    {
+                        // a high surrogate must be followed by a low surrogate
+                        if (code_point > 0xDBFF || first == last || *first < 0xDC00 || *first > 0xDFFF)
+                            return nullptr;
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (*first++ - 0xDC00);
+                    }
+                    output += encode(code_point, output);
+                }
+                return first;
+            }
+
+            bool validate(const char* first, const char* last) noexcept
+            {
+                return validate_until(first, last, last) != nullptr;
+            }
+
+            std::size_t count_code_points(const char* first, const char* last) noexcept
+            {
+                std::size_t count = 0;
+                for (; first != last; ++first)
+                    count += (static_cast<unsigned char>(*first) & 0xC0) != 0x80 ? 1 : 0;
+                return count;
+            }
+
+            std::size_t to_utf16(const char* first, const char* last, char16_t* output) noexcept
+            {
+                auto* const output_first = output;
+                if (!to_utf16_until(first, last, last, output))
+                    return invalid;
+                return static_cast<std::size_t>(output - output_first);
+            }
+
+            std::size_t to_utf32(const char* first, const char* last, char32_t* output) noexcept
+            {
+                auto* const output_first = output;
+                if (!to_utf32_until(first, last, last, output))
+                    return invalid;
+                return static_cast<std::size_t>(output - output_first);
+            }
+
+            std::size_t from_utf16(const char16_t* first, const char16_t* last, char* output) noexcept
+            {
+                auto* const output_first = output;
+                if (!from_utf16_until(first, last, last, output))
+                    return invalid;
+                return static_cast<std::size_t>(output - output_first);
+            }
+
+            std::size_t from_utf32(const char32_t* first, const char32_t* last, char* output) noexcept
+            {
+                auto* const output_first = output;
+                for (; first != last; ++first)
+                {
+                    if (*first > 0x10FFFF || (*first >= 0xD800 && *first <= 0xDFFF))
+                        return invalid;
+                    output += encode(*first, output);
+                }
+                return static_cast<std::size_t>(output - output_first);
+            }
+
+            constexpr Utf8Kernels kernels{&validate,   &count_code_points, &to_utf16,
+                                          &to_utf32,   &from_utf16,        &from_utf32};
+
+        } // namespace scalar
+
+#if defined(AJCF_SIMD_X86)
+
+        namespace sse2 {
+
+            bool is_ascii(__m128i block) noexcept
+            {
+                return _mm_movemask_epi8(block) == 0;
+            }
+
+            bool validate(const char* first, const char* last) noexcept
+            {
+                while (last - first >= 16)
+                {
+                    const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                    if (is_ascii(block))
+                    {
+                        first += 16;
+                        continue;
+                    }
+                    // validate the code points starting in the next 4 blocks, the last one can end after them:
+                    // the texts which are not only ASCII rarely go back to ASCII for a whole block
+                    first = scalar::validate_until(first, last, first + std::min<std::ptrdiff_t>(last - first, 64));
+                    if (!first)
+                        return false;
+                }
+                return scalar::validate(first, last);
+            }
+
+            std::size_t count_code_points(const char* first, const char* last) noexcept
+            {
+                // the continuation bytes are 0x80 to 0xBF, i.e. -128 to -65 as signed bytes
+                const auto max_continuation_byte = _mm_set1_epi8(-65);
+                const auto zero = _mm_setzero_si128();
+                std::size_t count = 0;
+                while (last - first >= 16)
+                {
+                    // each byte counter can be incremented at most 255 times before overflowing
+                    const auto blocks_count = std::min<std::ptrdiff_t>((last - first) / 16, 255);
+                    auto counters = _mm_setzero_si128();
+                    for (std::ptrdiff_t index = 0; index != blocks_count; ++index, first += 16)
+                    {
+                        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                        counters = _mm_sub_epi8(counters, _mm_cmpgt_epi8(block, max_continuation_byte));
+                    }
+                    const auto sums = _mm_sad_epu8(counters, zero);
+                    count += static_cast<std::size_t>(_mm_cvtsi128_si32(sums)) +
+                             static_cast<std::size_t>(_mm_extract_epi16(sums, 4));
+                }
+                return count + scalar::count_code_points(first, last);
+            }
+
+            std::size_t to_utf16(const char* first, const char* last, char16_t* output) noexcept
+            {
+                auto* const output_first = output;
+                const auto zero = _mm_setzero_si128();
+                while (last - first >= 16)
+                {
+                    const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                    if (is_ascii(block))
+                    {
+                        // zero-extend the 16 bytes to 16 code units
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi8(block, zero));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 8), _mm_unpackhi_epi8(block, zero));
+                        first += 16;
+                        output += 16;
+                        continue;
+                    }
+                    first = scalar::to_utf16_until(first, last, first + 16, output);
+                    if (!first)
+                        return invalid;
+                }
+                if (!scalar::to_utf16_until(first, last, last, output))
+                    return invalid;
+                return static_cast<std::size_t>(output - output_first);
+            }
+
+            std::size_t to_utf32(const char* first, const char* last, char32_t* output) noexcept
+            {
+                auto* const output_first = output;
+                const auto zero = _mm_setzero_si128();
+                while (last - first >= 16)
+                {
+                    const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                    if (is_ascii(block))
+                    {
+                        const auto low = _mm_unpacklo_epi8(block, zero);
+                        const auto high = _mm_unpackhi_epi8(block, zero);
+                        auto* const destination = reinterpret_cast<__m128i*>(output);
+                        _mm_storeu_si128(destination, _mm_unpacklo_epi16(low, zero));
+                        _mm_storeu_si128(destination + 1, _mm_unpackhi_epi16(low, zero));
+                        _mm_storeu_si128(destination + 2, _mm_unpacklo_epi16(high, zero));
+                        _mm_storeu_si128(destination + 3, _mm_unpackhi_epi16(high, zero));
+                        first += 16;
+                        output += 16;
+                        continue;
+                    }
+                    first = scalar::to_utf32_until(first, last, first + 16, output);
+                    if (!first)
+                        return invalid;
+                }
+                if (!scalar::to_utf32_until(first, last, last, output))
+                    return invalid;
+                return static_cast<std::size_t>(output - output_first);
+            }
+
+            std::size_t from_utf16(const char16_t* first, const char16_t* last, char* output) noexcept
+            {
+                auto* const output_first = output;
+                const auto non_ascii_bits = _mm_set1_epi16(static_cast<short>(0xFF80));
+                const auto zero = _mm_setzero_si128();
+                while (last - first >= 8)
+                {
+                    const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(block, non_ascii_bits), zero)) == 0xFFFF)
+                    {
+                        // narrow the 8 code units to 8 bytes
+                        _mm_storel_epi64(reinterpret_cast<__m128i*>(output), _mm_packus_epi16(block, block));
+                        first += 8;
+                        output += 8;
+                        continue;
+                    }
+                    first = scalar::from_utf16_until(first, last, first + 8, output);
+                    if (!first)
+                        return invalid;
+                }
+                if (!scalar::from_utf16_until(first, last, last, output))
+                    return invalid;
+                return static_cast<std::size_t>(output - output_first);
+            }
+
+            constexpr Utf8Kernels kernels{&validate,   &count_code_points, &to_utf16,
+                                          &to_utf32,   &from_utf16,        &scalar::from_utf32};
+
+        } // namespace sse2
+
+        namespace avx2 {
+
+            // Error bits of the lookup tables: a sequence of two bytes is invalid if the three bytes looked up
+            // in the tables (high and low nibbles of the first byte, high nibble of the second) share a bit
+            constexpr unsigned char too_short = 1 << 0;      // lead byte followed by a lead byte or ASCII
+            constexpr unsigned char too_long = 1 << 1;       // ASCII followed by a continuation byte
+            constexpr unsigned char overlong_3 = 1 << 2;     // E0 followed by 80..9F
+            constexpr unsigned char too_large = 1 << 3;      // F4 followed by 90..BF, or F5..FF
+            constexpr unsigned char surrogate = 1 << 4;      // ED followed by A0..BF
+            constexpr unsigned char overlong_2 = 1 << 5;     // C0 or C1
+            constexpr unsigned char too_large_1000 = 1 << 6; // F5..FF followed by 80..8F
+            constexpr unsigned char overlong_4 = 1 << 6;     // F0 followed by 80..8F
+            constexpr unsigned char two_continuations = 1 << 7;
+            constexpr unsigned char carry = too_short | too_long | two_continuations;
+
+            constexpr unsigned char byte_1_high_table[16] = {
+                // 0xxx: ASCII
+                too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+                // 10xx: continuation
+                two_continuations, two_continuations, two_continuations, two_continuations,
+                // 1100: lead of 2 bytes, C0 and C1 are overlong
+                too_short | overlong_2,
+                // 1101: lead of 2 bytes
+                too_short,
+                // 1110: lead of 3 bytes
+                too_short | overlong_3 | surrogate,
+                // 1111: lead of 4 bytes
+                too_short | too_large | too_large_1000 | overlong_4};
+
+            constexpr unsigned char byte_1_low_table[16] = {
+                carry | overlong_3 | overlong_2 | overlong_4,
+                carry | overlong_2,
+                carry,
+                carry,
+                carry | too_large,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000 | surrogate,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000};
+
+            constexpr unsigned char byte_2_high_table[16] = {
+                // 0xxx: ASCII
+                too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+                // 1000
+                too_long | overlong_2 | two_continuations | overlong_3 | too_large_1000 | overlong_4,
+                // 1001
+                too_long | overlong_2 | two_continuations | overlong_3 | too_large,
+                // 101x
+                too_long | overlong_2 | two_continuations | surrogate | too_large,
+                too_long | overlong_2 | two_continuations | surrogate | too_large,
+                // 11xx: lead
+                too_short, too_short, too_short, too_short};
+
+            AJCF_SIMD_TARGET_AVX2
+            __m256i load_table(const unsigned char* table) noexcept
+            {
+                return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+            }
+
+            // The 32 bytes preceding each byte of block by N positions, taken from previous for the first ones
+            template <int N>
+            AJCF_SIMD_TARGET_AVX2 __m256i previous_bytes(__m256i block, __m256i previous) noexcept
+            {
+                return _mm256_alignr_epi8(block, _mm256_permute2x128_si256(previous, block, 0x21), 16 - N);
+            }
+
+            AJCF_SIMD_TARGET_AVX2
+            bool is_ascii(__m256i block) noexcept
+            {
+                return _mm256_movemask_epi8(block) == 0;
+            }
+
+            struct Validator
+            {
+                __m256i byte_1_high;
+                __m256i byte_1_low;
+                __m256i byte_2_high;
+                __m256i low_nibble_mask;
+                __m256i max_last_bytes;
+                __m256i errors;
+                __m256i previous;
+                __m256i previous_incomplete;
+
+                AJCF_SIMD_TARGET_AVX2
+                void initialize() noexcept
+                {
+                    byte_1_high = load_table(byte_1_high_table);
+                    byte_1_low = load_table(byte_1_low_table);
+                    byte_2_high = load_table(byte_2_high_table);
+                    low_nibble_mask = _mm256_set1_epi8(0x0F);
+                    // a block ending with a lead byte needs the next block to complete its sequence
+                    max_last_bytes = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                      static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1),
+                                                      static_cast<char>(0xC0 - 1));
+                    errors = _mm256_setzero_si256();
+                    previous = _mm256_setzero_si256();
+                    previous_incomplete = _mm256_setzero_si256();
+                }
+
+                AJCF_SIMD_TARGET_AVX2
+                __m256i high_nibbles(__m256i block) const noexcept
+                {
+                    return _mm256_and_si256(_mm256_srli_epi16(block, 4), low_nibble_mask);
+                }
+
+                AJCF_SIMD_TARGET_AVX2
+                void check(__m256i block) noexcept
+                {
+                    if (is_ascii(block))
+                    {
+                        errors = _mm256_or_si256(errors, previous_incomplete);
+                        previous_incomplete = _mm256_setzero_si256();
+                        previous = block;
+                        return;
+                    }
+
+                    // errors between each byte and the previous one
+                    const auto previous_1 = previous_bytes<1>(block, previous);
+                    const auto previous_1_low_nibbles = _mm256_and_si256(previous_1, low_nibble_mask);
+                    const auto special_cases = _mm256_and_si256(
+                        _mm256_and_si256(_mm256_shuffle_epi8(byte_1_high, high_nibbles(previous_1)),
+                                         _mm256_shuffle_epi8(byte_1_low, previous_1_low_nibbles)),
+                        _mm256_shuffle_epi8(byte_2_high, high_nibbles(block)));
+
+                    // continuation bytes required 2 or 3 bytes after the leads of 3 or 4 bytes
+                    const auto previous_2 = previous_bytes<2>(block, previous);
+                    const auto previous_3 = previous_bytes<3>(block, previous);
+                    const auto is_third_byte = _mm256_subs_epu8(previous_2, _mm256_set1_epi8(0xE0 - 0x80));
+                    const auto is_fourth_byte = _mm256_subs_epu8(previous_3, _mm256_set1_epi8(0xF0 - 0x80));
+                    const auto must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte),
+                                                                       _mm256_set1_epi8(static_cast<char>(0x80)));
+
+                    errors = _mm256_or_si256(errors, _mm256_xor_si256(must_be_continuation, special_cases));
+                    previous_incomplete = _mm256_subs_epu8(block, max_last_bytes);
+                    previous = block;
+                }
+
+                AJCF_SIMD_TARGET_AVX2
+                bool finish() noexcept
+                {
+                    errors = _mm256_or_si256(errors, previous_incomplete);
+                    return _mm256_testz_si256(errors, errors) != 0;
+                }
+            };
+
+            AJCF_SIMD_TARGET_AVX2
+            bool validate(const char* first, const char* last) noexcept
+            {
+                Validator validator;
+                validator.initialize();
+                for (; last - first >= 32; first += 32)
+                    validator.check(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first)));
+                if (first != last)
+                {
+                    // the padding with zeros (ASCII) does not change the result
+                    char block[32]{};
+                    std::memcpy(block, first, static_cast<std::size_t>(last - first));
+                    validator.check(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block)));
+                }
+                return validator.finish();
+            }
+
+            AJCF_SIMD_TARGET_AVX2
+            std::size_t count_code_points(const char* first, const char* last) noexcept
+            {
+                const auto max_continuation_byte = _mm256_set1_epi8(-65);
+                const auto zero = _mm256_setzero_si256();
+                std::size_t count = 0;
+                while (last - first >= 32)
+                {
+                    const auto blocks_count = std::min<std::ptrdiff_t>((last - first) / 32, 255);
+                    auto counters = _mm256_setzero_si256();
+                    for (std::ptrdiff_t index = 0; index != blocks_count; ++index, first += 32)
+                    {
+                        const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+                        counters = _mm256_sub_epi8(counters, _mm256_cmpgt_epi8(block, max_continuation_byte));
+                    }
+                    const auto sums = _mm256_sad_epu8(counters, zero);
+                    count += static_cast<std::size_t>(_mm256_extract_epi64(sums, 0)) +
+                             static_cast<std::size_t>(_mm256_extract_epi64(sums, 1)) +
+                             static_cast<std::size_t>(_mm256_extract_epi64(sums, 2)) +
+                             static_cast<std::size_t>(_mm256_extract_epi64(sums, 3));
+                }
+                return count + scalar::count_code_points(first, last);
+            }
+
+            AJCF_SIMD_TARGET_AVX2
+            std::size_t to_utf16(const char* first, const char* last, char16_t* output) noexcept
+            {
+                auto* const output_first = output;
+                while (last - first >= 32)
+                {
+                    const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+                    if (is_ascii(block))
+                    {
+                        auto* const destination = reinterpret_cast<__m256i*>(output);
+                        _mm256_storeu_si256(destination, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(block)));
+                        _mm256_storeu_si256(destination + 1, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(block, 1)));
+                        first += 32;
+                        output += 32;
+                        continue;
+                    }
+                    first = scalar::to_utf16_until(first, last, first + 32, output);
+                    if (!first)
+                        return invalid;
+                }
+                if (!scalar::to_utf16_until(first, last, last, output))
+                    return invalid;
+                return static_cast<std::size_t>(output - output_first);
+            }
+
+            AJCF_SIMD_TARGET_AVX2
+            std::size_t to_utf32(const char* first, const char* last, char32_t* output) noexcept
+            {
+                auto* const output_first = output;
+                while (last - first >= 32)
+                {
+                    const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+                    if (is_ascii(block))
+                    {
+                        auto* const destination = reinterpret_cast<__m256i*>(output);
+                        for (int part = 0; part != 4; ++part)
+                        {
+                            const auto bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(first + 8 * part));
+                            _mm256_storeu_si256(destination + part, _mm256_cvtepu8_epi32(bytes));
+                        }
+                        first += 32;
+                        output += 32;
+                        continue;
+                    }
+                    first = scalar::to_utf32_until(first, last, first + 32, output);
+                    if (!first)
+                        return invalid;
+                }
+                if (!scalar::to_utf32_until(first, last, last, output))
+                    return invalid;
+                return static_cast<std::size_t>(output - output_first);
+            }
+
+            AJCF_SIMD_TARGET_AVX2
+            std::size_t from_utf16(const char16_t* first, const char16_t* last, char* output) noexcept
+            {
+                auto* const output_first = output;
+                const auto non_ascii_bits = _mm256_set1_epi16(static_cast<short>(0xFF80));
+                while (last - first >= 16)
+                {
+                    const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+                    if (_mm256_testz_si256(block, non_ascii_bits))
+                    {
+                        // narrow the 16 code units to 16 bytes: packus works in each 128-bit lane,
+                        // the permutation gathers the two useful 64-bit quarters
+                        const auto packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(block, block), 0b11'01'10'00);
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm256_castsi256_si128(packed));
+                        first += 16;
+                        output += 16;
+                        continue;
+                    }
+                    first = scalar::from_utf16_until(first, last, first + 16, output);
+                    if (!first)
+                        return invalid;
+                }
+                if (!scalar::from_utf16_until(first, last, last, output))
+                    return invalid;
+                return static_cast<std::size_t>(output - output_first);
+            }
+
+            constexpr Utf8Kernels kernels{&validate,   &count_code_points, &to_utf16,
+                                          &to_utf32,   &from_utf16,        &scalar::from_utf32};
+
+        } // namespace avx2
+
+#endif
+
+    } // namespace
+
+    const Utf8Kernels& utf8_kernels(simd::InstructionSet instruction_set) noexcept
+    {
+        switch (instruction_set)
+        {
+#if defined(AJCF_SIMD_X86)
+        case simd::InstructionSet::sse2:
+            return sse2::kernels;
+        case simd::InstructionSet::avx2:
+            return avx2::kernels;
+#endif
+        default:
+            return scalar::kernels;
+        }
+    }
+
+    const Utf8Kernels& best_utf8_kernels() noexcept
+    {
+        static const Utf8Kernels& kernels = utf8_kernels(simd::best_instruction_set());
+        return kernels;
+    }
+
+    std::u16string to_utf16(std::string_view text)
+    {
+        std::u16string result(text.size(), u'\0');
+        const auto size = best_utf8_kernels().to_utf16(text.data(), text.data() + text.size(), result.data());
+        if (size == invalid)
+            throw std::invalid_argument("invalid UTF-8 text");
+        result.resize(size);
+        return result;
+    }
+
+    std::u32string to_utf32(std::string_view text)
+    {
+        std::u32string result(text.size(), U'\0');
+        const auto size = best_utf8_kernels().to_utf32(text.data(), text.data() + text.size(), result.data());
+        if (size == invalid)
+            throw std::invalid_argument("invalid UTF-8 text");
+        result.resize(size);
+        return result;
+    }
+
+    std::string from_utf16(std::u16string_view text)
+    {
+        std::string result(3 * text.size(), '\0');
+        const auto size = best_utf8_kernels().from_utf16(text.data(), text.data() + text.size(), result.data());
+        if (size == invalid)
+            throw std::invalid_argument("invalid UTF-16 text");
+        result.resize(size);
+        return result;
+    }
+
+    std::string from_utf32(std::u32string_view text)
+    {
+        std::string result(4 * text.size(), '\0');
+        const auto size = best_utf8_kernels().from_utf32(text.data(), text.data() + text.size(), result.data());
+        if (size == invalid)
+            throw std::invalid_argument("invalid UTF-32 text");
+        result.resize(size);
+        return result;
+    }
+
+} // namespace ajcf::utf8
+
+namespace {
+
+    std::vector<ajcf::simd::InstructionSet> supported_instruction_sets()
+    {
+        std::vector<ajcf::simd::InstructionSet> result;
+        for (const auto instruction_set :
+             {ajcf::simd::InstructionSet::scalar, ajcf::simd::InstructionSet::sse2, ajcf::simd::InstructionSet::avx2})
+        {
+            if (ajcf::simd::is_supported(instruction_set))
+                result.push_back(instruction_set);
+        }
+        return result;
+    }
+
+    bool validate(ajcf::simd::InstructionSet instruction_set, std::string_view text)
+    {
+        return ajcf::utf8::utf8_kernels(instruction_set).validate(text.data(), text.data() + text.size());
+    }
+
+    TEST_CASE("UTF-8 validation", "[strings][utf8]")
+    {
+        const std::vector<std::string> valid_texts = {
+            "",
+            "hello",
+            "\xC3\xA9t\xC3\xA9",     // "été"
+            "\xE2\x82\xAC",          // euro sign
+            "\xF0\x9D\x84\x9E",      // musical symbol G clef, outside the basic multilingual plane
+            "\xED\x9F\xBF",          // U+D7FF, just before the surrogates
+            "\xEE\x80\x80",          // U+E000, just after the surrogates
+            "\xF4\x8F\xBF\xBF",      // U+10FFFF, the last code point
+            "\xC2\x80\xDF\xBF",      // first and last 2-byte sequences
+            "\xE0\xA0\x80\xF0\x90\x80\x80", // first 3-byte and 4-byte sequences
+        };
+        const std::vector<std::string> invalid_texts = {
+            "\x80",             // lone continuation byte
+            "a\xBFz",           // lone continuation byte
+            "\xC0\x80",         // overlong encoding of U+0000
+            "\xC1\xBF",         // overlong encoding of U+007F
+            "\xE0\x9F\xBF",     // overlong encoding of U+07FF
+            "\xF0\x8F\xBF\xBF", // overlong encoding of U+FFFF
+            "\xED\xA0\x80",     // surrogate U+D800
+            "\xED\xBF\xBF",     // surrogate U+DFFF
+            "\xF4\x90\x80\x80", // U+110000
+            "\xF5\x80\x80\x80", // lead byte which cannot be used
+            "\xFF",             // lead byte which cannot be used
+            "\xC3",             // truncated sequence
+            "\xE2\x82",         // truncated sequence
+            "\xF0\x9D\x84",     // truncated sequence
+            "\xC3z",            // lead byte followed by ASCII
+            "\xE2\x82z",        // lead byte followed by ASCII
+            "\xC3\xA9\xA9",     // too many continuation bytes
+        };
+
+        for (const auto instruction_set : supported_instruction_sets())
+        {
+            CAPTURE(ajcf::simd::to_string(instruction_set));
+
+            // at all the positions of the vectorized blocks, and across them
+            bool all_valid_texts_accepted = true;
+            bool all_invalid_texts_rejected = true;
+            for (std::size_t padding = 0; padding != 70; ++padding)
+            {
+                for (const auto& text : valid_texts)
+                    all_valid_texts_accepted &=
+                        validate(instruction_set, std::string(padding, 'a') + text + std::string(padding % 7, 'b'));
+                for (const auto& text : invalid_texts)
+                    all_invalid_texts_rejected &=
+                        !validate(instruction_set, std::string(padding, 'a') + text + std::string(padding % 7, 'b'));
+            }
+
+            REQUIRE(all_valid_texts_accepted);
+            REQUIRE(all_invalid_texts_rejected);
+        }
+    }
+
+    // Random texts made of valid code points of all the lengths, then randomly corrupted
+    std::string random_text(std::mt19937& random, std::size_t code_points_count, bool corrupt)
+    {
+        std::uniform_int_distribution<int> length_distribution(1, 4);
+        std::string text;
+        for (std::size_t i = 0; i != code_points_count; ++i)
+        {
+            const auto length = length_distribution(random);
+            char32_t code_point{};
+            if (length == 1)
+                code_point = std::uniform_int_distribution<char32_t>(0, 0x7F)(random);
+            else if (length == 2)
+                code_point = std::uniform_int_distribution<char32_t>(0x80, 0x7FF)(random);
+            else if (length == 3)
+                code_point = std::uniform_int_distribution<char32_t>(0x800, 0xD7FF)(random);
+            else
+                code_point = std::uniform_int_distribution<char32_t>(0x10000, 0x10FFFF)(random);
+            text += ajcf::utf8::from_utf32(std::u32string_view(&code_point, 1));
+        }
+        if (corrupt && !text.empty())
+        {
+            const auto position = std::uniform_int_distribution<std::size_t>(0, text.size() - 1)(random);
+            text[position] = static_cast<char>(std::uniform_int_distribution<int>(0, 255)(random));
+        }
+        return text;
+    }
+
+    TEST_CASE("UTF-8 vectorized kernels vs scalar reference", "[strings][utf8][simd]")
+    {
+        std::mt19937 random{42};
+        const auto& reference = ajcf::utf8::utf8_kernels(ajcf::simd::InstructionSet::scalar);
+
+        for (const auto instruction_set : supported_instruction_sets())
+        {
+            CAPTURE(ajcf::simd::to_string(instruction_set));
+            const auto& kernels = ajcf::utf8::utf8_kernels(instruction_set);
+
+            bool same_results = true;
+            for (int i = 0; i != 2'000; ++i)
+            {
+                const auto text = random_text(random, i % 100, i % 2 == 1);
+                const auto* const first = text.data();
+                const auto* const last = first + text.size();
+
+                const auto valid = reference.validate(first, last);
+                same_results &= kernels.validate(first, last) == valid;
+
+                std::u16string utf16(text.size(), u'\0');
+                std::u16string expected_utf16(text.size(), u'\0');
+                const auto utf16_size = kernels.to_utf16(first, last, utf16.data());
+                same_results &= utf16_size == reference.to_utf16(first, last, expected_utf16.data());
+                std::u32string utf32(text.size(), U'\0');
+                std::u32string expected_utf32(text.size(), U'\0');
+                const auto utf32_size = kernels.to_utf32(first, last, utf32.data());
+                same_results &= utf32_size == reference.to_utf32(first, last, expected_utf32.data());
+
+                if (valid)
+                {
+                    same_results &= utf16 == expected_utf16 && utf32 == expected_utf32;
+                    same_results &= kernels.count_code_points(first, last) == utf32_size;
+
+                    // and back to UTF-8
+                    std::string utf8(3 * utf16_size, '\0');
+                    utf8.resize(kernels.from_utf16(utf16.data(), utf16.data() + utf16_size, utf8.data()));
+                    same_results &= utf8 == text;
+                }
+            }
+
+            REQUIRE(same_results);
+        }
+    }
+
+    TEST_CASE("UTF-8 conversions", "[strings][utf8]")
+    {
+        const std::string text = "\xC3\xA9t\xC3\xA9 \xE2\x82\xAC \xF0\x9D\x84\x9E"; // "été € 𝄞"
+
+        REQUIRE(ajcf::utf8::is_valid(text));
+        REQUIRE(text.size() == 14);
+        REQUIRE(ajcf::utf8::count_code_points(text) == 7);
+
+        const auto utf16 = ajcf::utf8::to_utf16(text);
+
+        REQUIRE(utf16 == u"\u00E9t\u00E9 \u20AC \U0001D11E");
+        REQUIRE(utf16.size() == 8); // the G clef needs a surrogate pair
+
+        const auto utf32 = ajcf::utf8::to_utf32(text);
+
+        REQUIRE(utf32 == U"\u00E9t\u00E9 \u20AC \U0001D11E");
+        REQUIRE(ajcf::utf8::from_utf16(utf16) == text);
+        REQUIRE(ajcf::utf8::from_utf32(utf32) == text);
+
+        REQUIRE_THROWS_AS(ajcf::utf8::to_utf16("\xC3"), std::invalid_argument);
+        REQUIRE_THROWS_AS(ajcf::utf8::from_utf16(std::u16string(1, u'\xD800')), std::invalid_argument);
+        REQUIRE_THROWS_AS(ajcf::utf8::from_utf32(std::u32string(1, U'\x110000')), std::invalid_argument);
+    }
+
+    namespace benchmarks {
+
+        // Best throughput of several runs, in GB/s of UTF-8 text
+        template <typename Function>
+        double gigabytes_per_second(std::size_t bytes, Function&& function)
+        {
+            double best_seconds = 1e9;
+            for (int run = 0; run != 5; ++run)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                function();
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                best_seconds = std::min(best_seconds, elapsed.count());
+            }
+            return static_cast<double>(bytes) / best_seconds / 1e9;
+        }
+
+        std::string repeat_to_size(std::string_view pattern, std::size_t bytes)
+        {
+            std::string text;
+            text.reserve(bytes + pattern.size());
+            while (text.size() < bytes)
+                text += pattern;
+            return text;
+        }
+
+        TEST_CASE("UTF-8 kernels throughput", "[strings][utf8][simd][benchmark][!hide]")
+        {
+            constexpr std::size_t bytes = 16 * 1024 * 1024;
+            const std::vector<std::pair<std::string, std::string>> texts = {
+                {"ASCII", repeat_to_size("Hello world, this is some plain English text. ", bytes)},
+                {"Latin", repeat_to_size("L'\xC3\xA9t\xC3\xA9 \xC3\xA0 la mer, na\xC3\xAFve fa\xC3\xA7on. ", bytes)},
+                {"CJK", repeat_to_size("\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE\xE6\x96\x87", bytes)},
+                {"emoji", repeat_to_size("\xF0\x9F\x98\x80\xF0\x9F\x8E\x89 ", bytes)},
+            };
+
+            std::vector<char16_t> utf16(bytes + 64);
+            std::vector<char32_t> utf32(bytes + 64);
+
+            fmt::print("{:<8} {:<7} {:>10} {:>10} {:>10} {:>10}\n", "text", "kernels", "validate", "count", "to UTF-16",
+                       "to UTF-32");
+            for (const auto& [name, text] : texts)
+            {
+                const auto* const first = text.data();
+                const auto* const last = first + text.size();
+                for (const auto instruction_set : supported_instruction_sets())
+                {
+                    const auto& kernels = ajcf::utf8::utf8_kernels(instruction_set);
+                    std::size_t result = 0;
+                    const auto size = text.size();
+                    const auto validate = gigabytes_per_second(size, [&] { result += kernels.validate(first, last); });
+                    const auto count =
+                        gigabytes_per_second(size, [&] { result += kernels.count_code_points(first, last); });
+                    const auto to_utf16 =
+                        gigabytes_per_second(size, [&] { result += kernels.to_utf16(first, last, utf16.data()); });
+                    const auto to_utf32 =
+                        gigabytes_per_second(size, [&] { result += kernels.to_utf32(first, last, utf32.data()); });
+                    fmt::print("{:<8} {:<7} {:>6.2f} GB/s {:>6.2f} GB/s {:>6.2f} GB/s {:>6.2f} GB/s ({})\n", name,
+                               ajcf::simd::to_string(instruction_set), validate, count, to_utf16, to_utf32,
+                               result % 10);
+                }
+            }
+
+            const auto& latin_text = texts[1].second;
+            for (const auto instruction_set : supported_instruction_sets())
+            {
+                const auto& kernels = ajcf::utf8::utf8_kernels(instruction_set);
+                BENCHMARK(fmt::format("validate 16 MB of Latin text - {}", ajcf::simd::to_string(instruction_set)))
+                {
+                    return kernels.validate(latin_text.data(), latin_text.data() + latin_text.size());
+                };
+            }
+        }
+
+    } // namespace benchmarks
+
+} // namespace
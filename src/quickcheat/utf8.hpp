@@ -0,0 +1,71 @@
+// https://en.wikipedia.org/wiki/UTF-8
+// https://www.unicode.org/versions/Unicode13.0.0/ch03.pdf (table 3-7: well-formed UTF-8 byte sequences)
+// https://arxiv.org/abs/2010.03090 (Keiser, Lemire: Validating UTF-8 in less than one instruction per byte)
+
+#pragma once
+
+#include "simd_string.hpp"
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ajcf {
+
+    // Validation, counting and transcoding of UTF-8 texts
+    // The kernels are selected like the ones of ajcf::simd:
+    // - scalar: one code point at a time, the reference implementation for the tests
+    // - sse2: blocks of 16 ASCII characters at once, the other code points one at a time
+    // - avx2: validation of 32 bytes at once with the lookup tables of Keiser and Lemire,
+    //         blocks of 32 ASCII characters at once for the other kernels
+    namespace utf8 {
+
+        constexpr std::size_t invalid = std::string_view::npos;
+
+        struct Utf8Kernels
+        {
+            // Whether [first, last) is well-formed UTF-8 (no overlong encoding, no surrogate, nothing above U+10FFFF)
+            bool (*validate)(const char* first, const char* last) noexcept;
+
+            // Number of code points of [first, last), which must be valid
+            std::size_t (*count_code_points)(const char* first, const char* last) noexcept;
+
+            // Transcode [first, last) into output, which must have room for last - first code units
+            // Return the number of code units written, or invalid if the text is not valid UTF-8
+            std::size_t (*to_utf16)(const char* first, const char* last, char16_t* output) noexcept;
+            std::size_t (*to_utf32)(const char* first, const char* last, char32_t* output) noexcept;
+
+            // Transcode [first, last) into output, which must have room for 3 * (last - first) bytes
+            // Return the number of bytes written, or invalid if the text contains a lone surrogate
+            std::size_t (*from_utf16)(const char16_t* first, const char16_t* last, char* output) noexcept;
+
+            // Same, output must have room for 4 * (last - first) bytes
+            // Return invalid if the text contains a surrogate or a value above U+10FFFF
+            std::size_t (*from_utf32)(const char32_t* first, const char32_t* last, char* output) noexcept;
+        };
+
+        // Kernels for the given instruction set (which must be supported by the CPU)
+        const Utf8Kernels& utf8_kernels(simd::InstructionSet instruction_set) noexcept;
+
+        // Kernels for the best instruction set, selected once
+        const Utf8Kernels& best_utf8_kernels() noexcept;
+
+        inline bool is_valid(std::string_view text) noexcept
+        {
+            return best_utf8_kernels().validate(text.data(), text.data() + text.size());
+        }
+
+        // Number of characters (code points) of a valid text, less than text.size() if it is not only ASCII
+        inline std::size_t count_code_points(std::string_view text) noexcept
+        {
+            return best_utf8_kernels().count_code_points(text.data(), text.data() + text.size());
+        }
+
+        // Conversions, throwing std::invalid_argument if the text is not valid
+        std::u16string to_utf16(std::string_view text);
+        std::u32string to_utf32(std::string_view text);
+        std::string from_utf16(std::u16string_view text);
+        std::string from_utf32(std::u32string_view text);
+
+    } // namespace utf8
+
+} // namespace ajcf